@@ -0,0 +1,304 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define BOUNDS_USE_SSE 1
+#else
+#define BOUNDS_USE_SSE 0
+#endif
+
+// Load-time bounding volumes of a point set. All volumes are expressed in the
+// local space of the points they were built from; culling code transforms them
+// on the fly instead of rescanning vertex data every frame.
+
+// axis aligned box stored as min/max corners
+struct BoundingBox
+{
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+    glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+// oriented box: orthonormal axes, half-lengths along each axis
+struct OrientedBox
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    glm::vec3 axes[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+    glm::vec3 extents = glm::vec3(0.0f);
+};
+
+// everything we cache per mesh/model
+struct MeshBounds
+{
+    BoundingBox    aabb;
+    BoundingSphere sphere;
+    OrientedBox    obb;
+};
+
+// points are read through a byte stride so callers can pass interleaved vertex data directly
+inline const glm::vec3& boundsPointAt(const glm::vec3* first, std::size_t stride, std::size_t i)
+{
+    return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const std::uint8_t*>(first) + i * stride);
+}
+
+// min/max reduction over all points; empty input yields a degenerate box at the origin
+inline BoundingBox computeBoundingBox(const glm::vec3* first, std::size_t count, std::size_t stride = sizeof(glm::vec3))
+{
+    BoundingBox box;
+    if (count == 0)
+        return box;
+
+#if BOUNDS_USE_SSE
+    // two accumulators hide the latency of min/max. The 4th lane picks up whatever follows the
+    // position in memory and is ignored; the last point is loaded scalar so we never read past the array.
+    __m128 vmin0 = _mm_set1_ps(FLT_MAX), vmin1 = vmin0;
+    __m128 vmax0 = _mm_set1_ps(-FLT_MAX), vmax1 = vmax0;
+    const std::size_t last = count - 1;
+    std::size_t i = 0;
+    for (; i + 1 < last; i += 2)
+    {
+        const __m128 p0 = _mm_loadu_ps(&boundsPointAt(first, stride, i).x);
+        const __m128 p1 = _mm_loadu_ps(&boundsPointAt(first, stride, i + 1).x);
+        vmin0 = _mm_min_ps(vmin0, p0); vmax0 = _mm_max_ps(vmax0, p0);
+        vmin1 = _mm_min_ps(vmin1, p1); vmax1 = _mm_max_ps(vmax1, p1);
+    }
+    for (; i < last; ++i)
+    {
+        const __m128 p = _mm_loadu_ps(&boundsPointAt(first, stride, i).x);
+        vmin0 = _mm_min_ps(vmin0, p); vmax0 = _mm_max_ps(vmax0, p);
+    }
+    const glm::vec3& tail = boundsPointAt(first, stride, last);
+    const __m128 p = _mm_setr_ps(tail.x, tail.y, tail.z, 0.0f);
+    vmin0 = _mm_min_ps(_mm_min_ps(vmin0, vmin1), p);
+    vmax0 = _mm_max_ps(_mm_max_ps(vmax0, vmax1), p);
+
+    alignas(16) float lo[4], hi[4];
+    _mm_store_ps(lo, vmin0);
+    _mm_store_ps(hi, vmax0);
+    box.min = glm::vec3(lo[0], lo[1], lo[2]);
+    box.max = glm::vec3(hi[0], hi[1], hi[2]);
+#else
+    box.min = glm::vec3(FLT_MAX);
+    box.max = glm::vec3(-FLT_MAX);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3& p = boundsPointAt(first, stride, i);
+        box.min = glm::min(box.min, p);
+        box.max = glm::max(box.max, p);
+    }
+#endif
+    return box;
+}
+
+// EPOS-14 style sphere: take the extremal points along 7 fixed directions, start from the
+// most distant pair and then let Ritter's pass grow the sphere over every remaining point.
+inline BoundingSphere computeBoundingSphere(const glm::vec3* first, std::size_t count, std::size_t stride = sizeof(glm::vec3))
+{
+    BoundingSphere sphere;
+    if (count == 0)
+        return sphere;
+
+    static const glm::vec3 directions[7] = {
+        glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+        glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, -1.0f), glm::vec3(1.0f, -1.0f, 1.0f), glm::vec3(1.0f, -1.0f, -1.0f)
+    };
+    std::size_t minIndex[7] = {}, maxIndex[7] = {};
+    float minProj[7], maxProj[7];
+    for (int d = 0; d < 7; ++d)
+        minProj[d] = maxProj[d] = glm::dot(boundsPointAt(first, stride, 0), directions[d]);
+
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        const glm::vec3& p = boundsPointAt(first, stride, i);
+        for (int d = 0; d < 7; ++d)
+        {
+            const float proj = glm::dot(p, directions[d]);
+            if (proj < minProj[d]) { minProj[d] = proj; minIndex[d] = i; }
+            if (proj > maxProj[d]) { maxProj[d] = proj; maxIndex[d] = i; }
+        }
+    }
+
+    // initial sphere spans the most separated extremal pair
+    int best = 0;
+    float bestDist2 = -1.0f;
+    for (int d = 0; d < 7; ++d)
+    {
+        const glm::vec3 diff = boundsPointAt(first, stride, maxIndex[d]) - boundsPointAt(first, stride, minIndex[d]);
+        const float dist2 = glm::dot(diff, diff);
+        if (dist2 > bestDist2) { bestDist2 = dist2; best = d; }
+    }
+    const glm::vec3& a = boundsPointAt(first, stride, minIndex[best]);
+    const glm::vec3& b = boundsPointAt(first, stride, maxIndex[best]);
+    sphere.center = (a + b) * 0.5f;
+    sphere.radius = std::sqrt(bestDist2) * 0.5f;
+
+    // Ritter growth pass
+    float radius2 = sphere.radius * sphere.radius;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3& p = boundsPointAt(first, stride, i);
+        const glm::vec3 diff = p - sphere.center;
+        const float dist2 = glm::dot(diff, diff);
+        if (dist2 > radius2)
+        {
+            const float dist = std::sqrt(dist2);
+            const float newRadius = (sphere.radius + dist) * 0.5f;
+            sphere.center += diff * ((newRadius - sphere.radius) / dist);
+            sphere.radius = newRadius;
+            radius2 = newRadius * newRadius;
+        }
+    }
+    return sphere;
+}
+
+// eigen decomposition of a symmetric 3x3 matrix by cyclic Jacobi rotations; columns of
+// 'eigenVectors' are the principal axes
+inline void jacobiEigenSolve(glm::mat3 a, glm::mat3& eigenVectors)
+{
+    eigenVectors = glm::mat3(1.0f);
+    for (int sweep = 0; sweep < 16; ++sweep)
+    {
+        const float offDiagonal = a[1][0] * a[1][0] + a[2][0] * a[2][0] + a[2][1] * a[2][1];
+        if (offDiagonal < 1e-12f)
+            break;
+        for (int p = 0; p < 2; ++p)
+        {
+            for (int q = p + 1; q < 3; ++q)
+            {
+                if (std::abs(a[q][p]) < 1e-12f)
+                    continue;
+                const float theta = (a[q][q] - a[p][p]) / (2.0f * a[q][p]);
+                const float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+                const float c = 1.0f / std::sqrt(t * t + 1.0f);
+                const float s = t * c;
+                glm::mat3 rotation(1.0f);
+                rotation[p][p] = c; rotation[q][q] = c;
+                rotation[q][p] = s; rotation[p][q] = -s;
+                a = glm::transpose(rotation) * a * rotation;
+                eigenVectors = eigenVectors * rotation;
+            }
+        }
+    }
+}
+
+// PCA fitted box: axes come from the covariance of the points, extents from projecting onto them
+inline OrientedBox computeOrientedBox(const glm::vec3* first, std::size_t count, std::size_t stride = sizeof(glm::vec3))
+{
+    OrientedBox obb;
+    if (count == 0)
+        return obb;
+
+    glm::vec3 mean(0.0f);
+    for (std::size_t i = 0; i < count; ++i)
+        mean += boundsPointAt(first, stride, i);
+    mean /= static_cast<float>(count);
+
+    float xx = 0.0f, xy = 0.0f, xz = 0.0f, yy = 0.0f, yz = 0.0f, zz = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3 d = boundsPointAt(first, stride, i) - mean;
+        xx += d.x * d.x; xy += d.x * d.y; xz += d.x * d.z;
+        yy += d.y * d.y; yz += d.y * d.z; zz += d.z * d.z;
+    }
+    const glm::mat3 covariance(xx, xy, xz, xy, yy, yz, xz, yz, zz);
+    glm::mat3 eigenVectors;
+    jacobiEigenSolve(covariance, eigenVectors);
+
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const glm::vec3& p = boundsPointAt(first, stride, i);
+        const glm::vec3 proj(glm::dot(p, eigenVectors[0]), glm::dot(p, eigenVectors[1]), glm::dot(p, eigenVectors[2]));
+        lo = glm::min(lo, proj);
+        hi = glm::max(hi, proj);
+    }
+    const glm::vec3 mid = (lo + hi) * 0.5f;
+    for (int axis = 0; axis < 3; ++axis)
+        obb.axes[axis] = glm::normalize(eigenVectors[axis]);
+    obb.center = eigenVectors * mid;
+    obb.extents = (hi - lo) * 0.5f;
+    return obb;
+}
+
+inline MeshBounds computeMeshBounds(const glm::vec3* first, std::size_t count, std::size_t stride = sizeof(glm::vec3))
+{
+    MeshBounds bounds;
+    bounds.aabb = computeBoundingBox(first, count, stride);
+    bounds.sphere = computeBoundingSphere(first, count, stride);
+    bounds.obb = computeOrientedBox(first, count, stride);
+    return bounds;
+}
+
+inline BoundingBox mergeBoundingBox(const BoundingBox& a, const BoundingBox& b)
+{
+    BoundingBox box;
+    box.min = glm::min(a.min, b.min);
+    box.max = glm::max(a.max, b.max);
+    return box;
+}
+
+// smallest sphere enclosing both spheres
+inline BoundingSphere mergeBoundingSphere(const BoundingSphere& a, const BoundingSphere& b)
+{
+    const glm::vec3 diff = b.center - a.center;
+    const float dist = glm::length(diff);
+    if (dist + b.radius <= a.radius)
+        return a;
+    if (dist + a.radius <= b.radius)
+        return b;
+    BoundingSphere sphere;
+    sphere.radius = (dist + a.radius + b.radius) * 0.5f;
+    sphere.center = a.center + diff * ((sphere.radius - a.radius) / dist);
+    return sphere;
+}
+
+// box of the 8 corners of an oriented box, used to merge children into a parent volume
+inline BoundingBox orientedBoxToBoundingBox(const OrientedBox& obb)
+{
+    const glm::vec3 halfSize = glm::abs(obb.axes[0]) * obb.extents.x + glm::abs(obb.axes[1]) * obb.extents.y + glm::abs(obb.axes[2]) * obb.extents.z;
+    BoundingBox box;
+    box.min = obb.center - halfSize;
+    box.max = obb.center + halfSize;
+    return box;
+}
+
+// merged bounds of several meshes. The OBB of a merge is not well defined without the points,
+// so the result keeps the merged AABB as an axis aligned OBB.
+template<typename MeshIterator>
+MeshBounds mergeMeshBounds(MeshIterator begin, MeshIterator end)
+{
+    MeshBounds bounds;
+    if (begin == end)
+        return bounds;
+    bounds = begin->bounds;
+    if (std::next(begin) == end)
+        return bounds;
+    for (MeshIterator it = std::next(begin); it != end; ++it)
+    {
+        bounds.aabb = mergeBoundingBox(bounds.aabb, it->bounds.aabb);
+        bounds.sphere = mergeBoundingSphere(bounds.sphere, it->bounds.sphere);
+    }
+    bounds.obb = OrientedBox();
+    bounds.obb.center = bounds.aabb.getCenter();
+    bounds.obb.extents = bounds.aabb.getExtents();
+    return bounds;
+}
+#endif
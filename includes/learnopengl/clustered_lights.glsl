@@ -0,0 +1,55 @@
+// Clustered light lookup for forward shaders, filled in on the CPU by learnopengl/light_clusters.h.
+// Include it after a #version 430 line and loop over the lights of the fragment's cluster:
+//
+//     uvec2 range = clusterLightRange();
+//     for (uint i = 0u; i < range.y; ++i)
+//     {
+//         Light light = lights[clusterLightIndices[range.x + i]];
+//         ...
+//     }
+
+// the std430 layout of PointLight in learnopengl/light_culling.h
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+// per cluster: offset into clusterLightIndices and number of lights
+layout (std430, binding = 1) readonly buffer ClusterRanges
+{
+    uvec2 clusterRanges[];
+};
+layout (std430, binding = 2) readonly buffer ClusterLightIndices
+{
+    uint clusterLightIndices[];
+};
+
+uniform uvec3 clusterGridSize;      // tiles in x and y, depth slices
+uniform vec2 clusterTileSize;       // size of a tile in pixels
+uniform vec2 clusterDepthRange;     // near and far plane of the projection
+uniform vec2 clusterSliceScaleBias; // slice = log(depth) * scale - bias
+
+// cluster of the current fragment
+uint clusterIndex()
+{
+    // view depth of the fragment, undoing the perspective depth mapping
+    float ndcDepth = gl_FragCoord.z * 2.0 - 1.0;
+    float depth = 2.0 * clusterDepthRange.x * clusterDepthRange.y /
+        (clusterDepthRange.y + clusterDepthRange.x - ndcDepth * (clusterDepthRange.y - clusterDepthRange.x));
+    uint slice = uint(max(log(depth) * clusterSliceScaleBias.x - clusterSliceScaleBias.y, 0.0));
+    uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy / clusterTileSize), slice), clusterGridSize - 1u);
+    return cluster.x + clusterGridSize.x * (cluster.y + clusterGridSize.y * cluster.z);
+}
+
+// offset and number of the lights touching the current fragment's cluster
+uvec2 clusterLightRange()
+{
+    return clusterRanges[clusterIndex()];
+}
@@ -2,47 +2,79 @@
 #define ENTITY_H
 
 #include <glm/glm.hpp> //glm::mat4
+#include <glm/gtc/quaternion.hpp> //glm::quat
 #include <list> //std::list
 #include <array> //std::array
 #include <memory> //std::unique_ptr
+#include <cmath> //std::asin, std::atan2
+
+#include <learnopengl/occlusion_culling.h> //OcclusionCuller
 
 class Transform
 {
 protected:
 	//Local space information
 	glm::vec3 m_pos = { 0.0f, 0.0f, 0.0f };
-	glm::vec3 m_eulerRot = { 0.0f, 0.0f, 0.0f }; //In degrees
+	glm::quat m_rot = { 1.0f, 0.0f, 0.0f, 0.0f };
 	glm::vec3 m_scale = { 1.0f, 1.0f, 1.0f };
 
-	//Global space informaiton concatenate in matrix
-	glm::mat4 m_modelMatrix = glm::mat4(1.0f);
+	//Euler angles last given to setLocalRotation, kept for convenience only. In degrees
+	glm::vec3 m_eulerRot = { 0.0f, 0.0f, 0.0f };
+
+	//Global space informaiton concatenate in matrix. Only the affine 3x4 part is stored (4 columns of 3 rows),
+	//the bottom row is always (0, 0, 0, 1)
+	glm::mat4x3 m_modelMatrix = glm::mat4x3(1.0f);
+
+	//Cached on each update so bounding volume tests don't recompute three lengths per call
+	glm::vec3 m_globalScale = { 1.0f, 1.0f, 1.0f };
+
+	//Inverse of the model matrix, only computed when somebody asks for it
+	mutable glm::mat4x3 m_inverseModelMatrix = glm::mat4x3(1.0f);
+	mutable bool m_isInverseDirty = false;
 
 	//Dirty flag
 	bool m_isDirty = true;
 
 protected:
-	glm::mat4 getLocalModelMatrix()
+	//Build the TRS matrix directly from the quaternion: the upper 3x3 is the rotation matrix with its columns
+	//scaled, the last column is the translation. No 4x4 products involved
+	glm::mat4x3 getLocalModelMatrix() const
 	{
-		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.x), glm::vec3(1.0f, 0.0f, 0.0f));
-		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.y), glm::vec3(0.0f, 1.0f, 0.0f));
-		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-		// Y * X * Z
-		const glm::mat4 roationMatrix = transformY * transformX * transformZ;
+		const glm::mat3 rotation = glm::mat3_cast(m_rot);
+		return glm::mat4x3(rotation[0] * m_scale.x, rotation[1] * m_scale.y, rotation[2] * m_scale.z, m_pos);
+	}
 
-		// translation * rotation * scale (also know as TRS matrix)
-		return glm::translate(glm::mat4(1.0f), m_pos) * roationMatrix * glm::scale(glm::mat4(1.0f), m_scale);
+	void onModelMatrixChanged()
+	{
+		m_globalScale = { glm::length(glm::vec3(m_modelMatrix[0])), glm::length(glm::vec3(m_modelMatrix[1])), glm::length(glm::vec3(m_modelMatrix[2])) };
+		m_isInverseDirty = true;
+		m_isDirty = false;
 	}
 public:
 
 	void computeModelMatrix()
 	{
 		m_modelMatrix = getLocalModelMatrix();
+		onModelMatrixChanged();
 	}
 
+	void computeModelMatrix(const glm::mat4x3& parentGlobalModelMatrix)
+	{
+		m_modelMatrix = multiplyAffine(parentGlobalModelMatrix, getLocalModelMatrix());
+		onModelMatrixChanged();
+	}
+
+	//Parent given as a full matrix; its bottom row has to be (0, 0, 0, 1)
 	void computeModelMatrix(const glm::mat4& parentGlobalModelMatrix)
 	{
-		m_modelMatrix = parentGlobalModelMatrix * getLocalModelMatrix();
+		computeModelMatrix(glm::mat4x3(parentGlobalModelMatrix));
+	}
+
+	//Product of two affine matrices, the implicit (0, 0, 0, 1) rows are never multiplied
+	static glm::mat4x3 multiplyAffine(const glm::mat4x3& parent, const glm::mat4x3& local)
+	{
+		const glm::mat3 parentBasis(parent);
+		return glm::mat4x3(parentBasis * local[0], parentBasis * local[1], parentBasis * local[2], parentBasis * local[3] + parent[3]);
 	}
 
 	void setLocalPosition(const glm::vec3& newPosition)
@@ -51,9 +83,25 @@ public:
 		m_isDirty = true;
 	}
 
+	//Euler angles in degrees, applied in Y * X * Z order
 	void setLocalRotation(const glm::vec3& newRotation)
 	{
 		m_eulerRot = newRotation;
+		m_rot = glm::angleAxis(glm::radians(newRotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::angleAxis(glm::radians(newRotation.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+			glm::angleAxis(glm::radians(newRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		m_isDirty = true;
+	}
+
+	void setLocalRotation(const glm::quat& newRotation)
+	{
+		m_rot = glm::normalize(newRotation);
+		//Decompose R = Y * X * Z back into angles (m[col][row])
+		const glm::mat3 m = glm::mat3_cast(m_rot);
+		const float x = std::asin(glm::clamp(-m[2][1], -1.0f, 1.0f));
+		const float y = std::atan2(m[2][0], m[2][2]);
+		const float z = std::atan2(m[0][1], m[1][1]);
+		m_eulerRot = glm::degrees(glm::vec3(x, y, z));
 		m_isDirty = true;
 	}
 
@@ -63,7 +111,7 @@ public:
 		m_isDirty = true;
 	}
 
-	const glm::vec3& getGlobalPosition() const
+	glm::vec3 getGlobalPosition() const
 	{
 		return m_modelMatrix[3];
 	}
@@ -78,16 +126,40 @@ public:
 		return m_eulerRot;
 	}
 
+	const glm::quat& getLocalOrientation() const
+	{
+		return m_rot;
+	}
+
 	const glm::vec3& getLocalScale() const
 	{
 		return m_scale;
 	}
 
-	const glm::mat4& getModelMatrix() const
+	//Full 4x4 matrix, e.g. for shader uniforms
+	glm::mat4 getModelMatrix() const
+	{
+		return glm::mat4(m_modelMatrix);
+	}
+
+	//Stored form: multiplying with a vec4 gives the transformed vec3 without the w row
+	const glm::mat4x3& getAffineModelMatrix() const
 	{
 		return m_modelMatrix;
 	}
 
+	//Affine inverse: invert the 3x3 part, then the translation. Cached until the next update
+	glm::mat4 getInverseModelMatrix() const
+	{
+		if (m_isInverseDirty)
+		{
+			const glm::mat3 inverseBasis = glm::inverse(glm::mat3(m_modelMatrix));
+			m_inverseModelMatrix = glm::mat4x3(inverseBasis[0], inverseBasis[1], inverseBasis[2], -(inverseBasis * m_modelMatrix[3]));
+			m_isInverseDirty = false;
+		}
+		return glm::mat4(m_inverseModelMatrix);
+	}
+
 	glm::vec3 getRight() const
 	{
 		return m_modelMatrix[0];
@@ -109,9 +181,9 @@ public:
 		return -m_modelMatrix[2];
 	}
 
-	glm::vec3 getGlobalScale() const
+	const glm::vec3& getGlobalScale() const
 	{
-		return { glm::length(getRight()), glm::length(getUp()), glm::length(getBackward()) };
+		return m_globalScale;
 	}
 
 	bool isDirty() const
@@ -187,13 +259,13 @@ struct Sphere : public BoundingVolume
 		const glm::vec3 globalScale = transform.getGlobalScale();
 
 		//Get our global center with process it with the global model matrix of our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
+		const glm::vec3 globalCenter{ transform.getAffineModelMatrix() * glm::vec4(center, 1.f) };
 
 		//To wrap correctly our shape, we need the maximum scale scalar.
 		const float maxScale = std::max(std::max(globalScale.x, globalScale.y), globalScale.z);
 
-		//Max scale is assuming for the diameter. So, we need the half to apply it to our radius
-		Sphere globalSphere(globalCenter, radius * (maxScale * 0.5f));
+		//To wrap correctly our shape, we scale the radius by the biggest axis scale
+		Sphere globalSphere(globalCenter, radius * maxScale);
 
 		//Check Firstly the result that have the most chance to faillure to avoid to call all functions.
 		return (globalSphere.isOnOrForwardPlan(camFrustum.leftFace) &&
@@ -224,7 +296,7 @@ struct SquareAABB : public BoundingVolume
 	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
 	{
 		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
+		const glm::vec3 globalCenter{ transform.getAffineModelMatrix() * glm::vec4(center, 1.f) };
 
 		// Scaled orientation
 		const glm::vec3 right = transform.getRight() * extent;
@@ -294,7 +366,7 @@ struct AABB : public BoundingVolume
 	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
 	{
 		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
+		const glm::vec3 globalCenter{ transform.getAffineModelMatrix() * glm::vec4(center, 1.f) };
 
 		// Scaled orientation
 		const glm::vec3 right = transform.getRight() * extents.x;
@@ -343,43 +415,13 @@ Frustum createFrustumFromCamera(const Camera& cam, float aspect, float fovY, flo
 
 AABB generateAABB(const Model& model)
 {
-	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
-	for (auto&& mesh : model.meshes)
-	{
-		for (auto&& vertex : mesh.vertices)
-		{
-			minAABB.x = std::min(minAABB.x, vertex.Position.x);
-			minAABB.y = std::min(minAABB.y, vertex.Position.y);
-			minAABB.z = std::min(minAABB.z, vertex.Position.z);
-
-			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
-			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
-			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
-		}
-	}
-	return AABB(minAABB, maxAABB);
+	//Bounds are cached by the model at load time, no need to walk the vertices again
+	return AABB(model.bounds.aabb.min, model.bounds.aabb.max);
 }
 
 Sphere generateSphereBV(const Model& model)
 {
-	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
-	for (auto&& mesh : model.meshes)
-	{
-		for (auto&& vertex : mesh.vertices)
-		{
-			minAABB.x = std::min(minAABB.x, vertex.Position.x);
-			minAABB.y = std::min(minAABB.y, vertex.Position.y);
-			minAABB.z = std::min(minAABB.z, vertex.Position.z);
-
-			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
-			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
-			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
-		}
-	}
-
-	return Sphere((maxAABB + minAABB) * 0.5f, glm::length(minAABB - maxAABB));
+	return Sphere(model.bounds.sphere.center, model.bounds.sphere.radius);
 }
 
 class Entity
@@ -406,7 +448,7 @@ public:
 	AABB getGlobalAABB()
 	{
 		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(boundingVolume->center, 1.f) };
+		const glm::vec3 globalCenter{ transform.getAffineModelMatrix() * glm::vec4(boundingVolume->center, 1.f) };
 
 		// Scaled orientation
 		const glm::vec3 right = transform.getRight() * boundingVolume->extents.x;
@@ -436,20 +478,26 @@ public:
 		children.back()->parent = this;
 	}
 
-	//Update transform if it was changed
+	//Update transform if it was changed. A clean node can still have dirty descendants
 	void updateSelfAndChild()
 	{
-		if (!transform.isDirty())
+		if (transform.isDirty())
+		{
+			forceUpdateSelfAndChild();
 			return;
+		}
 
-		forceUpdateSelfAndChild();
+		for (auto&& child : children)
+		{
+			child->updateSelfAndChild();
+		}
 	}
 
 	//Force update of transform even if local space don't change
 	void forceUpdateSelfAndChild()
 	{
 		if (parent)
-			transform.computeModelMatrix(parent->transform.getModelMatrix());
+			transform.computeModelMatrix(parent->transform.getAffineModelMatrix());
 		else
 			transform.computeModelMatrix();
 
@@ -460,6 +508,42 @@ public:
 	}
 
 
+	//Rasterize this entity's meshes into the software occlusion buffer
+	void addAsOccluder(OcclusionCuller& occlusion) const
+	{
+		for (auto&& mesh : pModel->meshes)
+		{
+			if (mesh.vertices.empty())
+				continue;
+			occlusion.addOccluder(transform.getModelMatrix(), &mesh.vertices[0].Position, sizeof(Vertex), mesh.indices.data(), mesh.indices.size());
+		}
+	}
+
+	//Same as above but entities hidden behind the occluders are skipped too
+	void drawSelfAndChild(const Frustum& frustum, const OcclusionCuller& occlusion, Shader& ourShader, unsigned int& display, unsigned int& occluded, unsigned int& total)
+	{
+		if (boundingVolume->isOnFrustum(frustum, transform))
+		{
+			const AABB globalAABB = getGlobalAABB();
+			if (occlusion.isOccluded(globalAABB.center - globalAABB.extents, globalAABB.center + globalAABB.extents))
+			{
+				occluded++;
+			}
+			else
+			{
+				ourShader.setMat4("model", transform.getModelMatrix());
+				pModel->Draw(ourShader);
+				display++;
+			}
+		}
+		total++;
+
+		for (auto&& child : children)
+		{
+			child->drawSelfAndChild(frustum, occlusion, ourShader, display, occluded, total);
+		}
+	}
+
 	void drawSelfAndChild(const Frustum& frustum, Shader& ourShader, unsigned int& display, unsigned int& total)
 	{
 		if (boundingVolume->isOnFrustum(frustum, transform))
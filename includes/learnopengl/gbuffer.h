@@ -0,0 +1,118 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// The g-buffer layouts the deferred shading demos can be started with.
+//
+// classic: position in RGBA16F, normal in RGBA16F, albedo + specular intensity in RGBA8 and a depth
+//          renderbuffer; 24 bytes per pixel.
+// compact: no position target, positions are reconstructed from the depth buffer, which is a texture
+//          for that reason. Normals are folded onto the octahedron and stored as two coordinates in
+//          RG16, albedo + specular intensity stay packed in one RGBA8; 12 bytes per pixel.
+//
+// Both layouts share one set of shaders, which pick their side with #ifdef COMPACT_GBUFFER.
+enum GBufferLayout
+{
+    GBUFFER_CLASSIC,
+    GBUFFER_COMPACT
+};
+
+class GBuffer
+{
+public:
+    unsigned int ID;
+    GBufferLayout layout;
+    // render targets; gPosition is 0 in the compact layout
+    unsigned int gPosition, gNormal, gAlbedoSpec;
+    // depth renderbuffer (classic) or depth/stencil texture (compact)
+    unsigned int gDepth;
+
+    GBuffer(unsigned int width, unsigned int height, GBufferLayout layout) : layout(layout), gPosition(0)
+    {
+        glGenFramebuffers(1, &ID);
+        glBindFramebuffer(GL_FRAMEBUFFER, ID);
+        if (layout == GBUFFER_CLASSIC)
+        {
+            gPosition = createTarget(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+            gNormal = createTarget(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+            gAlbedoSpec = createTarget(width, height, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
+            unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+            glDrawBuffers(3, attachments);
+            glGenRenderbuffers(1, &gDepth);
+            glBindRenderbuffer(GL_RENDERBUFFER, gDepth);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, width, height);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gDepth);
+        }
+        else
+        {
+            gNormal = createTarget(width, height, GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+            gAlbedoSpec = createTarget(width, height, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gNormal, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gAlbedoSpec, 0);
+            unsigned int attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+            glDrawBuffers(2, attachments);
+            // depth + stencil, like the default framebuffer, so the depth can still be blitted there
+            gDepth = createTarget(width, height, GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
+        }
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Framebuffer not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // the texture the lighting pass gets positions from: the position target or the depth buffer
+    unsigned int positionSource() const
+    {
+        return layout == GBUFFER_CLASSIC ? gPosition : gDepth;
+    }
+
+private:
+    static unsigned int createTarget(unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, GLenum type)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return texture;
+    }
+};
+
+// video memory per pixel, depth included (a 24 bit depth buffer takes 4 bytes)
+inline unsigned int gBufferBytesPerPixel(GBufferLayout layout)
+{
+    return layout == GBUFFER_CLASSIC ? 8 + 8 + 4 + 4 : 4 + 4 + 4;
+}
+
+// to be passed to the Shader constructor of every shader that reads or writes the g-buffer
+inline std::string gBufferDefines(GBufferLayout layout)
+{
+    return layout == GBUFFER_COMPACT ? "#define COMPACT_GBUFFER\n" : "";
+}
+
+inline const char* gBufferLayoutName(GBufferLayout layout)
+{
+    return layout == GBUFFER_CLASSIC ? "classic" : "compact";
+}
+
+// the layout asked for with "--gbuffer compact" (or "--gbuffer classic") on the command line; classic by default
+inline GBufferLayout gBufferLayoutFromArguments(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; ++i)
+        if (std::strcmp(argv[i], "--gbuffer") == 0)
+            return std::strcmp(argv[i + 1], "compact") == 0 ? GBUFFER_COMPACT : GBUFFER_CLASSIC;
+    return GBUFFER_CLASSIC;
+}
+
+#endif
@@ -0,0 +1,601 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Packs rectangles into a fixed width bin using a skyline: the bin's filled area is described by
+// its top edge as a list of horizontal segments, and each rectangle is placed where its top ends
+// up lowest (bottom-left heuristic). This wastes far less space than shelves when heights vary,
+// as they do for glyphs, and packing only ever touches the segments below the new rectangle.
+class SkylinePacker
+{
+public:
+    struct Segment { int x, y, width; };
+
+    int width = 0, height = 0;
+
+    SkylinePacker() = default;
+    SkylinePacker(int inWidth, int inHeight) { reset(inWidth, inHeight); }
+
+    void reset(int inWidth, int inHeight)
+    {
+        width = inWidth;
+        height = inHeight;
+        skyline.assign(1, Segment{ 0, 0, inWidth });
+    }
+    // makes the bin taller; rectangles already placed stay where they are
+    void grow(int inHeight)
+    {
+        height = std::max(height, inHeight);
+    }
+    // finds a place for a w x h rectangle; returns false if it doesn't fit
+    bool pack(int w, int h, glm::ivec2& position)
+    {
+        int bestIndex = -1, bestTop = height + 1, bestX = 0, bestY = 0;
+        for (size_t i = 0; i < skyline.size(); ++i)
+        {
+            int x = skyline[i].x;
+            if (x + w > width)
+                break;
+            // the rectangle rests on the highest segment it spans
+            int y = 0;
+            for (size_t j = i, covered = 0; covered < static_cast<size_t>(w); ++j)
+            {
+                y = std::max(y, skyline[j].y);
+                covered = skyline[j].x + skyline[j].width - x;
+            }
+            if (y + h <= height && y + h < bestTop)
+            {
+                bestIndex = static_cast<int>(i);
+                bestTop = y + h;
+                bestX = x;
+                bestY = y;
+            }
+        }
+        if (bestIndex < 0)
+            return false;
+        position = glm::ivec2(bestX, bestY);
+        // raise the skyline under the rectangle, trimming the segments it covers
+        skyline.insert(skyline.begin() + bestIndex, Segment{ bestX, bestTop, w });
+        size_t i = bestIndex + 1;
+        while (i < skyline.size() && skyline[i].x < bestX + w)
+        {
+            int shrink = bestX + w - skyline[i].x;
+            if (shrink >= skyline[i].width)
+            {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            break;
+        }
+        // merge neighbours of equal height so the list stays short
+        for (size_t j = 0; j + 1 < skyline.size();)
+        {
+            if (skyline[j].y == skyline[j + 1].y)
+            {
+                skyline[j].width += skyline[j + 1].width;
+                skyline.erase(skyline.begin() + j + 1);
+            }
+            else
+                ++j;
+        }
+        return true;
+    }
+
+    // the current skyline, e.g. to store a packed atlas and continue packing it later
+    const std::vector<Segment>& segments() const { return skyline; }
+    void restore(int inWidth, int inHeight, const std::vector<Segment>& inSkyline)
+    {
+        width = inWidth;
+        height = inHeight;
+        skyline = inSkyline;
+    }
+
+private:
+    std::vector<Segment> skyline;
+};
+
+// A glyph as stored in the atlas; sizes and offsets are in atlas texels (for distance field atlases
+// the bitmap includes the spread around the outline).
+struct Glyph
+{
+    glm::ivec2 size = glm::ivec2(0);    // size of the glyph bitmap
+    glm::ivec2 bearing = glm::ivec2(0); // offset from the baseline to the left/top of the bitmap
+    float      advance = 0.0f;          // horizontal offset to the next glyph
+    glm::ivec2 position = glm::ivec2(0);// top-left texel of the bitmap in the atlas
+    glm::vec2  uvMin = glm::vec2(0.0f), uvMax = glm::vec2(0.0f);
+};
+
+// squared euclidean distance transform of a sampled function (Felzenszwalb & Huttenlocher); 'f' is
+// read with stride 'step', 'd' receives n results the same way and v/z are scratch of n and n + 1
+inline void distanceTransform1D(float* f, int n, int step, float* d, int* v, float* z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -1e20f;
+    z[1] = 1e20f;
+    for (int q = 1; q < n; ++q)
+    {
+        // drop the parabolas the new one hides
+        float s = ((f[q * step] + q * q) - (f[v[k] * step] + v[k] * v[k])) / (2.0f * (q - v[k]));
+        while (s <= z[k])
+        {
+            --k;
+            s = ((f[q * step] + q * q) - (f[v[k] * step] + v[k] * v[k])) / (2.0f * (q - v[k]));
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = 1e20f;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q)
+    {
+        while (z[k + 1] < q)
+            ++k;
+        float distance = static_cast<float>(q - v[k]);
+        d[q] = distance * distance + f[v[k] * step];
+    }
+}
+
+// in place 2D squared distance transform: cells holding 0 are the features, others should hold 1e20
+inline void distanceTransform2D(std::vector<float>& grid, int width, int height)
+{
+    int n = std::max(width, height);
+    std::vector<float> d(n), z(n + 1);
+    std::vector<int> v(n);
+    for (int x = 0; x < width; ++x)
+    {
+        distanceTransform1D(&grid[x], height, width, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; ++y)
+            grid[y * width + x] = d[y];
+    }
+    for (int y = 0; y < height; ++y)
+    {
+        distanceTransform1D(&grid[y * width], width, 1, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+    }
+}
+
+// Turns a coverage bitmap rendered 'supersample' times larger than the output into a signed
+// distance field of 'size' texels. The bitmap's top-left lands at 'offset' in the high resolution
+// grid; distances are measured there, averaged per output texel and mapped so the outline is at
+// 0.5 and 'spread' texels inside/outside are 1/0. Touches no shared state, so glyphs can be
+// converted on several threads at once.
+inline std::vector<unsigned char> makeDistanceField(const unsigned char* coverage, int pitch, glm::ivec2 bitmapSize, glm::ivec2 offset, glm::ivec2 size, int supersample, int spread)
+{
+    const int width = size.x * supersample, height = size.y * supersample;
+    std::vector<float> toInside(static_cast<size_t>(width) * height), toOutside(toInside.size());
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            int bx = x - offset.x, by = y - offset.y;
+            bool covered = bx >= 0 && by >= 0 && bx < bitmapSize.x && by < bitmapSize.y && coverage[by * pitch + bx] >= 128;
+            toInside[y * width + x] = covered ? 0.0f : 1e20f;
+            toOutside[y * width + x] = covered ? 1e20f : 0.0f;
+        }
+    }
+    distanceTransform2D(toInside, width, height);
+    distanceTransform2D(toOutside, width, height);
+    std::vector<unsigned char> field(static_cast<size_t>(size.x) * size.y);
+    const float scale = 1.0f / (supersample * supersample * supersample * 2.0f * spread);
+    for (int y = 0; y < size.y; ++y)
+    {
+        for (int x = 0; x < size.x; ++x)
+        {
+            float sum = 0.0f;
+            for (int sy = 0; sy < supersample; ++sy)
+            {
+                for (int sx = 0; sx < supersample; ++sx)
+                {
+                    size_t i = static_cast<size_t>(y * supersample + sy) * width + x * supersample + sx;
+                    // the outline lies half a texel between the covered and uncovered texel centers
+                    sum += toInside[i] > 0.0f ? 0.5f - std::sqrt(toInside[i]) : std::sqrt(toOutside[i]) - 0.5f;
+                }
+            }
+            float value = glm::clamp(0.5f + sum * scale, 0.0f, 1.0f);
+            field[y * size.x + x] = static_cast<unsigned char>(value * 255.0f + 0.5f);
+        }
+    }
+    return field;
+}
+
+// All glyphs of a FreeType font in a single GL_RED texture. ASCII is rasterized when the atlas is
+// loaded, anything else the first time glyph() asks for it, so text only needs one texture bind no
+// matter which characters it uses. When the atlas is full it doubles in height; a CPU copy of the
+// texels is kept so the texture can be re-uploaded.
+//
+// load() stores plain coverage bitmaps for one pixel size. loadDistanceField() stores signed
+// distance fields instead (sample with a smoothstep around 0.5), which stay sharp at any scale, so
+// one atlas serves every text size. Those are generated on all cores and can be cached on disk, in
+// which case later launches don't touch FreeType until a character outside the cache shows up.
+class GlyphAtlas
+{
+public:
+    unsigned int textureID = 0;
+    // size the glyphs were rendered at; text is drawn at this size with a scale of 1
+    int          pixelSize = 0;
+    // distance field atlas and how many texels the field extends beyond the outline
+    bool         distanceField = false;
+    int          spread = 0;
+    // glyphs rasterized after loading because text used them
+    unsigned int lazyGlyphs = 0;
+    // distance fields are computed from bitmaps rendered this many times larger
+    static const int DISTANCE_FIELD_SUPERSAMPLE = 4;
+
+    GlyphAtlas() = default;
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+    ~GlyphAtlas() { releaseFont(); }
+
+    // opens the font and rasterizes the first 128 characters; the font stays open for lazy glyphs
+    bool load(const std::string& font, int inPixelSize, int atlasWidth = 512, int atlasHeight = 256)
+    {
+        reset(font, inPixelSize, false, 0, atlasWidth, atlasHeight);
+        if (!openFont())
+            return false;
+        for (uint32_t c = 0; c < 128; ++c)
+            rasterize(c);
+        lazyGlyphs = 0;
+        return true;
+    }
+
+    // builds a distance field atlas of the first 128 characters at 'inPixelSize', using 'threads'
+    // workers (0: one per core); with a cache file the atlas is read from it when it matches the font
+    // and settings, and written to it after generating
+    bool loadDistanceField(const std::string& font, int inPixelSize, int inSpread, const std::string& cacheFile = std::string(),
+                           unsigned int threads = 0, int atlasWidth = 512, int atlasHeight = 256)
+    {
+        reset(font, inPixelSize, true, inSpread, atlasWidth, atlasHeight);
+        if (!cacheFile.empty() && loadCache(cacheFile))
+            return true;
+        if (!openFont())
+            return false;
+        // FreeType faces aren't thread safe: render the outlines here, convert them in parallel
+        std::vector<DistanceFieldJob> jobs(128);
+        for (uint32_t c = 0; c < 128; ++c)
+            prepareDistanceField(c, jobs[c]);
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<size_t> next(0);
+        auto work = [&jobs, &next, this]()
+        {
+            for (size_t i = next++; i < jobs.size(); i = next++)
+                convertDistanceField(jobs[i]);
+        };
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threads; ++i)
+            workers.emplace_back(work);
+        work();
+        for (std::thread& worker : workers)
+            worker.join();
+        // packing and uploading stay on the thread owning the GL context
+        for (DistanceFieldJob& job : jobs)
+            addGlyph(job.codepoint, job.glyph, job.field.data(), job.glyph.size.x);
+        lazyGlyphs = 0;
+        if (!cacheFile.empty() && !saveCache(cacheFile))
+            std::cout << "ERROR::GLYPHATLAS: Failed to write cache " << cacheFile << std::endl;
+        return true;
+    }
+
+    // the glyph for a unicode code point, rasterized on first use (missing characters use the font's
+    // .notdef glyph); nullptr only if no font is loaded. The pointer is only valid until the next call.
+    const Glyph* glyph(uint32_t codepoint)
+    {
+        if (codepoint < 256)
+        {
+            int index = latin[codepoint];
+            return index >= 0 ? &glyphs[index] : rasterize(codepoint);
+        }
+        auto found = others.find(codepoint);
+        return found != others.end() ? &glyphs[found->second] : rasterize(codepoint);
+    }
+
+    // current atlas height; when it changes every texture coordinate handed out before is stale
+    int height() const { return packer.height; }
+
+    // writes the atlas (glyphs, texels and packing state) so loadDistanceField can skip generating it
+    bool saveCache(const std::string& file) const
+    {
+        std::ofstream stream(file, std::ios::binary);
+        if (!stream)
+            return false;
+        const std::vector<SkylinePacker::Segment>& skyline = packer.segments();
+        CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, fileSize(fontPath), pixelSize, spread, packer.width, packer.height,
+                               static_cast<uint32_t>(glyphs.size()), static_cast<uint32_t>(skyline.size()) };
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(codepoints.data()), codepoints.size() * sizeof(uint32_t));
+        stream.write(reinterpret_cast<const char*>(glyphs.data()), glyphs.size() * sizeof(Glyph));
+        stream.write(reinterpret_cast<const char*>(skyline.data()), skyline.size() * sizeof(SkylinePacker::Segment));
+        stream.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+        return static_cast<bool>(stream);
+    }
+
+    // decodes the UTF-8 sequence starting at text[i] and advances i past it; malformed bytes decode to U+FFFD
+    static uint32_t decodeUtf8(const std::string& text, size_t& i)
+    {
+        unsigned char lead = static_cast<unsigned char>(text[i++]);
+        if (lead < 0x80)
+            return lead;
+        int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+        if (extra < 0 || i + extra > text.size())
+            return 0xFFFD;
+        uint32_t codepoint = lead & (0x3F >> extra);
+        for (int k = 0; k < extra; ++k)
+        {
+            unsigned char next = static_cast<unsigned char>(text[i]);
+            if ((next & 0xC0) != 0x80)
+                return 0xFFFD;
+            codepoint = (codepoint << 6) | (next & 0x3F);
+            ++i;
+        }
+        return codepoint;
+    }
+
+private:
+    struct CacheHeader
+    {
+        uint32_t magic, version;
+        uint64_t fontBytes;
+        int32_t  pixelSize, spread, width, height;
+        uint32_t glyphCount, segmentCount;
+    };
+    static const uint32_t CACHE_MAGIC = 0x44534147; // "GASD"
+    static const uint32_t CACHE_VERSION = 1;
+
+    // a glyph on its way through distance field generation
+    struct DistanceFieldJob
+    {
+        uint32_t                   codepoint = 0;
+        Glyph                      glyph;
+        std::vector<unsigned char> coverage;
+        int                        pitch = 0;
+        glm::ivec2                 bitmapSize = glm::ivec2(0), offset = glm::ivec2(0);
+        std::vector<unsigned char> field;
+    };
+
+    std::string                       fontPath;
+    FT_Library                        library = nullptr;
+    FT_Face                           face = nullptr;
+    SkylinePacker                     packer;
+    std::vector<unsigned char>        pixels;
+    std::vector<Glyph>                glyphs;
+    std::vector<uint32_t>             codepoints;
+    // glyph indices: a flat table for Latin-1, a map for everything else
+    std::vector<int>                  latin = std::vector<int>(256, -1);
+    std::unordered_map<uint32_t, int> others;
+
+    void reset(const std::string& font, int inPixelSize, bool inDistanceField, int inSpread, int atlasWidth, int atlasHeight)
+    {
+        releaseFont();
+        fontPath = font;
+        pixelSize = inPixelSize;
+        distanceField = inDistanceField;
+        spread = inSpread;
+        glyphs.clear();
+        codepoints.clear();
+        others.clear();
+        latin.assign(256, -1);
+        lazyGlyphs = 0;
+        packer.reset(atlasWidth, atlasHeight);
+        pixels.assign(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+        if (textureID == 0)
+            glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        uploadAll();
+    }
+
+    bool openFont()
+    {
+        if (face)
+            return true;
+        if (FT_Init_FreeType(&library))
+        {
+            std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+            library = nullptr;
+            return false;
+        }
+        if (FT_New_Face(library, fontPath.c_str(), 0, &face))
+        {
+            std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+            face = nullptr;
+            return false;
+        }
+        FT_Set_Pixel_Sizes(face, 0, distanceField ? pixelSize * DISTANCE_FIELD_SUPERSAMPLE : pixelSize);
+        return true;
+    }
+
+    const Glyph* rasterize(uint32_t codepoint)
+    {
+        if (!openFont())
+            return nullptr;
+        ++lazyGlyphs;
+        if (distanceField)
+        {
+            DistanceFieldJob job;
+            prepareDistanceField(codepoint, job);
+            convertDistanceField(job);
+            return addGlyph(codepoint, job.glyph, job.field.data(), job.glyph.size.x);
+        }
+        Glyph glyph;
+        if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+        {
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            return addGlyph(codepoint, glyph, nullptr, 0);
+        }
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        glyph.size = glm::ivec2(bitmap.width, bitmap.rows);
+        glyph.bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        glyph.advance = static_cast<float>(face->glyph->advance.x >> 6); // advance is in 1/64 pixels
+        return addGlyph(codepoint, glyph, bitmap.buffer, bitmap.pitch);
+    }
+
+    // renders the enlarged outline and works out where its distance field goes
+    void prepareDistanceField(uint32_t codepoint, DistanceFieldJob& job)
+    {
+        const int supersample = DISTANCE_FIELD_SUPERSAMPLE;
+        job.codepoint = codepoint;
+        if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+        {
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            return;
+        }
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        job.glyph.advance = face->glyph->advance.x / (64.0f * supersample);
+        if (bitmap.width == 0 || bitmap.rows == 0)
+            return;
+        job.bitmapSize = glm::ivec2(bitmap.width, bitmap.rows);
+        job.pitch = bitmap.pitch;
+        job.coverage.assign(bitmap.buffer, bitmap.buffer + static_cast<size_t>(bitmap.rows) * bitmap.pitch);
+        // pad by the spread and align the origin to whole output texels so the bearing stays integral
+        int left = face->glyph->bitmap_left, top = face->glyph->bitmap_top;
+        job.offset.x = spread * supersample + ((left % supersample) + supersample) % supersample;
+        job.offset.y = spread * supersample + ((-top % supersample) + supersample) % supersample;
+        job.glyph.bearing = glm::ivec2((left - job.offset.x) / supersample, (top + job.offset.y) / supersample);
+        job.glyph.size = glm::ivec2((job.offset.x + job.bitmapSize.x + supersample - 1) / supersample + spread,
+                                    (job.offset.y + job.bitmapSize.y + supersample - 1) / supersample + spread);
+    }
+
+    void convertDistanceField(DistanceFieldJob& job) const
+    {
+        if (job.glyph.size.x > 0 && job.glyph.size.y > 0)
+            job.field = makeDistanceField(job.coverage.data(), job.pitch, job.bitmapSize, job.offset, job.glyph.size, DISTANCE_FIELD_SUPERSAMPLE, spread);
+    }
+
+    const Glyph* addGlyph(uint32_t codepoint, Glyph glyph, const unsigned char* data, int pitch)
+    {
+        if (data && glyph.size.x > 0 && glyph.size.y > 0)
+            place(glyph, data, pitch);
+        int index = static_cast<int>(glyphs.size());
+        glyphs.push_back(glyph);
+        codepoints.push_back(codepoint);
+        if (codepoint < 256)
+            latin[codepoint] = index;
+        else
+            others[codepoint] = index;
+        return &glyphs[index];
+    }
+
+    void place(Glyph& glyph, const unsigned char* data, int pitch)
+    {
+        // one texel of padding keeps linear filtering from bleeding in neighbours
+        const int padding = 1;
+        glm::ivec2 position;
+        while (!packer.pack(glyph.size.x + padding, glyph.size.y + padding, position))
+        {
+            GLint maxSize = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+            if (glyph.size.x + padding > packer.width || packer.height * 2 > maxSize)
+            {
+                std::cout << "ERROR::GLYPHATLAS: Atlas is full" << std::endl;
+                glyph.size = glm::ivec2(0);
+                return;
+            }
+            packer.grow(packer.height * 2);
+            pixels.resize(static_cast<size_t>(packer.width) * packer.height, 0);
+            uploadAll();
+        }
+        glyph.position = position;
+        for (int row = 0; row < glyph.size.y; ++row)
+            std::copy_n(data + row * pitch, glyph.size.x, pixels.begin() + (position.y + row) * packer.width + position.x);
+        updateCoordinates(glyph);
+        // upload only the new glyph
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, packer.width);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, glyph.size.x, glyph.size.y, GL_RED, GL_UNSIGNED_BYTE, &pixels[position.y * packer.width + position.x]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+
+    void updateCoordinates(Glyph& glyph) const
+    {
+        glm::vec2 atlasSize(packer.width, packer.height);
+        glyph.uvMin = glm::vec2(glyph.position) / atlasSize;
+        glyph.uvMax = glm::vec2(glyph.position + glyph.size) / atlasSize;
+    }
+
+    // (re)allocates the texture from the CPU copy; texture coordinates change with the atlas height
+    void uploadAll()
+    {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, packer.width, packer.height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        for (Glyph& glyph : glyphs)
+            updateCoordinates(glyph);
+    }
+
+    bool loadCache(const std::string& file)
+    {
+        std::ifstream stream(file, std::ios::binary);
+        CacheHeader header;
+        if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        // a different font file (by size), size or spread invalidates the cache
+        if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.fontBytes != fileSize(fontPath) ||
+            header.pixelSize != pixelSize || header.spread != spread || header.width <= 0 || header.height <= 0)
+            return false;
+        std::vector<uint32_t> cachedCodepoints(header.glyphCount);
+        std::vector<Glyph> cachedGlyphs(header.glyphCount);
+        std::vector<SkylinePacker::Segment> skyline(header.segmentCount);
+        std::vector<unsigned char> cachedPixels(static_cast<size_t>(header.width) * header.height);
+        stream.read(reinterpret_cast<char*>(cachedCodepoints.data()), cachedCodepoints.size() * sizeof(uint32_t));
+        stream.read(reinterpret_cast<char*>(cachedGlyphs.data()), cachedGlyphs.size() * sizeof(Glyph));
+        stream.read(reinterpret_cast<char*>(skyline.data()), skyline.size() * sizeof(SkylinePacker::Segment));
+        stream.read(reinterpret_cast<char*>(cachedPixels.data()), cachedPixels.size());
+        if (!stream)
+            return false;
+        packer.restore(header.width, header.height, skyline);
+        pixels.swap(cachedPixels);
+        for (uint32_t i = 0; i < header.glyphCount; ++i)
+        {
+            glyphs.push_back(cachedGlyphs[i]);
+            codepoints.push_back(cachedCodepoints[i]);
+            if (cachedCodepoints[i] < 256)
+                latin[cachedCodepoints[i]] = static_cast<int>(i);
+            else
+                others[cachedCodepoints[i]] = static_cast<int>(i);
+        }
+        uploadAll();
+        return true;
+    }
+
+    static uint64_t fileSize(const std::string& file)
+    {
+        std::ifstream stream(file, std::ios::binary | std::ios::ate);
+        return stream ? static_cast<uint64_t>(stream.tellg()) : 0;
+    }
+
+    void releaseFont()
+    {
+        if (face)
+            FT_Done_Face(face);
+        if (library)
+            FT_Done_FreeType(library);
+        face = nullptr;
+        library = nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Measures how long the GPU spends on consecutive sections of a frame with timestamp queries:
+// section i runs from mark(i) to mark(i + 1). A frame's queries are only read FRAMES_IN_FLIGHT
+// frames later, by which time they are normally done, so reading them doesn't stall.
+class GpuTimer
+{
+public:
+    static const unsigned int FRAMES_IN_FLIGHT = 3;
+
+    GpuTimer(unsigned int sections) : sections(sections), frame(0), collected(0), totals(sections, 0.0)
+    {
+        queries.resize(FRAMES_IN_FLIGHT * (sections + 1));
+        glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    }
+
+    // records the start of section 'point', or the end of the last section for point == sections
+    void mark(unsigned int point)
+    {
+        glQueryCounter(queries[(frame % FRAMES_IN_FLIGHT) * (sections + 1) + point], GL_TIMESTAMP);
+    }
+    // call after the last mark of a frame
+    void endFrame()
+    {
+        frame++;
+        if (frame < FRAMES_IN_FLIGHT)
+            return;
+        // the queries of the oldest frame are reused next, collect them now
+        const unsigned int* oldest = &queries[(frame % FRAMES_IN_FLIGHT) * (sections + 1)];
+        GLuint64 previous = 0, current = 0;
+        glGetQueryObjectui64v(oldest[0], GL_QUERY_RESULT, &previous);
+        for (unsigned int i = 0; i < sections; ++i)
+        {
+            glGetQueryObjectui64v(oldest[i + 1], GL_QUERY_RESULT, &current);
+            totals[i] += (current - previous) / 1000000.0;
+            previous = current;
+        }
+        collected++;
+    }
+
+    // average milliseconds of a section over the frames collected since the last reset
+    double average(unsigned int section) const
+    {
+        return collected > 0 ? totals[section] / collected : 0.0;
+    }
+    unsigned int collectedFrames() const
+    {
+        return collected;
+    }
+    void reset()
+    {
+        totals.assign(sections, 0.0);
+        collected = 0;
+    }
+
+private:
+    unsigned int sections;
+    unsigned int frame, collected;
+    std::vector<unsigned int> queries;
+    std::vector<double> totals;
+};
+
+#endif
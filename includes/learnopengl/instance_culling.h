@@ -0,0 +1,81 @@
+#ifndef INSTANCE_CULLING_H
+#define INSTANCE_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/bounds.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Layout of one command in a GL_DRAW_INDIRECT_BUFFER consumed by glDrawElementsIndirect.
+// Five tightly packed uints, which is also the std430 layout the culling compute shader uses.
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;         // index count of the mesh
+    unsigned int instanceCount; // written by the culling pass
+    unsigned int firstIndex;
+    unsigned int baseVertex;
+    unsigned int baseInstance;
+};
+
+// Extracts the 6 clip planes (left, right, bottom, top, near, far) from a view-projection matrix
+// (Gribb/Hartmann). Planes are normalized and point inwards: dot(n, p) + d >= 0 means inside.
+// The same plane data is uploaded to the compute shader so CPU and GPU make identical decisions.
+inline void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    const glm::mat4 m = glm::transpose(viewProjection); // rows of the original matrix
+    planes[0] = m[3] + m[0]; // left
+    planes[1] = m[3] - m[0]; // right
+    planes[2] = m[3] + m[1]; // bottom
+    planes[3] = m[3] - m[1]; // top
+    planes[4] = m[3] + m[2]; // near
+    planes[5] = m[3] - m[2]; // far
+    for (int i = 0; i < 6; ++i)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+// bounding sphere of a mesh-space sphere after an instance transform (conservative under non-uniform scale)
+inline glm::vec4 transformBoundingSphere(const glm::mat4& model, const BoundingSphere& sphere)
+{
+    const glm::vec3 center = glm::vec3(model * glm::vec4(sphere.center, 1.0f));
+    const float maxScale = std::sqrt(std::max(std::max(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])),
+        glm::dot(glm::vec3(model[1]), glm::vec3(model[1]))), glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))));
+    return glm::vec4(center, sphere.radius * maxScale);
+}
+
+// sphere (xyz center, w radius) against inward facing planes; mirrors the test in the culling compute shader
+inline bool isSphereInFrustum(const glm::vec4& sphere, const glm::vec4 planes[6])
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        if (glm::dot(glm::vec3(planes[i]), glm::vec3(sphere)) + planes[i].w < -sphere.w)
+            return false;
+    }
+    return true;
+}
+
+// CPU reference of the GPU culling stage: appends the indices of all visible instances, in
+// increasing order, and returns how many there are. The GPU compacts with atomics, so its list
+// holds the same set in arbitrary order; compare with sameVisibleSet().
+inline unsigned int cullInstances(const glm::mat4* instanceMatrices, unsigned int instanceCount, const BoundingSphere& meshSphere,
+    const glm::vec4 planes[6], std::vector<unsigned int>& visibleInstances)
+{
+    visibleInstances.clear();
+    for (unsigned int i = 0; i < instanceCount; ++i)
+    {
+        if (isSphereInFrustum(transformBoundingSphere(instanceMatrices[i], meshSphere), planes))
+            visibleInstances.push_back(i);
+    }
+    return static_cast<unsigned int>(visibleInstances.size());
+}
+
+// order independent comparison of two visible lists
+inline bool sameVisibleSet(std::vector<unsigned int> a, std::vector<unsigned int> b)
+{
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+#endif
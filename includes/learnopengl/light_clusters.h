@@ -0,0 +1,210 @@
+#ifndef LIGHT_CLUSTERS_H
+#define LIGHT_CLUSTERS_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/light_culling.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Clustered light assignment for forward shading. The view frustum is cut into a grid of
+// froxels: gridSize.x * gridSize.y screen tiles times gridSize.z depth slices whose thickness
+// grows exponentially with distance, so near and far clusters have similar proportions. Every
+// frame assign() lists, per cluster, the lights whose sphere touches the cluster's view space
+// bounding box. The result is compact: clusterRanges holds an (offset, count) pair per cluster
+// into the shared lightIndices array, both ready to be uploaded as SSBOs and read by
+// learnopengl/clustered_lights.glsl, which the build copies next to every shader including it.
+//
+// The cluster bounds assume a projection in which view x only depends on clip x and view y only
+// on clip y (anything built with glm::perspective or glm::frustum).
+class LightClusters
+{
+public:
+    // tiles in x and y, depth slices in z
+    glm::uvec3 gridSize;
+    // near and far plane of the projection
+    float zNear, zFar;
+    // per cluster (x fastest, then y, then slice): offset into lightIndices and number of lights
+    std::vector<glm::uvec2> clusterRanges;
+    // the lights of every cluster, back to back and in increasing order
+    std::vector<unsigned int> lightIndices;
+    // view space bounding box of every cluster
+    std::vector<glm::vec3> clusterMin, clusterMax;
+
+    LightClusters(glm::uvec3 gridSize = glm::uvec3(16, 9, 24)) : gridSize(gridSize), zNear(0.1f), zFar(100.0f)
+    {
+    }
+
+    // (re)builds the cluster bounds; call whenever the projection changes
+    // ------------------------------------------------------------------------
+    void setup(const glm::mat4& projection)
+    {
+        zNear = linearizeDepth(0.0f, projection);
+        zFar = linearizeDepth(1.0f, projection);
+        const glm::mat4 inverseProjection = glm::inverse(projection);
+        clusterMin.resize(clusterCount());
+        clusterMax.resize(clusterCount());
+        for (unsigned int z = 0; z < gridSize.z; ++z)
+        {
+            const float sliceNear = sliceDepth(z), sliceFar = sliceDepth(z + 1);
+            for (unsigned int y = 0; y < gridSize.y; ++y)
+            {
+                for (unsigned int x = 0; x < gridSize.x; ++x)
+                {
+                    // the tile's corners on the near plane, pushed out along their view rays to both slice depths
+                    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+                    for (unsigned int corner = 0; corner < 4; ++corner)
+                    {
+                        const glm::vec2 ndc = glm::vec2(static_cast<float>(x + (corner & 1)) / gridSize.x, static_cast<float>(y + (corner >> 1)) / gridSize.y) * 2.0f - 1.0f;
+                        const glm::vec4 nearPoint = inverseProjection * glm::vec4(ndc, -1.0f, 1.0f);
+                        const glm::vec3 ray = glm::vec3(nearPoint) / -nearPoint.z; // at view depth 1
+                        boundsMin = glm::min(boundsMin, glm::min(ray * sliceNear, ray * sliceFar));
+                        boundsMax = glm::max(boundsMax, glm::max(ray * sliceNear, ray * sliceFar));
+                    }
+                    clusterMin[clusterIndex(x, y, z)] = boundsMin;
+                    clusterMax[clusterIndex(x, y, z)] = boundsMax;
+                }
+            }
+        }
+    }
+
+    // Assigns lights to clusters. The depth slices are split evenly over 'threads' threads
+    // (0: one per hardware thread); each one tests every light against its own slices only and
+    // sorts its hits per cluster, so no locking is needed and the result doesn't depend on the
+    // thread count.
+    // ------------------------------------------------------------------------
+    void assign(const PointLight* lights, unsigned int lightCount, const glm::mat4& view, unsigned int threads = 0)
+    {
+        viewSpheres.resize(lightCount);
+        for (unsigned int i = 0; i < lightCount; ++i)
+            viewSpheres[i] = glm::vec4(glm::vec3(view * glm::vec4(lights[i].position, 1.0f)), lights[i].radius);
+
+        if (threads == 0)
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        threads = std::min(threads, gridSize.z);
+        workers.resize(threads);
+        std::vector<std::thread> pool;
+        for (unsigned int t = 1; t < threads; ++t)
+            pool.emplace_back(&LightClusters::assignSlices, this, t);
+        assignSlices(0);
+        for (std::thread& thread : pool)
+            thread.join();
+
+        // stitch the per-thread lists together; every thread owns a contiguous run of clusters
+        unsigned int total = 0;
+        for (const Worker& worker : workers)
+            total += static_cast<unsigned int>(worker.indices.size());
+        clusterRanges.resize(clusterCount());
+        lightIndices.resize(total);
+        unsigned int offset = 0;
+        for (const Worker& worker : workers)
+        {
+            for (unsigned int c = 0; c < worker.counts.size(); ++c)
+                clusterRanges[worker.firstCluster + c] = glm::uvec2(offset + worker.offsets[c], worker.counts[c]);
+            std::copy(worker.indices.begin(), worker.indices.end(), lightIndices.begin() + offset);
+            offset += static_cast<unsigned int>(worker.indices.size());
+        }
+    }
+
+    unsigned int clusterCount() const
+    {
+        return gridSize.x * gridSize.y * gridSize.z;
+    }
+    unsigned int clusterIndex(unsigned int x, unsigned int y, unsigned int slice) const
+    {
+        return x + gridSize.x * (y + gridSize.y * slice);
+    }
+    // view depth at which a slice starts
+    float sliceDepth(unsigned int slice) const
+    {
+        return zNear * std::pow(zFar / zNear, static_cast<float>(slice) / gridSize.z);
+    }
+    // scale and bias for finding the slice of a view depth: slice = floor(log(depth) * scale - bias)
+    glm::vec2 sliceScaleBias() const
+    {
+        const float scale = gridSize.z / std::log(zFar / zNear);
+        return glm::vec2(scale, std::log(zNear) * scale);
+    }
+    // slice of a view depth, clamped to the grid
+    unsigned int slice(float depth) const
+    {
+        const glm::vec2 scaleBias = sliceScaleBias();
+        const float s = std::floor(std::log(std::max(depth, zNear)) * scaleBias.x - scaleBias.y);
+        return std::min(static_cast<unsigned int>(std::max(s, 0.0f)), gridSize.z - 1);
+    }
+
+private:
+    // scratch space of one assignment thread, kept between frames to avoid reallocating
+    struct Worker
+    {
+        unsigned int firstCluster = 0;
+        std::vector<glm::uvec2> hits; // (local cluster, light)
+        std::vector<unsigned int> counts, offsets, indices;
+    };
+    std::vector<Worker> workers;
+    std::vector<glm::vec4> viewSpheres;
+
+    void assignSlices(unsigned int t)
+    {
+        Worker& worker = workers[t];
+        const unsigned int firstSlice = gridSize.z * t / static_cast<unsigned int>(workers.size());
+        const unsigned int lastSlice = gridSize.z * (t + 1) / static_cast<unsigned int>(workers.size());
+        const unsigned int clustersPerSlice = gridSize.x * gridSize.y;
+        worker.firstCluster = firstSlice * clustersPerSlice;
+        worker.hits.clear();
+        for (unsigned int i = 0; i < viewSpheres.size(); ++i)
+        {
+            const glm::vec4 sphere = viewSpheres[i];
+            const float depth = -sphere.z;
+            if (depth + sphere.w < zNear || depth - sphere.w > zFar)
+                continue;
+            const unsigned int s0 = std::max(slice(depth - sphere.w), firstSlice);
+            const unsigned int s1 = std::min(slice(depth + sphere.w) + 1, lastSlice);
+            for (unsigned int s = s0; s < s1; ++s)
+            {
+                // columns and rows whose x/y range overlaps the sphere's; they are sorted within a slice
+                unsigned int x0 = 0, x1 = gridSize.x, y0 = 0, y1 = gridSize.y;
+                while (x0 < x1 && clusterMax[clusterIndex(x0, 0, s)].x < sphere.x - sphere.w) ++x0;
+                while (x1 > x0 && clusterMin[clusterIndex(x1 - 1, 0, s)].x > sphere.x + sphere.w) --x1;
+                while (y0 < y1 && clusterMax[clusterIndex(0, y0, s)].y < sphere.y - sphere.w) ++y0;
+                while (y1 > y0 && clusterMin[clusterIndex(0, y1 - 1, s)].y > sphere.y + sphere.w) --y1;
+                for (unsigned int y = y0; y < y1; ++y)
+                {
+                    for (unsigned int x = x0; x < x1; ++x)
+                    {
+                        // sphere against box: squared distance from the center to the closest point of the box
+                        const unsigned int cluster = clusterIndex(x, y, s);
+                        const glm::vec3 closest = glm::clamp(glm::vec3(sphere), clusterMin[cluster], clusterMax[cluster]);
+                        const glm::vec3 d = closest - glm::vec3(sphere);
+                        if (glm::dot(d, d) <= sphere.w * sphere.w)
+                            worker.hits.push_back(glm::uvec2(cluster - worker.firstCluster, i));
+                    }
+                }
+            }
+        }
+        // counting sort of the hits by cluster; lights stay in increasing order within a cluster
+        const unsigned int clusters = (lastSlice - firstSlice) * clustersPerSlice;
+        worker.counts.assign(clusters, 0);
+        worker.offsets.resize(clusters);
+        for (const glm::uvec2& hit : worker.hits)
+            ++worker.counts[hit.x];
+        unsigned int offset = 0;
+        for (unsigned int c = 0; c < clusters; ++c)
+        {
+            worker.offsets[c] = offset;
+            offset += worker.counts[c];
+        }
+        worker.indices.resize(worker.hits.size());
+        for (const glm::uvec2& hit : worker.hits)
+            worker.indices[worker.offsets[hit.x]++] = hit.y;
+        // offsets now point at the end of each cluster's list
+        for (unsigned int c = 0; c < clusters; ++c)
+            worker.offsets[c] -= worker.counts[c];
+    }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef LIGHT_CULLING_H
+#define LIGHT_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/instance_culling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Screen tiles are LIGHT_TILE_SIZE x LIGHT_TILE_SIZE pixels and hold at most MAX_LIGHTS_PER_TILE
+// light indices. The tiled shaders define the same values; keep them in sync.
+const unsigned int LIGHT_TILE_SIZE = 16;
+const unsigned int MAX_LIGHTS_PER_TILE = 256;
+
+// One point light as stored in the light SSBO. The members are laid out like the std430 struct
+// { vec3 Position; float Radius; vec3 Color; float Linear; float Quadratic; } whose array stride
+// rounds up to 48 bytes, hence the padding.
+struct PointLight
+{
+    glm::vec3 position;
+    float radius;    // distance at which the light's contribution drops below 5/256
+    glm::vec3 color;
+    float linear;
+    float quadratic;
+    float padding[3];
+};
+
+// radius of the sphere outside of which a light with this color and attenuation (constant term 1)
+// contributes less than 5/256 of its brightness
+inline float lightVolumeRadius(const glm::vec3& color, float linear, float quadratic)
+{
+    const float maxBrightness = std::max(std::max(color.r, color.g), color.b);
+    return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * (1.0f - (256.0f / 5.0f) * maxBrightness))) / (2.0f * quadratic);
+}
+
+// number of tiles needed to cover a width x height screen
+inline glm::uvec2 lightTileCount(unsigned int width, unsigned int height)
+{
+    return glm::uvec2((width + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE, (height + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE);
+}
+
+// view space distance of a [0, 1] depth buffer value under a perspective projection
+inline float linearizeDepth(float depth, const glm::mat4& projection)
+{
+    return projection[3][2] / ((depth * 2.0f - 1.0f) + projection[2][2]);
+}
+
+// View space planes of the sub-frustum that covers one screen tile between two depth buffer values,
+// in the same inward facing, normalized form as extractFrustumPlanes. The side planes are the
+// Gribb/Hartmann planes of the projection restricted to the tile's NDC rectangle.
+inline void computeTilePlanes(const glm::mat4& projection, unsigned int tileX, unsigned int tileY, unsigned int width, unsigned int height,
+    float minDepth, float maxDepth, glm::vec4 planes[6])
+{
+    const glm::mat4 m = glm::transpose(projection); // rows of the original matrix
+    const float x0 = 2.0f * static_cast<float>(tileX * LIGHT_TILE_SIZE) / static_cast<float>(width) - 1.0f;
+    const float x1 = 2.0f * static_cast<float>((tileX + 1) * LIGHT_TILE_SIZE) / static_cast<float>(width) - 1.0f;
+    const float y0 = 2.0f * static_cast<float>(tileY * LIGHT_TILE_SIZE) / static_cast<float>(height) - 1.0f;
+    const float y1 = 2.0f * static_cast<float>((tileY + 1) * LIGHT_TILE_SIZE) / static_cast<float>(height) - 1.0f;
+    planes[0] = m[0] - x0 * m[3]; // left
+    planes[1] = x1 * m[3] - m[0]; // right
+    planes[2] = m[1] - y0 * m[3]; // bottom
+    planes[3] = y1 * m[3] - m[1]; // top
+    for (int i = 0; i < 4; ++i)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    // the camera looks down -z
+    planes[4] = glm::vec4(0.0f, 0.0f, -1.0f, -linearizeDepth(minDepth, projection)); // near
+    planes[5] = glm::vec4(0.0f, 0.0f, 1.0f, linearizeDepth(maxDepth, projection));   // far
+}
+
+// CPU reference of the tile culling compute pass. depth is the scene's depth buffer (bottom row first,
+// as read back from OpenGL); every tile's bounds are the min/max depth of its covered pixels, tiles
+// with only background (depth 1) get no lights. tileLightCounts receives the exact number of lights
+// touching each tile, row by row, while tileLightIndices holds each tile's first MAX_LIGHTS_PER_TILE
+// light indices in increasing order at tile * MAX_LIGHTS_PER_TILE. Returns the number of tiles that
+// have more lights than fit. The GPU writes the same sets in arbitrary order; compare with
+// countMismatchedTiles().
+inline unsigned int binLightsToTiles(const PointLight* lights, unsigned int lightCount, const glm::mat4& view, const glm::mat4& projection,
+    const float* depth, unsigned int width, unsigned int height, std::vector<unsigned int>& tileLightCounts, std::vector<unsigned int>& tileLightIndices)
+{
+    const glm::uvec2 tiles = lightTileCount(width, height);
+    tileLightCounts.assign(tiles.x * tiles.y, 0);
+    tileLightIndices.assign(tiles.x * tiles.y * MAX_LIGHTS_PER_TILE, 0);
+    // lights in view space, once
+    std::vector<glm::vec4> spheres(lightCount);
+    for (unsigned int i = 0; i < lightCount; ++i)
+        spheres[i] = glm::vec4(glm::vec3(view * glm::vec4(lights[i].position, 1.0f)), lights[i].radius);
+
+    unsigned int saturatedTiles = 0;
+    for (unsigned int tileY = 0; tileY < tiles.y; ++tileY)
+    {
+        for (unsigned int tileX = 0; tileX < tiles.x; ++tileX)
+        {
+            // depth bounds of the geometry in the tile
+            float minDepth = 1.0f, maxDepth = 0.0f;
+            for (unsigned int y = tileY * LIGHT_TILE_SIZE; y < std::min((tileY + 1) * LIGHT_TILE_SIZE, height); ++y)
+            {
+                for (unsigned int x = tileX * LIGHT_TILE_SIZE; x < std::min((tileX + 1) * LIGHT_TILE_SIZE, width); ++x)
+                {
+                    const float d = depth[y * width + x];
+                    if (d < 1.0f)
+                    {
+                        minDepth = std::min(minDepth, d);
+                        maxDepth = std::max(maxDepth, d);
+                    }
+                }
+            }
+            if (minDepth > maxDepth)
+                continue;
+
+            glm::vec4 planes[6];
+            computeTilePlanes(projection, tileX, tileY, width, height, minDepth, maxDepth, planes);
+            const unsigned int tile = tileY * tiles.x + tileX;
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < lightCount; ++i)
+            {
+                if (!isSphereInFrustum(spheres[i], planes))
+                    continue;
+                if (count < MAX_LIGHTS_PER_TILE)
+                    tileLightIndices[tile * MAX_LIGHTS_PER_TILE + count] = i;
+                ++count;
+            }
+            tileLightCounts[tile] = count;
+            if (count > MAX_LIGHTS_PER_TILE)
+                ++saturatedTiles;
+        }
+    }
+    return saturatedTiles;
+}
+
+// Number of tiles whose GPU light list differs from the CPU reference. The GPU clamps its counts
+// to MAX_LIGHTS_PER_TILE and fills in arbitrary order, so lists are compared as sets and a
+// saturated tile only has to be full. Lights that graze a tile plane can land on either side
+// because of float differences between CPU and GPU, so a handful of mismatches is not an error.
+inline unsigned int countMismatchedTiles(const std::vector<unsigned int>& gpuCounts, const std::vector<unsigned int>& gpuIndices,
+    const std::vector<unsigned int>& cpuCounts, const std::vector<unsigned int>& cpuIndices)
+{
+    unsigned int mismatches = 0;
+    std::vector<unsigned int> a, b;
+    for (size_t tile = 0; tile < cpuCounts.size(); ++tile)
+    {
+        if (cpuCounts[tile] > MAX_LIGHTS_PER_TILE)
+        {
+            if (gpuCounts[tile] != MAX_LIGHTS_PER_TILE)
+                ++mismatches;
+            continue;
+        }
+        if (gpuCounts[tile] != cpuCounts[tile])
+        {
+            ++mismatches;
+            continue;
+        }
+        a.assign(gpuIndices.begin() + tile * MAX_LIGHTS_PER_TILE, gpuIndices.begin() + tile * MAX_LIGHTS_PER_TILE + gpuCounts[tile]);
+        b.assign(cpuIndices.begin() + tile * MAX_LIGHTS_PER_TILE, cpuIndices.begin() + tile * MAX_LIGHTS_PER_TILE + cpuCounts[tile]);
+        std::sort(a.begin(), a.end());
+        if (a != b)
+            ++mismatches;
+    }
+    return mismatches;
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <learnopengl/shader.h>
+#include <learnopengl/bounds.h>
 
 #include <string>
 #include <vector>
@@ -43,6 +44,8 @@ public:
     vector<Vertex>       vertices;
     vector<unsigned int> indices;
     vector<Texture>      textures;
+    // bounding volumes computed once at load time, in mesh space
+    MeshBounds           bounds;
     unsigned int VAO;
 
     // constructor
@@ -51,6 +54,7 @@ public:
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
+        this->bounds = computeMeshBounds(this->vertices.empty() ? nullptr : &this->vertices[0].Position, this->vertices.size(), sizeof(Vertex));
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
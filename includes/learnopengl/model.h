@@ -29,6 +29,7 @@ public:
     // model data 
     vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
     vector<Mesh>    meshes;
+    MeshBounds      bounds;             // union of the bounds of all meshes, in model space
     string directory;
     bool gammaCorrection;
 
@@ -63,6 +64,9 @@ private:
 
         // process ASSIMP's root node recursively
         processNode(scene->mRootNode, scene);
+
+        // merge the per-mesh bounds once so culling never has to touch the vertices again
+        bounds = mergeMeshBounds(meshes.begin(), meshes.end());
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -0,0 +1,289 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OCCLUSION_USE_SSE 1
+#else
+#define OCCLUSION_USE_SSE 0
+#endif
+
+// CPU only hierarchical-Z occlusion culling.
+//
+// 1. OcclusionRasterizer renders a small set of big occluders into a low resolution depth buffer.
+// 2. DepthPyramid reduces that buffer (or a depth buffer read back from the previous GPU frame)
+//    into a max-depth mip chain.
+// 3. DepthPyramid::isBoxOccluded projects an AABB, picks the mip level where its screen rectangle
+//    covers at most 2x2 texels and compares the box's nearest depth against the farthest occluder depth.
+//
+// Depth is stored like the default GL depth range: 0 at the near plane, 1 at the far plane, and
+// row 0 is the bottom of the screen, so glReadPixels(GL_DEPTH_COMPONENT) output can be used as is.
+
+class OcclusionRasterizer
+{
+public:
+    OcclusionRasterizer(int width, int height)
+        : m_width(width), m_height(height), m_stride((width + 3) & ~3), m_depth(m_stride * height, 1.0f)
+    {
+    }
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    // rows are 'getStride()' floats apart; columns past the width are padding
+    int getStride() const { return m_stride; }
+    const float* getDepth() const { return m_depth.data(); }
+
+    void clear()
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    }
+
+    // rasterizes an indexed triangle list; positions are read through a byte stride so Vertex arrays can be used directly
+    void rasterizeMesh(const glm::mat4& modelViewProjection, const glm::vec3* positions, std::size_t positionStride,
+        const unsigned int* indices, std::size_t indexCount)
+    {
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const glm::vec4 c0 = modelViewProjection * glm::vec4(positionAt(positions, positionStride, indices[i]), 1.0f);
+            const glm::vec4 c1 = modelViewProjection * glm::vec4(positionAt(positions, positionStride, indices[i + 1]), 1.0f);
+            const glm::vec4 c2 = modelViewProjection * glm::vec4(positionAt(positions, positionStride, indices[i + 2]), 1.0f);
+            rasterizeTriangle(c0, c1, c2);
+        }
+    }
+
+    // clip space triangle. Triangles crossing the near plane are skipped rather than clipped: dropping
+    // occluder geometry only makes the culling less aggressive, never wrong.
+    void rasterizeTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+    {
+        const float nearW = 1e-5f;
+        if (c0.w <= nearW || c1.w <= nearW || c2.w <= nearW)
+            return;
+
+        const glm::vec3 v0 = toScreen(c0), v1 = toScreen(c1), v2 = toScreen(c2);
+
+        // edge equations l = a * x + b * y + k, one per edge, positive inside a counter-clockwise triangle
+        float a0 = v1.y - v2.y, b0 = v2.x - v1.x, k0 = v1.x * v2.y - v1.y * v2.x;
+        float a1 = v2.y - v0.y, b1 = v0.x - v2.x, k1 = v2.x * v0.y - v2.y * v0.x;
+        float a2 = v0.y - v1.y, b2 = v1.x - v0.x, k2 = v0.x * v1.y - v0.y * v1.x;
+        float area = k0 + k1 + k2;
+        if (std::abs(area) < 1e-8f)
+            return;
+        // occluders are rendered double sided, flip clockwise triangles
+        if (area < 0.0f)
+        {
+            a0 = -a0; b0 = -b0; k0 = -k0;
+            a1 = -a1; b1 = -b1; k1 = -k1;
+            a2 = -a2; b2 = -b2; k2 = -k2;
+            area = -area;
+        }
+
+        // depth plane z = zA * x + zB * y + zC
+        const float invArea = 1.0f / area;
+        const float zA = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+        const float zB = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+        const float zC = (k0 * v0.z + k1 * v1.z + k2 * v2.z) * invArea;
+
+        const int minX = std::max(0, static_cast<int>(std::min(std::min(v0.x, v1.x), v2.x)));
+        const int maxX = std::min(m_width - 1, static_cast<int>(std::max(std::max(v0.x, v1.x), v2.x)));
+        const int minY = std::max(0, static_cast<int>(std::min(std::min(v0.y, v1.y), v2.y)));
+        const int maxY = std::min(m_height - 1, static_cast<int>(std::max(std::max(v0.y, v1.y), v2.y)));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        // walk 4 pixel wide aligned spans; pixels outside the triangle fail the edge test
+        const int startX = minX & ~3;
+#if OCCLUSION_USE_SSE
+        const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 stepA0 = _mm_set1_ps(4.0f * a0), stepA1 = _mm_set1_ps(4.0f * a1), stepA2 = _mm_set1_ps(4.0f * a2);
+        const __m128 stepZ = _mm_set1_ps(4.0f * zA);
+        for (int y = minY; y <= maxY; ++y)
+        {
+            const float py = y + 0.5f;
+            const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(startX)), laneOffset);
+            __m128 l0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), _mm_set1_ps(b0 * py + k0));
+            __m128 l1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), _mm_set1_ps(b1 * py + k1));
+            __m128 l2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), _mm_set1_ps(b2 * py + k2));
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), _mm_set1_ps(zB * py + zC));
+            float* row = &m_depth[y * m_stride];
+            for (int x = startX; x <= maxX; x += 4)
+            {
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(l0, zero), _mm_cmpge_ps(l1, zero)), _mm_cmpge_ps(l2, zero));
+                if (_mm_movemask_ps(inside))
+                {
+                    const __m128 old = _mm_loadu_ps(row + x);
+                    const __m128 closer = _mm_min_ps(old, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+                }
+                l0 = _mm_add_ps(l0, stepA0);
+                l1 = _mm_add_ps(l1, stepA1);
+                l2 = _mm_add_ps(l2, stepA2);
+                z = _mm_add_ps(z, stepZ);
+            }
+        }
+#else
+        for (int y = minY; y <= maxY; ++y)
+        {
+            const float py = y + 0.5f;
+            float* row = &m_depth[y * m_stride];
+            for (int x = startX; x <= maxX; ++x)
+            {
+                const float px = x + 0.5f;
+                if (a0 * px + b0 * py + k0 >= 0.0f && a1 * px + b1 * py + k1 >= 0.0f && a2 * px + b2 * py + k2 >= 0.0f)
+                    row[x] = std::min(row[x], zA * px + zB * py + zC);
+            }
+        }
+#endif
+    }
+
+private:
+    int m_width, m_height, m_stride;
+    std::vector<float> m_depth;
+
+    static const glm::vec3& positionAt(const glm::vec3* positions, std::size_t stride, unsigned int index)
+    {
+        return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const std::uint8_t*>(positions) + index * stride);
+    }
+
+    // clip space -> pixel coordinates + [0, 1] depth
+    glm::vec3 toScreen(const glm::vec4& clip) const
+    {
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        return glm::vec3((ndc.x * 0.5f + 0.5f) * m_width, (ndc.y * 0.5f + 0.5f) * m_height, ndc.z * 0.5f + 0.5f);
+    }
+};
+
+class DepthPyramid
+{
+public:
+    // builds the max-depth mip chain; 'stride' is the distance between rows of the source in floats
+    void build(const float* depth, int width, int height, int stride)
+    {
+        m_levels.resize(0);
+        m_sizes.resize(0);
+        if (width <= 0 || height <= 0)
+            return;
+
+        std::vector<float> base(static_cast<std::size_t>(width) * height);
+        for (int y = 0; y < height; ++y)
+            std::copy(depth + y * stride, depth + y * stride + width, base.begin() + y * width);
+        m_levels.push_back(std::move(base));
+        m_sizes.push_back(glm::ivec2(width, height));
+
+        while (width > 1 || height > 1)
+        {
+            const int srcWidth = width, srcHeight = height;
+            width = std::max(1, (width + 1) / 2);
+            height = std::max(1, (height + 1) / 2);
+            const std::vector<float>& src = m_levels.back();
+            std::vector<float> dst(static_cast<std::size_t>(width) * height);
+            for (int y = 0; y < height; ++y)
+            {
+                const int y0 = 2 * y, y1 = std::min(2 * y + 1, srcHeight - 1);
+                for (int x = 0; x < width; ++x)
+                {
+                    const int x0 = 2 * x, x1 = std::min(2 * x + 1, srcWidth - 1);
+                    dst[y * width + x] = std::max(std::max(src[y0 * srcWidth + x0], src[y0 * srcWidth + x1]),
+                        std::max(src[y1 * srcWidth + x0], src[y1 * srcWidth + x1]));
+                }
+            }
+            m_levels.push_back(std::move(dst));
+            m_sizes.push_back(glm::ivec2(width, height));
+        }
+    }
+
+    void build(const OcclusionRasterizer& rasterizer)
+    {
+        build(rasterizer.getDepth(), rasterizer.getWidth(), rasterizer.getHeight(), rasterizer.getStride());
+    }
+
+    int getLevelCount() const { return static_cast<int>(m_levels.size()); }
+    const glm::ivec2& getLevelSize(int level) const { return m_sizes[level]; }
+    float getDepth(int level, int x, int y) const { return m_levels[level][y * m_sizes[level].x + x]; }
+
+    // true if the world space box is entirely behind the occluders
+    bool isBoxOccluded(const glm::mat4& viewProjection, const glm::vec3& boxMin, const glm::vec3& boxMax) const
+    {
+        if (m_levels.empty())
+            return false;
+
+        glm::vec2 screenMin(1e30f), screenMax(-1e30f);
+        float nearestDepth = 1.0f;
+        for (int i = 0; i < 8; ++i)
+        {
+            const glm::vec3 corner((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+            const glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+            // box reaches behind the camera: we can't bound its projection, keep it
+            if (clip.w <= 1e-5f)
+                return false;
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screenMin = glm::min(screenMin, glm::vec2(ndc));
+            screenMax = glm::max(screenMax, glm::vec2(ndc));
+            nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+        }
+
+        const glm::ivec2 size = m_sizes[0];
+        const int x0 = std::max(0, static_cast<int>((screenMin.x * 0.5f + 0.5f) * size.x));
+        const int y0 = std::max(0, static_cast<int>((screenMin.y * 0.5f + 0.5f) * size.y));
+        const int x1 = std::min(size.x - 1, static_cast<int>((screenMax.x * 0.5f + 0.5f) * size.x));
+        const int y1 = std::min(size.y - 1, static_cast<int>((screenMax.y * 0.5f + 0.5f) * size.y));
+        // off screen boxes are the frustum test's business
+        if (x0 > x1 || y0 > y1)
+            return false;
+
+        // coarsest level at which the rectangle still only touches 2x2 texels
+        int level = 0;
+        while (level + 1 < getLevelCount() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+            ++level;
+
+        float farthestOccluder = 0.0f;
+        for (int y = y0 >> level; y <= (y1 >> level); ++y)
+            for (int x = x0 >> level; x <= (x1 >> level); ++x)
+                farthestOccluder = std::max(farthestOccluder, getDepth(level, x, y));
+        return nearestDepth > farthestOccluder;
+    }
+
+private:
+    std::vector<std::vector<float>> m_levels;
+    std::vector<glm::ivec2> m_sizes;
+};
+
+// per frame culling state handed down the scene graph
+struct OcclusionCuller
+{
+    OcclusionRasterizer rasterizer;
+    DepthPyramid pyramid;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+
+    OcclusionCuller(int width, int height) : rasterizer(width, height) {}
+
+    void beginFrame(const glm::mat4& inViewProjection)
+    {
+        viewProjection = inViewProjection;
+        rasterizer.clear();
+    }
+
+    void addOccluder(const glm::mat4& model, const glm::vec3* positions, std::size_t positionStride, const unsigned int* indices, std::size_t indexCount)
+    {
+        rasterizer.rasterizeMesh(viewProjection * model, positions, positionStride, indices, indexCount);
+    }
+
+    void endOccluders()
+    {
+        pyramid.build(rasterizer);
+    }
+
+    bool isOccluded(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+    {
+        return pyramid.isBoxOccluded(viewProjection, boxMin, boxMax);
+    }
+};
+#endif
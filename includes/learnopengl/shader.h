@@ -13,9 +13,10 @@ class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+    // constructor generates the shader on the fly; defines (e.g. "#define SOME_OPTION\n") are
+    // inserted right after the #version line of every stage
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::string &defines = "")
     {
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
@@ -57,6 +58,15 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
         }
+        // paste in shared snippets
+        vertexCode = resolveIncludes(vertexCode, vertexPath);
+        fragmentCode = resolveIncludes(fragmentCode, fragmentPath);
+        if(geometryPath != nullptr)
+            geometryCode = resolveIncludes(geometryCode, geometryPath);
+        vertexCode = insertDefines(vertexCode, defines);
+        fragmentCode = insertDefines(fragmentCode, defines);
+        if(geometryPath != nullptr)
+            geometryCode = insertDefines(geometryCode, defines);
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
         // 2. compile shaders
@@ -162,6 +172,52 @@ public:
     }
 
 private:
+    // GLSL has no #include, so lines of the form  #include "file"  are replaced here by the contents
+    // of that file, looked up next to the including shader. Included files may include others.
+    // ------------------------------------------------------------------------
+    static std::string resolveIncludes(const std::string &code, const std::string &path, int depth = 0)
+    {
+        if(code.find("#include") == std::string::npos)
+            return code;
+        const std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::istringstream lines(code);
+        std::string line, result;
+        while(std::getline(lines, line))
+        {
+            size_t start = line.find_first_not_of(" \t");
+            size_t open = line.find('"');
+            size_t close = line.find('"', open + 1);
+            if(start == std::string::npos || line.compare(start, 8, "#include") != 0 || close == std::string::npos)
+            {
+                result += line + "\n";
+                continue;
+            }
+            const std::string includePath = directory + line.substr(open + 1, close - open - 1);
+            std::ifstream includeFile(includePath);
+            if(!includeFile || depth >= 8)
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_NOT_SUCCESFULLY_READ: " << includePath << std::endl;
+                continue;
+            }
+            std::stringstream includeStream;
+            includeStream << includeFile.rdbuf();
+            result += resolveIncludes(includeStream.str(), includePath, depth + 1) + "\n";
+        }
+        return result;
+    }
+    // inserts defines after the #version line, which has to stay first
+    // ------------------------------------------------------------------------
+    static std::string insertDefines(const std::string &code, const std::string &defines)
+    {
+        if(defines.empty())
+            return code;
+        if(code.compare(0, 8, "#version") != 0)
+            return defines + code;
+        size_t line = code.find('\n');
+        if(line == std::string::npos)
+            return code + "\n" + defines;
+        return code.substr(0, line + 1) + defines + code.substr(line + 1);
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
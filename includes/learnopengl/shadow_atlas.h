@@ -0,0 +1,342 @@
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// A point light needs six shadow views (one per cube face), a spot light one.
+enum ShadowLightType
+{
+    SHADOW_POINT_LIGHT,
+    SHADOW_SPOT_LIGHT
+};
+
+inline unsigned int shadowFaceCount(ShadowLightType type)
+{
+    return type == SHADOW_POINT_LIGHT ? 6 : 1;
+}
+
+// Size in pixels of a light's sphere of influence on screen: the radius of its projected circle,
+// or the screen height when the camera is inside it. viewSphere is the sphere in view space
+// (xyz center, w radius), fovy the vertical field of view.
+inline float shadowScreenSize(const glm::vec4& viewSphere, float fovy, unsigned int screenHeight)
+{
+    const float distanceSquared = glm::dot(glm::vec3(viewSphere), glm::vec3(viewSphere));
+    if (distanceSquared <= viewSphere.w * viewSphere.w)
+        return static_cast<float>(screenHeight);
+    const float tangent = viewSphere.w / std::sqrt(distanceSquared - viewSphere.w * viewSphere.w);
+    return std::min(tangent / std::tan(fovy * 0.5f) * screenHeight * 0.5f, static_cast<float>(screenHeight));
+}
+
+// square region of the atlas in texels; size 0 means none
+struct ShadowAtlasTile
+{
+    unsigned int x = 0, y = 0, size = 0;
+};
+
+// Packs the shadow maps of many point and spot lights into one square depth texture. The
+// allocator only does the bookkeeping and never touches OpenGL.
+//
+// Tiles are power of two squares handed out by a quadtree buddy allocator: a free tile is split
+// into four when a smaller one is needed, and four free siblings merge back into their parent.
+// Every frame update() takes each light's importance, its size on screen in pixels (0 when it
+// isn't visible), and
+//  - picks a tile size proportional to it, with some hysteresis so lights near a boundary don't
+//    flip between sizes every frame;
+//  - keeps the tiles of lights that go out of view as a cache: a static light that comes back
+//    before its tiles were needed elsewhere doesn't have to be rendered again. When the atlas is
+//    full the least recently visible light loses its tiles first; visible lights are never
+//    evicted, a light that doesn't fit gets smaller tiles or none instead;
+//  - renders at most faceBudget shadow views per frame. Lights without any shadow go first, then
+//    stale (moved) or resized ones by importance; the rest keep their current map until a later
+//    frame. Tiles are only reallocated for lights that are rendered in the same frame, so a
+//    light's tiles always hold a complete, if possibly outdated, shadow map.
+class ShadowAtlas
+{
+public:
+    struct Light
+    {
+        ShadowLightType type = SHADOW_POINT_LIGHT;
+        bool isStatic = true;
+        // current allocation; all faces share the tile size
+        ShadowAtlasTile tiles[6];
+        unsigned int tileSize = 0;
+        // tiles hold a shadow map of the light's current position
+        bool upToDate = false;
+        // last frame the light was visible
+        unsigned int lastVisible = 0;
+    };
+
+    // statistics of the last update
+    struct Stats
+    {
+        unsigned int visibleLights = 0;
+        unsigned int shadowedLights = 0;  // visible lights that have tiles
+        unsigned int renderedLights = 0;
+        unsigned int renderedFaces = 0;
+        unsigned int deferredLights = 0;  // would have been rendered without the budget
+        unsigned int cacheHits = 0;       // visible again and still up to date
+        unsigned int evictions = 0;
+    };
+
+    unsigned int atlasSize, maxTileSize, minTileSize;
+    unsigned int faceBudget;
+    // tile edge per pixel of screen size
+    float resolutionScale;
+    std::vector<Light> lights;
+    // lights whose tiles have to be rendered this frame, most important first
+    std::vector<unsigned int> renderList;
+    Stats stats;
+
+    ShadowAtlas(unsigned int atlasSize = 4096, unsigned int maxTileSize = 1024, unsigned int minTileSize = 64, unsigned int faceBudget = 24)
+        : atlasSize(atlasSize), maxTileSize(std::min(maxTileSize, atlasSize)), minTileSize(std::min(minTileSize, maxTileSize)),
+          faceBudget(faceBudget), resolutionScale(2.0f), frame(0)
+    {
+        reset();
+    }
+
+    // forgets all allocations, keeping the lights
+    void reset()
+    {
+        levels = 0;
+        while ((atlasSize >> levels) > minTileSize)
+            ++levels;
+        freeTiles.assign(levels + 1, std::vector<glm::uvec2>());
+        freeTiles[0].push_back(glm::uvec2(0));
+        for (Light& light : lights)
+        {
+            light.tileSize = 0;
+            light.upToDate = false;
+        }
+    }
+
+    unsigned int addLight(ShadowLightType type, bool isStatic)
+    {
+        Light light;
+        light.type = type;
+        light.isStatic = isStatic;
+        lights.push_back(light);
+        return static_cast<unsigned int>(lights.size() - 1);
+    }
+    // the light moved: its shadow map has to be rendered again before it is up to date
+    void invalidate(unsigned int light)
+    {
+        lights[light].upToDate = false;
+    }
+
+    // tile edge for a screen size, before hysteresis
+    unsigned int tileSizeFor(float screenSize) const
+    {
+        const float wanted = screenSize * resolutionScale;
+        unsigned int size = minTileSize;
+        while (size < maxTileSize && static_cast<float>(size) < wanted)
+            size *= 2;
+        return size;
+    }
+
+    // Assigns tiles for a frame; screenSizes holds one importance per light (see shadowScreenSize),
+    // 0 for lights that are out of view. Afterwards renderList names the lights to render.
+    void update(const float* screenSizes)
+    {
+        ++frame;
+        stats = Stats();
+        renderList.clear();
+        candidates.clear();
+        for (unsigned int i = 0; i < lights.size(); ++i)
+        {
+            Light& light = lights[i];
+            if (screenSizes[i] <= 0.0f)
+                continue;
+            ++stats.visibleLights;
+            if (light.tileSize != 0 && light.upToDate && light.lastVisible + 1 < frame)
+                ++stats.cacheHits;
+            light.lastVisible = frame;
+
+            unsigned int wanted = tileSizeFor(screenSizes[i]);
+            // hysteresis: keep the current size while the wanted edge stays within 0.4x to 1.2x of it
+            const float scaled = screenSizes[i] * resolutionScale;
+            if (light.tileSize != 0 && scaled > 0.4f * light.tileSize && scaled < 1.2f * light.tileSize)
+                wanted = light.tileSize;
+            if (light.tileSize != wanted || !light.upToDate)
+                candidates.push_back(Candidate{ i, wanted, screenSizes[i] });
+        }
+
+        // lights without a shadow map first, then the most important
+        std::sort(candidates.begin(), candidates.end(), [this](const Candidate& a, const Candidate& b) {
+            const bool aEmpty = lights[a.light].tileSize == 0, bEmpty = lights[b.light].tileSize == 0;
+            if (aEmpty != bEmpty)
+                return aEmpty;
+            if (a.screenSize != b.screenSize)
+                return a.screenSize > b.screenSize;
+            return a.light < b.light;
+        });
+        unsigned int budget = faceBudget;
+        for (const Candidate& candidate : candidates)
+        {
+            Light& light = lights[candidate.light];
+            const unsigned int faces = shadowFaceCount(light.type);
+            if (faces > budget)
+            {
+                ++stats.deferredLights;
+                continue;
+            }
+            if (light.tileSize != candidate.tileSize && !reallocate(candidate.light, candidate.tileSize))
+            {
+                // nothing fits; a light that still has its old tiles refreshes those
+                if (light.tileSize == 0)
+                    continue;
+            }
+            light.upToDate = true;
+            renderList.push_back(candidate.light);
+            budget -= faces;
+            ++stats.renderedLights;
+            stats.renderedFaces += faces;
+        }
+        for (unsigned int i = 0; i < lights.size(); ++i)
+        {
+            if (screenSizes[i] > 0.0f && lights[i].tileSize != 0)
+                ++stats.shadowedLights;
+        }
+    }
+
+    // atlas area in use, including the cache of invisible lights, from 0 to 1
+    float occupancy() const
+    {
+        double freeArea = 0.0;
+        for (unsigned int level = 0; level <= levels; ++level)
+            freeArea += static_cast<double>(freeTiles[level].size()) * (atlasSize >> level) * (atlasSize >> level);
+        return static_cast<float>(1.0 - freeArea / (static_cast<double>(atlasSize) * atlasSize));
+    }
+
+private:
+    struct Candidate
+    {
+        unsigned int light;
+        unsigned int tileSize;
+        float screenSize;
+    };
+    unsigned int frame;
+    // level 0 is the whole atlas, every level halves the tile edge down to minTileSize
+    unsigned int levels;
+    std::vector<std::vector<glm::uvec2>> freeTiles;
+    std::vector<Candidate> candidates;
+
+    unsigned int levelOf(unsigned int size) const
+    {
+        unsigned int level = 0;
+        while ((atlasSize >> level) > size)
+            ++level;
+        return level;
+    }
+
+    bool allocateTile(unsigned int level, glm::uvec2& tile)
+    {
+        if (!freeTiles[level].empty())
+        {
+            tile = freeTiles[level].back();
+            freeTiles[level].pop_back();
+            return true;
+        }
+        glm::uvec2 parent;
+        if (level == 0 || !allocateTile(level - 1, parent))
+            return false;
+        // keep three quarters, hand out the first
+        const unsigned int half = atlasSize >> level;
+        freeTiles[level].push_back(parent + glm::uvec2(half, half));
+        freeTiles[level].push_back(parent + glm::uvec2(0, half));
+        freeTiles[level].push_back(parent + glm::uvec2(half, 0));
+        tile = parent;
+        return true;
+    }
+
+    void freeTile(unsigned int level, glm::uvec2 tile)
+    {
+        while (level > 0)
+        {
+            // merge with the three siblings if they are all free
+            const unsigned int size = atlasSize >> level;
+            const glm::uvec2 parent = (tile / (2 * size)) * (2 * size);
+            std::vector<glm::uvec2>& list = freeTiles[level];
+            unsigned int siblings = 0;
+            for (const glm::uvec2& t : list)
+            {
+                if (t != tile && (t / (2 * size)) * (2 * size) == parent)
+                    ++siblings;
+            }
+            if (siblings < 3)
+                break;
+            list.erase(std::remove_if(list.begin(), list.end(), [&](const glm::uvec2& t) { return (t / (2 * size)) * (2 * size) == parent; }), list.end());
+            tile = parent;
+            --level;
+        }
+        freeTiles[level].push_back(tile);
+    }
+
+    void release(Light& light)
+    {
+        for (unsigned int face = 0; face < shadowFaceCount(light.type); ++face)
+            freeTile(levelOf(light.tileSize), glm::uvec2(light.tiles[face].x, light.tiles[face].y));
+        light.tileSize = 0;
+        light.upToDate = false;
+    }
+
+    // allocates all faces of a light at 'size', or tries smaller sizes, evicting the least recently
+    // visible cached lights when the atlas is full; the old tiles are released only on success
+    bool reallocate(unsigned int index, unsigned int size)
+    {
+        Light& light = lights[index];
+        const unsigned int faces = shadowFaceCount(light.type);
+        for (; size >= minTileSize; size /= 2)
+        {
+            if (size == light.tileSize)
+                return false;
+            glm::uvec2 tiles[6];
+            unsigned int allocated = 0;
+            const unsigned int level = levelOf(size);
+            while (allocated < faces)
+            {
+                if (allocateTile(level, tiles[allocated]))
+                {
+                    ++allocated;
+                    continue;
+                }
+                if (!evictLeastRecentlyVisible())
+                    break;
+            }
+            if (allocated == faces)
+            {
+                if (light.tileSize != 0)
+                    release(light);
+                for (unsigned int face = 0; face < faces; ++face)
+                    light.tiles[face] = ShadowAtlasTile{ tiles[face].x, tiles[face].y, size };
+                light.tileSize = size;
+                return true;
+            }
+            for (unsigned int face = 0; face < allocated; ++face)
+                freeTile(level, tiles[face]);
+            if (size == minTileSize)
+                break;
+        }
+        return false;
+    }
+
+    bool evictLeastRecentlyVisible()
+    {
+        Light* oldest = nullptr;
+        for (Light& light : lights)
+        {
+            if (light.tileSize != 0 && light.lastVisible < frame && (!oldest || light.lastVisible < oldest->lastVisible))
+                oldest = &light;
+        }
+        if (!oldest)
+            return false;
+        release(*oldest);
+        ++stats.evictions;
+        return true;
+    }
+};
+
+#endif
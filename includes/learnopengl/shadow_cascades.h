@@ -0,0 +1,185 @@
+#ifndef SHADOW_CASCADES_H
+#define SHADOW_CASCADES_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/light_culling.h>
+
+#include <algorithm>
+#include <cmath>
+
+// The cascade shaders declare lightSpaceMatrices[16]; keep in sync.
+const unsigned int MAX_SHADOW_CASCADES = 16;
+// number of logarithmic bins used by reduceDepthRange
+const unsigned int DEPTH_HISTOGRAM_BINS = 256;
+
+// world space corners of the frustum of a view-projection matrix; corner x * 4 + y * 2 + z sits
+// at NDC (2x - 1, 2y - 1, 2z - 1)
+inline void frustumCornersWorldSpace(const glm::mat4& viewProjection, glm::vec3 corners[8])
+{
+    const glm::mat4 inverse = glm::inverse(viewProjection);
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        const glm::vec4 corner = inverse * glm::vec4(2.0f * (i >> 2) - 1.0f, 2.0f * ((i >> 1) & 1) - 1.0f, 2.0f * (i & 1) - 1.0f, 1.0f);
+        corners[i] = glm::vec3(corner) / corner.w;
+    }
+}
+
+// Practical split scheme: a blend of the logarithmic split, which gives every cascade the same
+// texel density relative to depth, and the uniform split, which doesn't spend most of the
+// cascades close to the near plane. 'fraction' runs from 0 (near) to 1 (far), lambda from 0
+// (uniform) to 1 (logarithmic).
+inline float practicalSplitDistance(float zNear, float zFar, float fraction, float lambda)
+{
+    const float logSplit = zNear * std::pow(zFar / zNear, fraction);
+    const float uniformSplit = zNear + (zFar - zNear) * fraction;
+    return lambda * logSplit + (1.0f - lambda) * uniformSplit;
+}
+
+// Depth histogram reduction: bins the view distance of every covered sample of a [0, 1] depth
+// buffer (depth 1 is background) logarithmically between the projection's near and far plane
+// and returns the range from the first to the last non-empty bin, which encloses all samples and
+// overshoots by at most one bin. 'histogram' is scratch space. Returns false if no sample is
+// covered, leaving 'range' untouched.
+inline bool reduceDepthRange(const float* depth, unsigned int count, const glm::mat4& projection, unsigned int histogram[DEPTH_HISTOGRAM_BINS], glm::vec2& range)
+{
+    const float zNear = linearizeDepth(0.0f, projection), zFar = linearizeDepth(1.0f, projection);
+    const float scale = DEPTH_HISTOGRAM_BINS / std::log(zFar / zNear);
+    std::fill(histogram, histogram + DEPTH_HISTOGRAM_BINS, 0u);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (depth[i] >= 1.0f)
+            continue;
+        const float bin = std::log(std::max(linearizeDepth(depth[i], projection), zNear) / zNear) * scale;
+        ++histogram[std::min(static_cast<unsigned int>(bin), DEPTH_HISTOGRAM_BINS - 1)];
+    }
+    unsigned int first = 0, last = DEPTH_HISTOGRAM_BINS;
+    while (first < DEPTH_HISTOGRAM_BINS && histogram[first] == 0) ++first;
+    while (last > first && histogram[last - 1] == 0) --last;
+    if (first == last)
+        return false;
+    range = glm::vec2(zNear * std::pow(zFar / zNear, static_cast<float>(first) / DEPTH_HISTOGRAM_BINS),
+        zNear * std::pow(zFar / zNear, static_cast<float>(last) / DEPTH_HISTOGRAM_BINS));
+    return true;
+}
+
+// Fits orthographic shadow cascades of a directional light to slices of a perspective camera.
+//
+// Every cascade covers the bounding sphere of its slice instead of the slice itself. The sphere
+// only depends on the split distances and the field of view, so the shadow map keeps its size
+// when the camera turns, and its origin is snapped to whole texels of a fixed light rotation, so
+// moving the camera slides the map in texel steps; together that removes the shimmering of
+// tightly fitted cascades.
+//
+// Cascades are also cached: a cascade is fitted cacheMargin larger than needed and kept (with
+// the matrix it was rendered with) for as long as the current slice sphere still fits inside it.
+// Small cascades close to the camera get small margins and are refitted often, far cascades
+// only after the camera has moved a good part of their size. update() flags the cascades whose
+// shadow map has to be rendered again; everything lives in fixed arrays, so nothing allocates.
+class ShadowCascades
+{
+public:
+    unsigned int count;      // number of cascades
+    unsigned int resolution; // shadow map size in texels
+    float lambda;            // practical split scheme blend, see practicalSplitDistance
+    float cacheMargin;       // how much larger than needed cascades are fitted, relative to their size
+    bool caching;            // false: refit every cascade every update
+    // view distances bounding the cascades: cascade i covers splits[i] to splits[i + 1]
+    float splits[MAX_SHADOW_CASCADES + 1];
+    // light space matrix each cascade's shadow map was rendered with, and its planes for caster culling
+    glm::mat4 lightSpaceMatrices[MAX_SHADOW_CASCADES];
+    glm::vec4 planes[MAX_SHADOW_CASCADES][6];
+    // whether the cascade was refitted by the last update and has to be rendered again
+    bool dirty[MAX_SHADOW_CASCADES];
+
+    ShadowCascades(unsigned int count, unsigned int resolution, float lambda = 0.9f, float cacheMargin = 0.1f)
+        : count(std::min(count, MAX_SHADOW_CASCADES)), resolution(resolution), lambda(lambda), cacheMargin(cacheMargin), caching(true),
+          lightRotation(1.0f), sceneSphere(0.0f)
+    {
+        std::fill(splits, splits + MAX_SHADOW_CASCADES + 1, 0.0f);
+        std::fill(dirty, dirty + MAX_SHADOW_CASCADES, false);
+        invalidate();
+    }
+
+    // direction towards the light; refits all cascades on the next update
+    void setLightDirection(const glm::vec3& direction)
+    {
+        const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        lightRotation = glm::lookAt(glm::vec3(0.0f), -direction, up);
+        invalidate();
+    }
+    // world space sphere around all shadow casters; the cascades reach towards the light up to it
+    void setSceneBounds(const glm::vec4& sphere)
+    {
+        sceneSphere = sphere;
+        invalidate();
+    }
+    // forces every cascade to be refitted and rendered on the next update, e.g. after casters moved
+    void invalidate()
+    {
+        std::fill(fitted, fitted + MAX_SHADOW_CASCADES, glm::vec4(0.0f));
+    }
+
+    // Splits the camera's view range [zNear, zFar] and refits the cascades that no longer cover
+    // their slice. 'view' is the camera's view matrix, fovy and aspect those of its projection.
+    // Returns how many cascades are dirty.
+    unsigned int update(const glm::mat4& view, float fovy, float aspect, float zNear, float zFar)
+    {
+        for (unsigned int i = 0; i <= count; ++i)
+            splits[i] = practicalSplitDistance(zNear, zFar, static_cast<float>(i) / count, lambda);
+        splits[0] = zNear; // exact, the blend can be off by rounding
+        splits[count] = zFar;
+
+        const glm::mat4 cameraToWorld = glm::inverse(view);
+        const glm::vec3 position = glm::vec3(cameraToWorld[3]), forward = -glm::vec3(cameraToWorld[2]);
+        // distance from the view axis to a frustum corner at depth 1
+        const float cornerSlope = std::tan(fovy * 0.5f) * std::sqrt(1.0f + aspect * aspect);
+        unsigned int dirtyCount = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            // smallest sphere around the slice: its center on the view axis is equally far from the
+            // near and the far corners, unless that lies beyond the far plane
+            const float sliceNear = splits[i], sliceFar = splits[i + 1];
+            const float centerDepth = std::min((sliceNear + sliceFar) * 0.5f * (1.0f + cornerSlope * cornerSlope), sliceFar);
+            const float radius = std::sqrt((sliceFar - centerDepth) * (sliceFar - centerDepth) + sliceFar * sliceFar * cornerSlope * cornerSlope);
+            const glm::vec3 center = position + forward * centerDepth;
+
+            // keep the cascade while the slice is inside it and it isn't needlessly large
+            const float keptRadius = fitted[i].w;
+            dirty[i] = !caching || keptRadius == 0.0f || glm::length(center - glm::vec3(fitted[i])) + radius > keptRadius ||
+                keptRadius > radius * (1.0f + cacheMargin) * (1.0f + cacheMargin);
+            if (!dirty[i])
+                continue;
+            fit(i, center, caching ? radius * (1.0f + cacheMargin) : radius);
+            ++dirtyCount;
+        }
+        return dirtyCount;
+    }
+
+private:
+    glm::mat4 lightRotation;
+    glm::vec4 sceneSphere;
+    // world space sphere each cascade covers, radius 0 if it has to be refitted
+    glm::vec4 fitted[MAX_SHADOW_CASCADES];
+
+    void fit(unsigned int i, const glm::vec3& center, float radius)
+    {
+        // snapping moves the map by up to half a texel on each axis; grow it so it still covers the sphere
+        const float halfSize = radius * resolution / (resolution - 1.0f);
+        const float texelSize = 2.0f * halfSize / resolution;
+        glm::vec3 lightCenter = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+        lightCenter.x = std::round(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::round(lightCenter.y / texelSize) * texelSize;
+        // the light looks down -z: reach back to the casters between the light and the sphere
+        const float sceneTop = glm::vec3(lightRotation * glm::vec4(glm::vec3(sceneSphere), 1.0f)).z + sceneSphere.w;
+        const float zMax = std::max(lightCenter.z + radius, sceneTop), zMin = lightCenter.z - radius;
+        const glm::mat4 projection = glm::ortho(lightCenter.x - halfSize, lightCenter.x + halfSize, lightCenter.y - halfSize, lightCenter.y + halfSize, -zMax, -zMin);
+
+        lightSpaceMatrices[i] = projection * lightRotation;
+        extractFrustumPlanes(lightSpaceMatrices[i], planes[i]);
+        fitted[i] = glm::vec4(center, radius);
+    }
+};
+
+#endif
@@ -0,0 +1,671 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/bounds.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// Spatial indices answering "what is near X" queries for dynamic objects.
+//
+// Objects are identified by a caller chosen id (typically the index into the caller's own array)
+// and are stored as boxes. Both indices support insert/update/remove, a bulk rebuild and
+// sphere/box/ray queries; the 3D versions also support frustum queries. Queries report each
+// matching id once through a callback and never allocate: de-duplication uses a per-object stamp
+// instead of a visited set, and traversal stacks are fixed size.
+//
+//   SpatialHash<2>  uniform grid hashed by cell coordinate; best for many similarly sized objects
+//   SpatialHash<3>  same in 3D
+//   LooseOctree     hierarchical, objects live at the depth matching their size; best for mixed sizes
+
+template<int D>
+struct SpatialBox
+{
+    glm::vec<D, float> min = glm::vec<D, float>(0.0f);
+    glm::vec<D, float> max = glm::vec<D, float>(0.0f);
+
+    SpatialBox() = default;
+    SpatialBox(const glm::vec<D, float>& inMin, const glm::vec<D, float>& inMax) : min(inMin), max(inMax) {}
+};
+
+inline SpatialBox<3> toSpatialBox(const BoundingBox& box)
+{
+    return SpatialBox<3>(box.min, box.max);
+}
+
+template<int D>
+inline bool spatialBoxesOverlap(const SpatialBox<D>& a, const SpatialBox<D>& b)
+{
+    for (int i = 0; i < D; ++i)
+    {
+        if (a.max[i] < b.min[i] || b.max[i] < a.min[i])
+            return false;
+    }
+    return true;
+}
+
+template<int D>
+inline bool spatialBoxOverlapsSphere(const SpatialBox<D>& box, const glm::vec<D, float>& center, float radius)
+{
+    const glm::vec<D, float> closest = glm::clamp(center, box.min, box.max);
+    const glm::vec<D, float> diff = center - closest;
+    return glm::dot(diff, diff) <= radius * radius;
+}
+
+// slab test narrowing [tMin, tMax] to the part of the ray inside the box, false if nothing is left;
+// 'invDirection' is 1 / direction (infinite components are fine)
+template<int D>
+inline bool spatialClipRay(const SpatialBox<D>& box, const glm::vec<D, float>& origin, const glm::vec<D, float>& invDirection, float& tMin, float& tMax)
+{
+    for (int i = 0; i < D; ++i)
+    {
+        float t0 = (box.min[i] - origin[i]) * invDirection[i];
+        float t1 = (box.max[i] - origin[i]) * invDirection[i];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        // NaN (0 * inf when the origin lies on a slab) compares false and leaves the interval untouched
+        if (t0 > tMin) tMin = t0;
+        if (t1 < tMax) tMax = t1;
+        if (tMin > tMax)
+            return false;
+    }
+    return true;
+}
+
+template<int D>
+inline bool spatialBoxOverlapsRay(const SpatialBox<D>& box, const glm::vec<D, float>& origin, const glm::vec<D, float>& invDirection, float maxDistance)
+{
+    float tMin = 0.0f, tMax = maxDistance;
+    return spatialClipRay(box, origin, invDirection, tMin, tMax);
+}
+
+// planes as in extractFrustumPlanes(): normalized, pointing inwards
+inline bool spatialBoxOverlapsFrustum(const SpatialBox<3>& box, const glm::vec4 planes[6])
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        // farthest corner along the plane normal
+        const glm::vec3 positive(planes[i].x >= 0.0f ? box.max.x : box.min.x,
+            planes[i].y >= 0.0f ? box.max.y : box.min.y,
+            planes[i].z >= 0.0f ? box.max.z : box.min.z);
+        if (glm::dot(glm::vec3(planes[i]), positive) + planes[i].w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+template<int D>
+class SpatialHash
+{
+public:
+    typedef glm::vec<D, float> Vec;
+    typedef glm::vec<D, int> Cell;
+    typedef SpatialBox<D> Box;
+
+    static constexpr float MIN_CELL_SIZE = 1e-6f;
+
+    // cell edges that are not positive (or NaN) are raised to MIN_CELL_SIZE
+    explicit SpatialHash(float cellSize = 1.0f)
+        : m_cellSize(cellSize > MIN_CELL_SIZE ? cellSize : MIN_CELL_SIZE), m_invCellSize(1.0f / m_cellSize) {}
+
+    float getCellSize() const { return m_cellSize; }
+    std::size_t size() const { return m_count; }
+
+    void insert(unsigned int id, const Box& box)
+    {
+        if (id >= m_objects.size())
+        {
+            m_objects.resize(id + 1);
+            m_stamps.resize(id + 1, 0);
+        }
+        Object& object = m_objects[id];
+        if (object.inserted)
+        {
+            update(id, box);
+            return;
+        }
+        object.box = box;
+        object.minCell = toCell(box.min);
+        object.maxCell = toCell(box.max);
+        object.inserted = true;
+        addToCells(id, object.minCell, object.maxCell);
+        ++m_count;
+    }
+
+    // cheap when the object stays within the same cells
+    void update(unsigned int id, const Box& box)
+    {
+        if (id >= m_objects.size() || !m_objects[id].inserted)
+        {
+            insert(id, box);
+            return;
+        }
+        Object& object = m_objects[id];
+        object.box = box;
+        const Cell minCell = toCell(box.min), maxCell = toCell(box.max);
+        if (minCell == object.minCell && maxCell == object.maxCell)
+            return;
+        removeFromCells(id, object.minCell, object.maxCell);
+        object.minCell = minCell;
+        object.maxCell = maxCell;
+        addToCells(id, minCell, maxCell);
+    }
+
+    void remove(unsigned int id)
+    {
+        if (id >= m_objects.size() || !m_objects[id].inserted)
+            return;
+        Object& object = m_objects[id];
+        removeFromCells(id, object.minCell, object.maxCell);
+        object.inserted = false;
+        --m_count;
+    }
+
+    // empties every cell but keeps their storage around for the next frame
+    void clear()
+    {
+        for (auto& cell : m_cells)
+            cell.second.clear();
+        for (Object& object : m_objects)
+            object.inserted = false;
+        m_count = 0;
+        m_usedMin = Cell(KEY_BIAS);
+        m_usedMax = Cell(-KEY_BIAS);
+    }
+
+    // bulk rebuild: ids are the positions in 'boxes'
+    void rebuild(const Box* boxes, unsigned int count)
+    {
+        clear();
+        for (unsigned int i = 0; i < count; ++i)
+            insert(i, boxes[i]);
+    }
+
+    const Box& getBox(unsigned int id) const { return m_objects[id].box; }
+
+    template<typename Callback>
+    void queryBox(const Box& box, Callback&& callback) const
+    {
+        forEachCandidate(toCell(box.min), toCell(box.max), [&](unsigned int id)
+            {
+                if (spatialBoxesOverlap(m_objects[id].box, box))
+                    callback(id);
+            });
+    }
+
+    template<typename Callback>
+    void querySphere(const Vec& center, float radius, Callback&& callback) const
+    {
+        forEachCandidate(toCell(center - Vec(radius)), toCell(center + Vec(radius)), [&](unsigned int id)
+            {
+                if (spatialBoxOverlapsSphere(m_objects[id].box, center, radius))
+                    callback(id);
+            });
+    }
+
+    // walks the cells pierced by the ray (Amanatides & Woo) up to 'maxDistance', which may be infinite;
+    // 'direction' must be normalized. The walk is clipped to the cells that held objects since the last
+    // clear, so empty space around them costs nothing.
+    template<typename Callback>
+    void queryRay(const Vec& origin, const Vec& direction, float maxDistance, Callback&& callback) const
+    {
+        const Vec invDirection = Vec(1.0f) / direction;
+        float t = 0.0f, tEnd = maxDistance;
+        for (int i = 0; i < D; ++i)
+            if (m_usedMin[i] > m_usedMax[i])
+                return;
+        const Box used(Vec(m_usedMin) * m_cellSize, Vec(m_usedMax + Cell(1)) * m_cellSize);
+        if (!spatialClipRay(used, origin, invDirection, t, tEnd))
+            return;
+
+        const unsigned int stamp = nextStamp();
+        Cell cell = glm::clamp(toCell(origin + direction * t), m_usedMin, m_usedMax);
+        Cell step;
+        Vec tMax, tDelta;
+        for (int i = 0; i < D; ++i)
+        {
+            step[i] = direction[i] > 0.0f ? 1 : (direction[i] < 0.0f ? -1 : 0);
+            const float boundary = (cell[i] + (step[i] > 0 ? 1 : 0)) * m_cellSize;
+            tMax[i] = step[i] != 0 ? (boundary - origin[i]) * invDirection[i] : std::numeric_limits<float>::infinity();
+            tDelta[i] = step[i] != 0 ? m_cellSize * std::abs(invDirection[i]) : std::numeric_limits<float>::infinity();
+        }
+
+        while (t <= tEnd)
+        {
+            visitCell(cell, stamp, [&](unsigned int id)
+                {
+                    if (spatialBoxOverlapsRay(m_objects[id].box, origin, invDirection, maxDistance))
+                        callback(id);
+                });
+            int axis = 0;
+            for (int i = 1; i < D; ++i)
+                if (tMax[i] < tMax[axis])
+                    axis = i;
+            if (step[axis] == 0)
+                break;
+            t = tMax[axis];
+            cell[axis] += step[axis];
+            tMax[axis] += tDelta[axis];
+            // moving away along this axis, the ray never comes back into the used range
+            if (cell[axis] < m_usedMin[axis] || cell[axis] > m_usedMax[axis])
+                break;
+        }
+    }
+
+    // only cells that are occupied are tested, so this is proportional to the number of non-empty cells.
+    // Cells are culled individually, which can reject a few boxes the conservative per-box test would accept.
+    template<typename Callback, int Dim = D>
+    typename std::enable_if<Dim == 3>::type queryFrustum(const glm::vec4 planes[6], Callback&& callback) const
+    {
+        const unsigned int stamp = nextStamp();
+        for (const auto& cell : m_cells)
+        {
+            if (cell.second.empty())
+                continue;
+            const Cell coord = decodeKey(cell.first);
+            const Box cellBox(Vec(coord) * m_cellSize, Vec(coord + Cell(1)) * m_cellSize);
+            if (!spatialBoxOverlapsFrustum(cellBox, planes))
+                continue;
+            for (unsigned int id : cell.second)
+            {
+                if (m_stamps[id] == stamp)
+                    continue;
+                m_stamps[id] = stamp;
+                if (spatialBoxOverlapsFrustum(m_objects[id].box, planes))
+                    callback(id);
+            }
+        }
+    }
+
+private:
+    struct Object
+    {
+        Box box;
+        Cell minCell, maxCell;
+        bool inserted = false;
+    };
+
+    // 21 bits per axis, biased so negative coordinates pack too
+    static const int KEY_BITS = 21;
+    static const int KEY_BIAS = 1 << (KEY_BITS - 1);
+
+    float m_cellSize, m_invCellSize;
+    std::unordered_map<std::uint64_t, std::vector<unsigned int>> m_cells;
+    std::vector<Object> m_objects;
+    mutable std::vector<unsigned int> m_stamps;
+    mutable unsigned int m_stamp = 0;
+    std::size_t m_count = 0;
+    // range of cells objects were added to since the last clear (empty while min > max); bounds ray walks
+    Cell m_usedMin = Cell(KEY_BIAS), m_usedMax = Cell(-KEY_BIAS);
+
+    Cell toCell(const Vec& p) const
+    {
+        Cell cell;
+        for (int i = 0; i < D; ++i)
+        {
+            // clamped to the key range first: NaN or huge coordinates don't convert to int
+            const float c = std::floor(p[i] * m_invCellSize);
+            cell[i] = c > -KEY_BIAS ? (c < KEY_BIAS - 1 ? static_cast<int>(c) : KEY_BIAS - 1) : -KEY_BIAS;
+        }
+        return cell;
+    }
+
+    static std::uint64_t encodeKey(const Cell& cell)
+    {
+        std::uint64_t key = 0;
+        for (int i = 0; i < D; ++i)
+            key |= static_cast<std::uint64_t>((cell[i] + KEY_BIAS) & ((1 << KEY_BITS) - 1)) << (i * KEY_BITS);
+        return key;
+    }
+
+    static Cell decodeKey(std::uint64_t key)
+    {
+        Cell cell;
+        for (int i = 0; i < D; ++i)
+            cell[i] = static_cast<int>((key >> (i * KEY_BITS)) & ((1 << KEY_BITS) - 1)) - KEY_BIAS;
+        return cell;
+    }
+
+    unsigned int nextStamp() const
+    {
+        // on wrap around old stamps could alias the new one, reset them all
+        if (++m_stamp == 0)
+        {
+            std::fill(m_stamps.begin(), m_stamps.end(), 0);
+            m_stamp = 1;
+        }
+        return m_stamp;
+    }
+
+    template<typename Function>
+    static void forEachCell(const Cell& minCell, const Cell& maxCell, Function&& function)
+    {
+        Cell cell = minCell;
+        while (true)
+        {
+            function(cell);
+            int axis = 0;
+            while (axis < D && ++cell[axis] > maxCell[axis])
+            {
+                cell[axis] = minCell[axis];
+                ++axis;
+            }
+            if (axis == D)
+                break;
+        }
+    }
+
+    void addToCells(unsigned int id, const Cell& minCell, const Cell& maxCell)
+    {
+        m_usedMin = glm::min(m_usedMin, minCell);
+        m_usedMax = glm::max(m_usedMax, maxCell);
+        forEachCell(minCell, maxCell, [&](const Cell& cell) { m_cells[encodeKey(cell)].push_back(id); });
+    }
+
+    void removeFromCells(unsigned int id, const Cell& minCell, const Cell& maxCell)
+    {
+        forEachCell(minCell, maxCell, [&](const Cell& cell)
+            {
+                auto found = m_cells.find(encodeKey(cell));
+                if (found == m_cells.end())
+                    return;
+                std::vector<unsigned int>& ids = found->second;
+                auto it = std::find(ids.begin(), ids.end(), id);
+                if (it != ids.end())
+                {
+                    *it = ids.back();
+                    ids.pop_back();
+                }
+            });
+    }
+
+    template<typename Function>
+    void visitCell(const Cell& cell, unsigned int stamp, Function&& function) const
+    {
+        auto found = m_cells.find(encodeKey(cell));
+        if (found == m_cells.end())
+            return;
+        for (unsigned int id : found->second)
+        {
+            if (m_stamps[id] == stamp)
+                continue;
+            m_stamps[id] = stamp;
+            function(id);
+        }
+    }
+
+    template<typename Function>
+    void forEachCandidate(const Cell& minCell, const Cell& maxCell, Function&& function) const
+    {
+        const unsigned int stamp = nextStamp();
+        forEachCell(minCell, maxCell, [&](const Cell& cell) { visitCell(cell, stamp, function); });
+    }
+};
+
+class LooseOctree
+{
+public:
+    typedef SpatialBox<3> Box;
+
+    static const int MAX_DEPTH = 12;
+
+    // 'worldBounds' should enclose the scene; objects outside it still work but end up near the root
+    LooseOctree(const Box& worldBounds = Box(glm::vec3(-1.0f), glm::vec3(1.0f)), int maxDepth = 8)
+        : m_maxDepth(std::min(maxDepth, MAX_DEPTH))
+    {
+        setWorldBounds(worldBounds);
+    }
+
+    // resets the tree; the world is made cubic around the given box
+    void setWorldBounds(const Box& worldBounds)
+    {
+        const glm::vec3 size = worldBounds.max - worldBounds.min;
+        m_worldHalfSize = std::max(std::max(size.x, size.y), size.z) * 0.5f;
+        m_worldCenter = (worldBounds.min + worldBounds.max) * 0.5f;
+        clear();
+    }
+
+    std::size_t size() const { return m_count; }
+    // nodes in use; empty leaves are freed as objects leave them
+    std::size_t nodeCount() const { return m_nodes.size() - m_freeNodes.size(); }
+
+    void clear()
+    {
+        m_nodes.resize(1);
+        m_freeNodes.clear();
+        m_nodes[0] = Node();
+        m_nodes[0].center = m_worldCenter;
+        m_nodes[0].halfSize = m_worldHalfSize;
+        for (Object& object : m_objects)
+            object.node = -1;
+        m_count = 0;
+    }
+
+    void insert(unsigned int id, const Box& box)
+    {
+        if (id >= m_objects.size())
+            m_objects.resize(id + 1);
+        if (m_objects[id].node >= 0)
+        {
+            update(id, box);
+            return;
+        }
+        m_objects[id].box = box;
+        link(id, findNode(box));
+        ++m_count;
+    }
+
+    // objects that stay inside their node's loose bounds at an appropriate depth are not moved
+    void update(unsigned int id, const Box& box)
+    {
+        if (id >= m_objects.size() || m_objects[id].node < 0)
+        {
+            insert(id, box);
+            return;
+        }
+        Object& object = m_objects[id];
+        object.box = box;
+        const int target = findNode(box);
+        if (target == object.node)
+            return;
+        // link first: pruning the old node must not free the target, which may be its empty parent
+        const int node = object.node;
+        const unsigned int slot = object.slot;
+        link(id, target);
+        detach(id, node, slot);
+        prune(node);
+    }
+
+    void remove(unsigned int id)
+    {
+        if (id >= m_objects.size() || m_objects[id].node < 0)
+            return;
+        const int node = m_objects[id].node;
+        detach(id, node, m_objects[id].slot);
+        m_objects[id].node = -1;
+        prune(node);
+        --m_count;
+    }
+
+    // bulk rebuild: ids are the positions in 'boxes'
+    void rebuild(const Box* boxes, unsigned int count)
+    {
+        clear();
+        for (unsigned int i = 0; i < count; ++i)
+            insert(i, boxes[i]);
+    }
+
+    const Box& getBox(unsigned int id) const { return m_objects[id].box; }
+
+    template<typename Callback>
+    void queryBox(const Box& box, Callback&& callback) const
+    {
+        traverse([&](const Box& loose) { return spatialBoxesOverlap(loose, box); },
+            [&](unsigned int id) { if (spatialBoxesOverlap(m_objects[id].box, box)) callback(id); });
+    }
+
+    template<typename Callback>
+    void querySphere(const glm::vec3& center, float radius, Callback&& callback) const
+    {
+        traverse([&](const Box& loose) { return spatialBoxOverlapsSphere(loose, center, radius); },
+            [&](unsigned int id) { if (spatialBoxOverlapsSphere(m_objects[id].box, center, radius)) callback(id); });
+    }
+
+    // 'direction' must be normalized
+    template<typename Callback>
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback&& callback) const
+    {
+        const glm::vec3 invDirection = glm::vec3(1.0f) / direction;
+        traverse([&](const Box& loose) { return spatialBoxOverlapsRay(loose, origin, invDirection, maxDistance); },
+            [&](unsigned int id) { if (spatialBoxOverlapsRay(m_objects[id].box, origin, invDirection, maxDistance)) callback(id); });
+    }
+
+    template<typename Callback>
+    void queryFrustum(const glm::vec4 planes[6], Callback&& callback) const
+    {
+        traverse([&](const Box& loose) { return spatialBoxOverlapsFrustum(loose, planes); },
+            [&](unsigned int id) { if (spatialBoxOverlapsFrustum(m_objects[id].box, planes)) callback(id); });
+    }
+
+private:
+    struct Node
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        float halfSize = 1.0f;         // tight half size; loose bounds are twice as large
+        int children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+        int parent = -1;
+        int depth = 0;
+        std::vector<unsigned int> objects;
+    };
+
+    struct Object
+    {
+        Box box;
+        int node = -1;
+        unsigned int slot = 0;          // position in the node's object list
+    };
+
+    int m_maxDepth;
+    glm::vec3 m_worldCenter = glm::vec3(0.0f);
+    float m_worldHalfSize = 1.0f;
+    std::vector<Node> m_nodes;
+    // slots of pruned nodes, reused before the node array grows
+    std::vector<int> m_freeNodes;
+    std::vector<Object> m_objects;
+    std::size_t m_count = 0;
+
+    // the deepest node whose tight cell contains the box center and whose loose bounds contain the whole box
+    int findNode(const Box& box)
+    {
+        const glm::vec3 center = (box.min + box.max) * 0.5f;
+        const glm::vec3 halfExtent = (box.max - box.min) * 0.5f;
+        const float radius = std::max(std::max(halfExtent.x, halfExtent.y), halfExtent.z);
+
+        int index = 0;
+        while (m_nodes[index].depth < m_maxDepth)
+        {
+            const float childHalfSize = m_nodes[index].halfSize * 0.5f;
+            // a loose child extends childHalfSize beyond its tight cell, which bounds how big the object may be
+            if (radius > childHalfSize)
+                break;
+            const glm::vec3 nodeCenter = m_nodes[index].center;
+            const int octant = (center.x >= nodeCenter.x ? 1 : 0) | (center.y >= nodeCenter.y ? 2 : 0) | (center.z >= nodeCenter.z ? 4 : 0);
+            // centers outside the world stay in the root
+            if (index == 0 && glm::any(glm::greaterThan(glm::abs(center - nodeCenter), glm::vec3(m_nodes[0].halfSize))))
+                break;
+            int child = m_nodes[index].children[octant];
+            if (child < 0)
+            {
+                Node node;
+                node.halfSize = childHalfSize;
+                node.center = nodeCenter + glm::vec3((octant & 1) ? childHalfSize : -childHalfSize,
+                    (octant & 2) ? childHalfSize : -childHalfSize, (octant & 4) ? childHalfSize : -childHalfSize);
+                node.parent = index;
+                node.depth = m_nodes[index].depth + 1;
+                if (m_freeNodes.empty())
+                {
+                    child = static_cast<int>(m_nodes.size());
+                    m_nodes.push_back(std::move(node));
+                }
+                else
+                {
+                    child = m_freeNodes.back();
+                    m_freeNodes.pop_back();
+                    m_nodes[child] = std::move(node);
+                }
+                m_nodes[index].children[octant] = child;
+            }
+            index = child;
+        }
+        return index;
+    }
+
+    void link(unsigned int id, int node)
+    {
+        Object& object = m_objects[id];
+        object.node = node;
+        object.slot = static_cast<unsigned int>(m_nodes[node].objects.size());
+        m_nodes[node].objects.push_back(id);
+    }
+
+    // takes the object out of a node's list, moving the last one into its slot
+    void detach(unsigned int id, int node, unsigned int slot)
+    {
+        std::vector<unsigned int>& objects = m_nodes[node].objects;
+        const unsigned int moved = objects.back();
+        objects[slot] = moved;
+        if (moved != id)
+            m_objects[moved].slot = slot;
+        objects.pop_back();
+    }
+
+    // frees the node if it is an empty leaf, then its parent if that became one; the root stays
+    void prune(int index)
+    {
+        while (index > 0 && m_nodes[index].objects.empty() &&
+            std::all_of(m_nodes[index].children, m_nodes[index].children + 8, [](int child) { return child < 0; }))
+        {
+            const int parent = m_nodes[index].parent;
+            std::replace(m_nodes[parent].children, m_nodes[parent].children + 8, index, -1);
+            m_nodes[index] = Node();
+            m_freeNodes.push_back(index);
+            index = parent;
+        }
+    }
+
+    Box looseBounds(const Node& node) const
+    {
+        const glm::vec3 looseHalf(node.halfSize * 2.0f);
+        // the root also holds everything that fell outside the world
+        if (&node == &m_nodes[0])
+            return Box(glm::vec3(-std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::max()));
+        return Box(node.center - looseHalf, node.center + looseHalf);
+    }
+
+    template<typename NodeTest, typename ObjectVisitor>
+    void traverse(NodeTest&& nodeTest, ObjectVisitor&& visitor) const
+    {
+        // depth first with a fixed stack: at most 7 pending siblings per level plus the current node
+        int stack[8 * (MAX_DEPTH + 1)];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node& node = m_nodes[stack[--top]];
+            if (!nodeTest(looseBounds(node)))
+                continue;
+            for (unsigned int id : node.objects)
+                visitor(id);
+            for (int i = 0; i < 8; ++i)
+                if (node.children[i] >= 0)
+                    stack[top++] = node.children[i];
+        }
+    }
+};
+#endif
@@ -0,0 +1,9 @@
+#version 430 core
+out vec4 FragColor;
+
+flat in vec3 lightColor;
+
+void main()
+{
+    FragColor = vec4(lightColor, 1.0);
+}
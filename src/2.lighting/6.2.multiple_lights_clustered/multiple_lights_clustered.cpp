@@ -0,0 +1,526 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/light_clusters.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+unsigned int loadTexture(const char *path);
+std::vector<PointLight> generateLights(unsigned int count);
+int runClusterBenchmark(unsigned int lightCount);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 12.0f));
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// lighting
+const unsigned int MAX_LIGHTS = 16384;
+unsigned int lightCount = 1024;
+// shade with the lights of each fragment's cluster (C toggles), or with every light
+bool clusteredShading = true;
+
+int main(int argc, char *argv[])
+{
+    // --cluster-benchmark [lights]: time the CPU light assignment without opening a window
+    if (argc > 1 && std::strcmp(argv[1], "--cluster-benchmark") == 0)
+        return runClusterBenchmark(argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 10000);
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    Shader lightingShader("6.2.multiple_lights.vs", "6.2.multiple_lights.fs");
+    Shader lightCubeShader("6.2.light_cube.vs", "6.2.light_cube.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+        // positions          // normals           // texture coords
+        -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+         0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+         0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+         0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+        -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+        -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+        -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+         0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+         0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+         0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+        -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+        -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+        -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+        -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+        -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+        -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+         0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+         0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+         0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+         0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+         0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+         0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+        -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+         0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+         0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+        -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+        -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+        -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+         0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+         0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+         0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+        -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+        -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+    };
+    // positions all containers
+    glm::vec3 cubePositions[] = {
+        glm::vec3( 0.0f,  0.0f,  0.0f),
+        glm::vec3( 2.0f,  5.0f, -15.0f),
+        glm::vec3(-1.5f, -2.2f, -2.5f),
+        glm::vec3(-3.8f, -2.0f, -12.3f),
+        glm::vec3( 2.4f, -0.4f, -3.5f),
+        glm::vec3(-1.7f,  3.0f, -7.5f),
+        glm::vec3( 1.3f, -2.0f, -2.5f),
+        glm::vec3( 1.5f,  2.0f, -2.5f),
+        glm::vec3( 1.5f,  0.2f, -1.5f),
+        glm::vec3(-1.3f,  1.0f, -1.5f)
+    };
+    // first, configure the cube's VAO (and VBO)
+    unsigned int VBO, cubeVAO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &VBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindVertexArray(cubeVAO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // second, configure the light's VAO (VBO stays the same; the vertices are the same for the light object which is also a 3D cube)
+    unsigned int lightCubeVAO;
+    glGenVertexArrays(1, &lightCubeVAO);
+    glBindVertexArray(lightCubeVAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // load textures (we now use a utility function to keep the code more organized)
+    // -----------------------------------------------------------------------------
+    unsigned int diffuseMap = loadTexture(FileSystem::getPath("resources/textures/container2.png").c_str());
+    unsigned int specularMap = loadTexture(FileSystem::getPath("resources/textures/container2_specular.png").c_str());
+
+    // point lights, scattered over a floor of containers
+    // --------------------------------------------------
+    std::vector<PointLight> lights = generateLights(MAX_LIGHTS);
+    std::vector<glm::vec3> lightBasePositions(MAX_LIGHTS);
+    for (unsigned int i = 0; i < MAX_LIGHTS; i++)
+        lightBasePositions[i] = lights[i].position;
+
+    // light clusters: 16x9 tiles, 24 depth slices
+    // -------------------------------------------
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+    LightClusters clusters;
+    clusters.setup(projection);
+    // the lights, the (offset, count) range of every cluster and the light indices the ranges point into
+    unsigned int lightBuffer, clusterRangeBuffer, clusterIndexBuffer;
+    glGenBuffers(1, &lightBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, MAX_LIGHTS * sizeof(PointLight), lights.data(), GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &clusterRangeBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterRangeBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, clusters.clusterCount() * sizeof(glm::uvec2), NULL, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &clusterIndexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, clusterRangeBuffer);
+    float assignTime = 0.0f;
+    unsigned int assignFrames = 0;
+    float lastTitleUpdate = 0.0f;
+
+    // shader configuration
+    // --------------------
+    lightingShader.use();
+    lightingShader.setInt("material.diffuse", 0);
+    lightingShader.setInt("material.specular", 1);
+    // how clustered_lights.glsl finds a fragment's cluster
+    glUniform3ui(glGetUniformLocation(lightingShader.ID, "clusterGridSize"), clusters.gridSize.x, clusters.gridSize.y, clusters.gridSize.z);
+    lightingShader.setVec2("clusterTileSize", (float)SCR_WIDTH / clusters.gridSize.x, (float)SCR_HEIGHT / clusters.gridSize.y);
+    lightingShader.setVec2("clusterDepthRange", clusters.zNear, clusters.zFar);
+    lightingShader.setVec2("clusterSliceScaleBias", clusters.sliceScaleBias());
+    lightingShader.setMat4("projection", projection);
+    lightCubeShader.use();
+    lightCubeShader.setMat4("projection", projection);
+    lightCubeShader.setFloat("cubeSize", 0.05f);
+
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // move the lights up and down a little, upload them and sort them into clusters
+        // -------------------------------------------------------------------------------
+        for (unsigned int i = 0; i < lightCount; i++)
+            lights[i].position.y = lightBasePositions[i].y + 0.25f * std::sin(currentFrame + static_cast<float>(i));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lightCount * sizeof(PointLight), lights.data());
+        glm::mat4 view = camera.GetViewMatrix();
+        if (clusteredShading)
+        {
+            auto assignStart = std::chrono::steady_clock::now();
+            clusters.assign(lights.data(), lightCount, view);
+            assignTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - assignStart).count();
+            assignFrames++;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterRangeBuffer);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, clusters.clusterRanges.size() * sizeof(glm::uvec2), clusters.clusterRanges.data());
+            // the index list changes size every frame; orphan the old storage (never empty, binding a zero sized buffer fails)
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterIndexBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(clusters.lightIndices.size(), 1) * sizeof(unsigned int), clusters.lightIndices.data(), GL_STREAM_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, clusterIndexBuffer);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // be sure to activate shader when setting uniforms/drawing objects
+        lightingShader.use();
+        lightingShader.setVec3("viewPos", camera.Position);
+        lightingShader.setFloat("material.shininess", 32.0f);
+        lightingShader.setBool("clustered", clusteredShading);
+        glUniform1ui(glGetUniformLocation(lightingShader.ID, "lightCount"), lightCount);
+
+        // directional light
+        lightingShader.setVec3("dirLight.direction", -0.2f, -1.0f, -0.3f);
+        lightingShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.05f);
+        lightingShader.setVec3("dirLight.diffuse", 0.1f, 0.1f, 0.1f);
+        lightingShader.setVec3("dirLight.specular", 0.2f, 0.2f, 0.2f);
+        // point lights: all in the light buffer
+        // spotLight
+        lightingShader.setVec3("spotLight.position", camera.Position);
+        lightingShader.setVec3("spotLight.direction", camera.Front);
+        lightingShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
+        lightingShader.setVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+        lightingShader.setVec3("spotLight.specular", 1.0f, 1.0f, 1.0f);
+        lightingShader.setFloat("spotLight.constant", 1.0f);
+        lightingShader.setFloat("spotLight.linear", 0.09f);
+        lightingShader.setFloat("spotLight.quadratic", 0.032f);
+        lightingShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
+        lightingShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(15.0f)));     
+
+        // view transformation
+        lightingShader.setMat4("view", view);
+
+        // bind diffuse map
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, diffuseMap);
+        // bind specular map
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, specularMap);
+
+        // render containers: a floor of them and the usual ten floating ones
+        glBindVertexArray(cubeVAO);
+        for (int z = -10; z <= 10; z++)
+        {
+            for (int x = -10; x <= 10; x++)
+            {
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::translate(model, glm::vec3((float)x, -1.5f, (float)z));
+                lightingShader.setMat4("model", model);
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
+        }
+        for (unsigned int i = 0; i < 10; i++)
+        {
+            // calculate the model matrix for each object and pass it to shader before drawing
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, cubePositions[i]);
+            float angle = 20.0f * i;
+            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+            lightingShader.setMat4("model", model);
+
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+        }
+
+         // also draw the lamp objects, one instance per light
+         lightCubeShader.use();
+         lightCubeShader.setMat4("view", view);
+         glBindVertexArray(lightCubeVAO);
+         glDrawArraysInstanced(GL_TRIANGLES, 0, 36, lightCount);
+
+        // show the assignment cost about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f)
+        {
+            std::string title = "LearnOpenGL - " + std::to_string(lightCount) + " lights, " + (clusteredShading ?
+                "clustered, assignment " + std::to_string(assignFrames > 0 ? assignTime / assignFrames : 0.0f) + " ms" : std::string("all lights per fragment"));
+            glfwSetWindowTitle(window, title.c_str());
+            assignTime = 0.0f;
+            assignFrames = 0;
+            lastTitleUpdate = currentFrame;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &lightCubeVAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &clusterRangeBuffer);
+    glDeleteBuffers(1, &clusterIndexBuffer);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// random point lights above the floor of containers, with a steep attenuation so that each one only lights a small area
+// ----------------------------------------------------------------------------------------------------------------------
+std::vector<PointLight> generateLights(unsigned int count)
+{
+    std::vector<PointLight> lights(count);
+    srand(13);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        lights[i].position = glm::vec3(((rand() % 1000) / 1000.0f) * 21.0f - 10.5f, ((rand() % 1000) / 1000.0f) * 2.5f - 0.9f, ((rand() % 1000) / 1000.0f) * 21.0f - 10.5f);
+        lights[i].color = glm::vec3((rand() % 100) / 200.0f + 0.5f, (rand() % 100) / 200.0f + 0.5f, (rand() % 100) / 200.0f + 0.5f);
+        lights[i].linear = 1.4f;
+        lights[i].quadratic = 20.0f;
+        lights[i].radius = lightVolumeRadius(lights[i].color, lights[i].linear, lights[i].quadratic);
+    }
+    return lights;
+}
+
+// headless benchmark of the CPU light assignment: the demo's camera and light layout, single threaded and on all hardware threads
+// -------------------------------------------------------------------------------------------------------------------------------
+int runClusterBenchmark(unsigned int lightCount)
+{
+    std::vector<PointLight> lights = generateLights(lightCount);
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+    const glm::mat4 view = camera.GetViewMatrix();
+    LightClusters single, threaded;
+    single.setup(projection);
+    threaded.setup(projection);
+    const unsigned int frames = 100;
+    for (unsigned int threads : { 1u, 0u })
+    {
+        LightClusters& clusters = threads == 1 ? single : threaded;
+        clusters.assign(lights.data(), lightCount, view, threads); // warm up the scratch buffers
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int frame = 0; frame < frames; frame++)
+            clusters.assign(lights.data(), lightCount, view, threads);
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        std::cout << lightCount << " lights, " << (threads == 1 ? 1 : std::max(std::thread::hardware_concurrency(), 1u)) << " thread(s): "
+            << ms << " ms per assignment, " << clusters.lightIndices.size() << " light references in " << clusters.clusterCount() << " clusters" << std::endl;
+    }
+    const bool same = single.clusterRanges == threaded.clusterRanges && single.lightIndices == threaded.lightIndices;
+    std::cout << "single and multithreaded assignment " << (same ? "match" : "DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // C: toggle between clustered shading and looping over every light
+    static int cPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE && cPress == GLFW_PRESS)
+        clusteredShading = !clusteredShading;
+    cPress = glfwGetKey(window, GLFW_KEY_C);
+
+    // +/-: double or halve the number of lights
+    static int plusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_RELEASE && plusPress == GLFW_PRESS && lightCount < MAX_LIGHTS)
+        lightCount *= 2;
+    plusPress = glfwGetKey(window, GLFW_KEY_KP_ADD);
+    static int minusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_RELEASE && minusPress == GLFW_PRESS && lightCount > 64)
+        lightCount /= 2;
+    minusPress = glfwGetKey(window, GLFW_KEY_KP_SUBTRACT);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+unsigned int loadTexture(char const * path)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        GLenum format;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+        else if (nrComponents == 4)
+            format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
@@ -0,0 +1,26 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+
+// all instance matrices, uploaded once
+layout (std430, binding = 0) readonly buffer InstanceMatrices
+{
+    mat4 instanceMatrices[];
+};
+// indices of the instances that survived culling this frame, written by the compute pass
+layout (std430, binding = 1) readonly buffer VisibleInstances
+{
+    uint visibleInstances[];
+};
+
+out vec2 TexCoords;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    mat4 instanceMatrix = instanceMatrices[visibleInstances[gl_InstanceID]];
+    gl_Position = projection * view * instanceMatrix * vec4(aPos, 1.0f); 
+}
@@ -0,0 +1,54 @@
+#version 430 core
+layout (local_size_x = 64) in;
+
+struct DrawElementsIndirectCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    uint baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer InstanceMatrices
+{
+    mat4 instanceMatrices[];
+};
+layout (std430, binding = 1) writeonly buffer VisibleInstances
+{
+    uint visibleInstances[];
+};
+// one command per mesh of the model; all of them draw the same compacted instance list
+layout (std430, binding = 2) buffer DrawCommands
+{
+    DrawElementsIndirectCommand commands[];
+};
+
+uniform vec4 frustumPlanes[6]; // inward facing, normalized (see extractFrustumPlanes)
+uniform vec4 boundingSphere;   // mesh space: xyz center, w radius
+uniform uint instanceCount;
+uniform uint commandCount;
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= instanceCount)
+        return;
+
+    // same math as transformBoundingSphere/isSphereInFrustum in instance_culling.h
+    mat4 model = instanceMatrices[id];
+    vec3 center = (model * vec4(boundingSphere.xyz, 1.0)).xyz;
+    float maxScale = sqrt(max(max(dot(model[0].xyz, model[0].xyz), dot(model[1].xyz, model[1].xyz)), dot(model[2].xyz, model[2].xyz)));
+    float radius = boundingSphere.w * maxScale;
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+            return;
+    }
+
+    // compact: reserve a slot in the visible list and bump the instance count of every mesh's command
+    uint slot = atomicAdd(commands[0].instanceCount, 1u);
+    visibleInstances[slot] = id;
+    for (uint i = 1u; i < commandCount; ++i)
+        atomicAdd(commands[i].instanceCount, 1u);
+}
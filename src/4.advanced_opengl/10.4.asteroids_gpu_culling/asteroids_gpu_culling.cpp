@@ -0,0 +1,488 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/instance_culling.h>
+#include <learnopengl/spatial_index.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+void generateAsteroids(glm::mat4* modelMatrices, unsigned int amount);
+int runSpatialBenchmark(unsigned int maxAmount);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 155.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// compare the GPU visible list against the CPU reference on the next frame
+bool verifyCulling = false;
+bool verifyKeyPressed = false;
+
+int main(int argc, char *argv[])
+{
+    // --spatial-benchmark [asteroids]: time the spatial indices against brute force without opening a window
+    if (argc > 1 && std::strcmp(argv[1], "--spatial-benchmark") == 0)
+        return runSpatialBenchmark(argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 1000000);
+
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader asteroidShader("10.4.asteroids.vs", "10.4.asteroids.fs");
+    Shader planetShader("10.4.planet.vs", "10.4.planet.fs");
+    ComputeShader cullingShader("10.4.asteroids_culling.cs");
+
+    // load models
+    // -----------
+    Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"));
+    Model planet(FileSystem::getPath("resources/objects/planet/planet.obj"));
+
+    // generate a large list of semi-random model transformation matrices
+    // ------------------------------------------------------------------
+    unsigned int amount = 100000;
+    glm::mat4* modelMatrices;
+    modelMatrices = new glm::mat4[amount];
+    srand(static_cast<unsigned int>(glfwGetTime())); // initialize random seed
+    generateAsteroids(modelMatrices, amount);
+
+    // configure instance/culling buffers
+    // ----------------------------------
+    // all instance matrices live in an SSBO; the vertex shader fetches them through the visible list
+    unsigned int instanceBuffer;
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    // compacted indices of the instances that pass the frustum test (worst case: all of them)
+    unsigned int visibleBuffer;
+    glGenBuffers(1, &visibleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, amount * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+    // one indirect command per mesh; instanceCount is reset every frame and filled in by the compute pass
+    std::vector<DrawElementsIndirectCommand> drawCommands(rock.meshes.size());
+    for (unsigned int i = 0; i < rock.meshes.size(); i++)
+        drawCommands[i] = { static_cast<unsigned int>(rock.meshes[i].indices.size()), 0, 0, 0, 0 };
+    unsigned int indirectBuffer;
+    glGenBuffers(1, &indirectBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCommands.size() * sizeof(DrawElementsIndirectCommand), drawCommands.data(), GL_DYNAMIC_COPY);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, indirectBuffer);
+
+    // the rock's bounds are cached at load time; every mesh draws the same instance list so cull against the whole model
+    const BoundingSphere rockSphere = rock.bounds.sphere;
+    std::vector<unsigned int> cpuVisible;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // configure transformation matrices
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        asteroidShader.use();
+        asteroidShader.setMat4("projection", projection);
+        asteroidShader.setMat4("view", view);
+        planetShader.use();
+        planetShader.setMat4("projection", projection);
+        planetShader.setMat4("view", view);
+        
+        // draw planet
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
+        model = glm::scale(model, glm::vec3(4.0f, 4.0f, 4.0f));
+        planetShader.setMat4("model", model);
+        planet.Draw(planetShader);
+
+        // cull meteorites on the GPU
+        glm::vec4 frustumPlanes[6];
+        extractFrustumPlanes(projection * view, frustumPlanes);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, drawCommands.size() * sizeof(DrawElementsIndirectCommand), drawCommands.data());
+        cullingShader.use();
+        cullingShader.setVec4Array("frustumPlanes", frustumPlanes, 6);
+        cullingShader.setVec4("boundingSphere", glm::vec4(rockSphere.center, rockSphere.radius));
+        cullingShader.setUInt("instanceCount", amount);
+        cullingShader.setUInt("commandCount", static_cast<unsigned int>(drawCommands.size()));
+        cullingShader.dispatch(amount, 64);
+        // make the visible list visible to the vertex shader and the counts visible to the indirect draw
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        // draw meteorites
+        asteroidShader.use();
+        asteroidShader.setInt("texture_diffuse1", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, rock.textures_loaded[0].id); // note: we also made the textures_loaded vector public (instead of private) from the model class.
+        for (unsigned int i = 0; i < rock.meshes.size(); i++)
+        {
+            glBindVertexArray(rock.meshes[i].VAO);
+            glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(i * sizeof(DrawElementsIndirectCommand)));
+            glBindVertexArray(0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        // on request: read the GPU result back and check it against the CPU reference
+        if (verifyCulling)
+        {
+            verifyCulling = false;
+            DrawElementsIndirectCommand gpuCommand;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, indirectBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(DrawElementsIndirectCommand), &gpuCommand);
+            std::vector<unsigned int> gpuVisible(gpuCommand.instanceCount);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+            if (!gpuVisible.empty())
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuVisible.size() * sizeof(unsigned int), gpuVisible.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            cullInstances(modelMatrices, amount, rockSphere, frustumPlanes, cpuVisible);
+            std::cout << "visible asteroids GPU: " << gpuVisible.size() << " / CPU: " << cpuVisible.size() << " / total: " << amount
+                << (sameVisibleSet(gpuVisible, cpuVisible) ? " (match)" : " (MISMATCH)") << std::endl;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &visibleBuffer);
+    glDeleteBuffers(1, &indirectBuffer);
+    delete[] modelMatrices;
+
+    glfwTerminate();
+    return 0;
+}
+
+// generate a large list of semi-random model transformation matrices, drawing from rand()
+// ------------------------------------------------------------------------------------------
+void generateAsteroids(glm::mat4* modelMatrices, unsigned int amount)
+{
+    float radius = 150.0;
+    float offset = 25.0f;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        glm::mat4 model = glm::mat4(1.0f);
+        // 1. translation: displace along circle with 'radius' in range [-offset, offset]
+        float angle = (float)i / (float)amount * 360.0f;
+        float displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float x = sin(angle) * radius + displacement;
+        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float y = displacement * 0.4f; // keep height of asteroid field smaller compared to width of x and z
+        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float z = cos(angle) * radius + displacement;
+        model = glm::translate(model, glm::vec3(x, y, z));
+
+        // 2. scale: Scale between 0.05 and 0.25f
+        float scale = static_cast<float>((rand() % 20) / 100.0 + 0.05);
+        model = glm::scale(model, glm::vec3(scale));
+
+        // 3. rotation: add random rotation around a (semi)randomly picked rotation axis vector
+        float rotAngle = static_cast<float>((rand() % 360));
+        model = glm::rotate(model, rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
+
+        // 4. now add to list of matrices
+        modelMatrices[i] = model;
+    }
+}
+
+// Reference for the spatial indices: tests every box.
+struct BruteForceIndex
+{
+    std::vector<SpatialBox<3>> boxes;
+
+    template<typename Callback>
+    void queryBox(const SpatialBox<3>& box, Callback&& callback) const
+    {
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            if (spatialBoxesOverlap(boxes[i], box))
+                callback(i);
+    }
+    template<typename Callback>
+    void querySphere(const glm::vec3& center, float radius, Callback&& callback) const
+    {
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            if (spatialBoxOverlapsSphere(boxes[i], center, radius))
+                callback(i);
+    }
+    template<typename Callback>
+    void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, Callback&& callback) const
+    {
+        const glm::vec3 invDirection = glm::vec3(1.0f) / direction;
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            if (spatialBoxOverlapsRay(boxes[i], origin, invDirection, maxDistance))
+                callback(i);
+    }
+    template<typename Callback>
+    void queryFrustum(const glm::vec4 planes[6], Callback&& callback) const
+    {
+        for (unsigned int i = 0; i < boxes.size(); i++)
+            if (spatialBoxOverlapsFrustum(boxes[i], planes))
+                callback(i);
+    }
+};
+
+// size of the sphere and box queries, and length of the rays
+const float QUERY_RADIUS = 5.0f;
+const float QUERY_RAY_LENGTH = 400.0f;
+const int QUERY_KIND_COUNT = 5;
+const char* QUERY_KINDS[QUERY_KIND_COUNT] = { "sphere", "box", "ray", "unbounded ray", "frustum" };
+
+// Runs every query kind once per point through 'index': a sphere and a box around the point, a ray
+// of QUERY_RAY_LENGTH, a ray without an end and a view frustum from the camera towards it. Counts the
+// hits and the milliseconds per query.
+template<typename Index>
+void timeSpatialQueries(const Index& index, const std::vector<glm::vec3>& points, const glm::mat4& projection, unsigned long long hits[QUERY_KIND_COUNT], float ms[QUERY_KIND_COUNT])
+{
+    for (int kind = 0; kind < QUERY_KIND_COUNT; kind++)
+    {
+        unsigned long long count = 0;
+        auto hit = [&count](unsigned int) { count++; };
+        auto start = std::chrono::steady_clock::now();
+        for (const glm::vec3& point : points)
+        {
+            if (kind == 0)
+                index.querySphere(point, QUERY_RADIUS, hit);
+            else if (kind == 1)
+                index.queryBox(SpatialBox<3>(point - glm::vec3(QUERY_RADIUS), point + glm::vec3(QUERY_RADIUS)), hit);
+            else if (kind == 2)
+                index.queryRay(camera.Position, glm::normalize(point - camera.Position), QUERY_RAY_LENGTH, hit);
+            else if (kind == 3)
+                index.queryRay(camera.Position, glm::normalize(point - camera.Position), std::numeric_limits<float>::infinity(), hit);
+            else
+            {
+                glm::vec4 planes[6];
+                extractFrustumPlanes(projection * glm::lookAt(camera.Position, point, glm::vec3(0.0f, 1.0f, 0.0f)), planes);
+                index.queryFrustum(planes, hit);
+            }
+        }
+        ms[kind] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / points.size();
+        hits[kind] = count;
+    }
+}
+
+// Builds a SpatialHash<3> and a LooseOctree over 1k, 10k, ... up to maxAmount asteroids and times
+// building them, moving a tenth of the asteroids, and the queries, against testing every asteroid.
+// The hits of every query kind have to match brute force.
+int runSpatialBenchmark(unsigned int maxAmount)
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+    auto time = [](const std::function<void()>& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    bool match = true;
+    for (unsigned int amount = 1000; amount <= maxAmount; amount *= 10)
+    {
+        std::vector<glm::mat4> modelMatrices(amount);
+        srand(1);
+        generateAsteroids(modelMatrices.data(), amount);
+        // the rock model isn't loaded without a window; a unit sphere stands in for its bounds
+        BruteForceIndex bruteForce;
+        bruteForce.boxes.resize(amount);
+        for (unsigned int i = 0; i < amount; i++)
+        {
+            const glm::vec4 sphere = transformBoundingSphere(modelMatrices[i], BoundingSphere{ glm::vec3(0.0f), 1.0f });
+            bruteForce.boxes[i] = SpatialBox<3>(glm::vec3(sphere) - sphere.w, glm::vec3(sphere) + sphere.w);
+        }
+        SpatialHash<3> hash(2.0f * QUERY_RADIUS);
+        LooseOctree octree(SpatialBox<3>(glm::vec3(-200.0f), glm::vec3(200.0f)));
+        const float hashBuild = time([&]() { hash.rebuild(bruteForce.boxes.data(), amount); });
+        const float octreeBuild = time([&]() { octree.rebuild(bruteForce.boxes.data(), amount); });
+        // a tenth of the asteroids drift a bit, as they would in a frame
+        for (unsigned int i = 0; i < amount; i += 10)
+        {
+            bruteForce.boxes[i].min += glm::vec3(0.5f, 0.0f, 0.25f);
+            bruteForce.boxes[i].max += glm::vec3(0.5f, 0.0f, 0.25f);
+        }
+        const float hashUpdate = time([&]() { for (unsigned int i = 0; i < amount; i += 10) hash.update(i, bruteForce.boxes[i]); });
+        const float octreeUpdate = time([&]() { for (unsigned int i = 0; i < amount; i += 10) octree.update(i, bruteForce.boxes[i]); });
+
+        // queries around asteroids; as many as keep brute force at about 10M box tests per kind
+        std::vector<glm::vec3> points(std::max(10u, std::min(1000u, 10000000u / amount)));
+        for (unsigned int i = 0; i < points.size(); i++)
+            points[i] = glm::vec3(modelMatrices[(i * 7919u) % amount][3]);
+        unsigned long long hits[3][QUERY_KIND_COUNT];
+        float ms[3][QUERY_KIND_COUNT];
+        timeSpatialQueries(bruteForce, points, projection, hits[0], ms[0]);
+        timeSpatialQueries(hash, points, projection, hits[1], ms[1]);
+        timeSpatialQueries(octree, points, projection, hits[2], ms[2]);
+
+        std::cout << amount << " asteroids, " << points.size() << " queries of each kind (ms per query, hits)" << std::endl;
+        const char* names[] = { "brute force", "hash       ", "octree     " };
+        const float build[] = { 0.0f, hashBuild, octreeBuild }, update[] = { 0.0f, hashUpdate, octreeUpdate };
+        for (int index = 0; index < 3; index++)
+        {
+            std::cout << "  " << names[index] << ": build " << build[index] << " ms, update " << update[index] << " ms";
+            for (int kind = 0; kind < QUERY_KIND_COUNT; kind++)
+            {
+                std::cout << ", " << QUERY_KINDS[kind] << " " << ms[index][kind] << " (" << hits[index][kind] << ")";
+                if (hits[index][kind] != hits[0][kind])
+                {
+                    std::cout << " MISMATCH";
+                    match = false;
+                }
+            }
+            std::cout << std::endl;
+        }
+        // removing every asteroid has to free all octree nodes but the root
+        const std::size_t nodes = octree.nodeCount();
+        for (unsigned int i = 0; i < amount; i++)
+            octree.remove(i);
+        std::cout << "  octree nodes: " << nodes << ", after removing all: " << octree.nodeCount() << std::endl;
+        match = match && octree.nodeCount() == 1;
+    }
+    std::cout << "spatial indices and brute force " << (match ? "match" : "DIFFER") << std::endl;
+    return match ? 0 : 1;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // V: verify the GPU culling result against the CPU reference
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !verifyKeyPressed)
+    {
+        verifyCulling = true;
+        verifyKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE)
+        verifyKeyPressed = false;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
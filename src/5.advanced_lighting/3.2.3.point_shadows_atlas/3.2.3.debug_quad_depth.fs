@@ -0,0 +1,12 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D depthMap;
+
+void main()
+{
+    // the atlas already stores linear distances
+    FragColor = vec4(vec3(texture(depthMap, TexCoords).r), 1.0);
+}
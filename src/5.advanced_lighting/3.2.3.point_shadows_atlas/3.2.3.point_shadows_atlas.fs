@@ -0,0 +1,100 @@
+#version 430 core
+out vec4 FragColor;
+
+in VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+} fs_in;
+
+// CosCutoff below -1 marks a point light; FirstView is the light's first entry in views, -1 when
+// it has no shadow map this frame
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float CosCutoff;
+    vec3 Direction;
+    int FirstView;
+};
+// a shadow map in the atlas: the matrix it was rendered with, its rectangle in atlas uv
+// (xy offset, z size) and the light position and far plane at the time (the light may have moved since)
+struct ShadowView {
+    mat4 ViewProjection;
+    vec4 Rect;
+    vec4 Origin;
+};
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    Light lights[];
+};
+layout (std430, binding = 1) readonly buffer ShadowViewBuffer {
+    ShadowView views[];
+};
+
+uniform sampler2D diffuseTexture;
+uniform sampler2D shadowAtlas;
+
+uniform int lightCount;
+uniform vec3 viewPos;
+uniform bool shadows;
+
+// cube face of a direction, in the order +X, -X, +Y, -Y, +Z, -Z
+int cubeFace(vec3 v)
+{
+    vec3 a = abs(v);
+    if (a.x >= a.y && a.x >= a.z)
+        return v.x > 0.0 ? 0 : 1;
+    if (a.y >= a.z)
+        return v.y > 0.0 ? 2 : 3;
+    return v.z > 0.0 ? 4 : 5;
+}
+
+float ShadowCalculation(Light light, vec3 fragPos)
+{
+    int face = light.CosCutoff < -1.0 ? cubeFace(fragPos - light.Position) : 0;
+    ShadowView shadowView = views[light.FirstView + face];
+    vec4 clip = shadowView.ViewProjection * vec4(fragPos, 1.0);
+    vec2 uv = clip.xy / clip.w * 0.5 + 0.5;
+    // stay half a texel inside the tile so filtering never reads a neighbour
+    vec2 halfTexel = 0.5 / vec2(textureSize(shadowAtlas, 0));
+    vec2 atlasUV = clamp(shadowView.Rect.xy + uv * shadowView.Rect.z, shadowView.Rect.xy + halfTexel, shadowView.Rect.xy + shadowView.Rect.z - halfTexel);
+    // the atlas stores the distance to the light divided by its far plane, like the cubemap of 3.2.1
+    float closestDepth = texture(shadowAtlas, atlasUV).r * shadowView.Origin.w;
+    float currentDepth = length(fragPos - shadowView.Origin.xyz);
+    float bias = 0.05;
+    return currentDepth - bias > closestDepth ? 1.0 : 0.0;
+}
+
+void main()
+{
+    vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    // ambient
+    vec3 lighting = 0.05 * color;
+    for (int i = 0; i < lightCount; ++i)
+    {
+        Light light = lights[i];
+        vec3 toLight = light.Position - fs_in.FragPos;
+        float distance = length(toLight);
+        if (distance > light.Radius)
+            continue;
+        vec3 lightDir = toLight / distance;
+        // falls off to zero at the light's radius, which is also its shadow far plane
+        float attenuation = clamp(1.0 - distance * distance / (light.Radius * light.Radius), 0.0, 1.0);
+        attenuation *= attenuation;
+        if (light.CosCutoff >= -1.0)
+            attenuation *= smoothstep(light.CosCutoff, light.CosCutoff + 0.05, dot(-lightDir, light.Direction));
+        if (attenuation <= 0.0)
+            continue;
+        // diffuse
+        float diff = max(dot(lightDir, normal), 0.0);
+        // specular
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+        // shadow
+        float shadow = shadows && light.FirstView >= 0 ? ShadowCalculation(light, fs_in.FragPos) : 0.0;
+        lighting += (1.0 - shadow) * attenuation * (diff * color + spec * 0.3) * light.Color;
+    }
+    FragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 430 core
+in vec3 FragPos;
+
+uniform vec3 lightPos;
+uniform float far_plane;
+
+void main()
+{
+    // linear distance to the light mapped to [0;1], for spot lights as well as cube faces
+    gl_FragDepth = length(FragPos - lightPos) / far_plane;
+}
@@ -0,0 +1,633 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/instance_culling.h>
+#include <learnopengl/shadow_atlas.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+unsigned int loadTexture(const char *path);
+void renderScene(const Shader &shader);
+void renderCube();
+void renderQuad();
+
+// settings
+const unsigned int SCR_WIDTH = 1280;
+const unsigned int SCR_HEIGHT = 720;
+bool shadows = true;
+bool shadowsKeyPressed = false;
+bool showAtlas = false;
+
+// camera
+Camera camera(glm::vec3(0.0f, -3.0f, 9.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// shadow atlas: one depth texture shared by the shadow maps of all lights
+const unsigned int ATLAS_SIZE = 4096;
+ShadowAtlas atlas(ATLAS_SIZE, 1024, 64, 24);
+// shadow views the atlas may render per frame (B cycles through them)
+const unsigned int faceBudgets[] = { 6, 24, 96, 1000 };
+unsigned int faceBudgetIndex = 1;
+
+// One light as stored in the light SSBO, laid out like the std430 struct Light of the lighting
+// shader. Point lights have a cosCutoff below -1.
+struct SceneLight
+{
+    glm::vec3 position;
+    float radius;    // attenuation range and shadow far plane
+    glm::vec3 color;
+    float cosCutoff; // spot lights: cosine of the cone's half angle
+    glm::vec3 direction;
+    int firstView;   // first entry in the shadow view SSBO, -1 without shadow
+};
+// One shadow map in the atlas as stored in the shadow view SSBO (std430 struct ShadowView)
+struct ShadowView
+{
+    glm::mat4 viewProjection;
+    glm::vec4 rect;   // xy offset and z size in atlas uv
+    glm::vec4 origin; // light position and far plane the map was rendered with
+};
+// what a light's tiles were last rendered with; a moving light keeps using it until its turn comes
+struct RenderedShadow
+{
+    glm::mat4 faces[6];
+    glm::vec4 origin;
+};
+
+std::vector<SceneLight> lights;
+std::vector<unsigned int> dynamicLights;
+std::vector<glm::mat4> cubeModels;
+
+// view-projection matrices of a light's shadow views: the six cube faces of a point light in the
+// order of 3.2.1's shadowTransforms, or the cone of a spot light
+void computeShadowViews(const SceneLight& light, RenderedShadow& shadow)
+{
+    const float nearPlane = 0.1f;
+    const glm::vec3& p = light.position;
+    if (light.cosCutoff < -1.0f)
+    {
+        const glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, light.radius);
+        shadow.faces[0] = shadowProj * glm::lookAt(p, p + glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+        shadow.faces[1] = shadowProj * glm::lookAt(p, p + glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+        shadow.faces[2] = shadowProj * glm::lookAt(p, p + glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f));
+        shadow.faces[3] = shadowProj * glm::lookAt(p, p + glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f));
+        shadow.faces[4] = shadowProj * glm::lookAt(p, p + glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+        shadow.faces[5] = shadowProj * glm::lookAt(p, p + glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f));
+    }
+    else
+    {
+        const glm::vec3 up = std::abs(light.direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        const float fov = 2.0f * std::acos(light.cosCutoff);
+        shadow.faces[0] = glm::perspective(fov, 1.0f, nearPlane, light.radius) * glm::lookAt(p, p + light.direction, up);
+    }
+    shadow.origin = glm::vec4(p, light.radius);
+}
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // build and compile shaders
+    // -------------------------
+    Shader shader("3.2.3.point_shadows_atlas.vs", "3.2.3.point_shadows_atlas.fs");
+    Shader simpleDepthShader("3.2.3.shadow_depth.vs", "3.2.3.shadow_depth.fs");
+    Shader debugDepthQuad("3.2.3.debug_quad.vs", "3.2.3.debug_quad_depth.fs");
+
+    // load textures
+    // -------------
+    unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str());
+
+    // scene: a grid of pillars in a room
+    // ----------------------------------
+    for (int x = 0; x < 5; ++x)
+    {
+        for (int z = 0; z < 5; ++z)
+        {
+            const float height = 1.0f + ((x * 7 + z * 3) % 5) * 0.8f;
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(-8.0f + x * 4.0f, -10.0f + height, -8.0f + z * 4.0f));
+            model = glm::scale(model, glm::vec3(0.6f, height, 0.6f));
+            cubeModels.push_back(model);
+        }
+    }
+
+    // lights: static point lights between the pillars, two moving point lights and four spot lights
+    // ---------------------------------------------------------------------------------------------
+    const glm::vec3 palette[] = { glm::vec3(1.0f, 0.8f, 0.6f), glm::vec3(0.6f, 0.8f, 1.0f), glm::vec3(0.8f, 1.0f, 0.6f), glm::vec3(1.0f, 0.6f, 0.8f) };
+    for (int x = 0; x < 4; ++x)
+    {
+        for (int z = 0; z < 4; ++z)
+        {
+            lights.push_back(SceneLight{ glm::vec3(-6.0f + x * 4.0f, -6.5f, -6.0f + z * 4.0f), 7.0f, palette[(x + z) % 4], -2.0f, glm::vec3(0.0f), -1 });
+            atlas.addLight(SHADOW_POINT_LIGHT, true);
+        }
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        dynamicLights.push_back(static_cast<unsigned int>(lights.size()));
+        lights.push_back(SceneLight{ glm::vec3(0.0f), 8.0f, glm::vec3(1.5f), -2.0f, glm::vec3(0.0f), -1 });
+        atlas.addLight(SHADOW_POINT_LIGHT, false);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        const glm::vec3 position = glm::vec3(i & 1 ? 8.0f : -8.0f, 9.0f, i & 2 ? 8.0f : -8.0f);
+        lights.push_back(SceneLight{ position, 30.0f, glm::vec3(2.0f), std::cos(glm::radians(20.0f)), glm::normalize(glm::vec3(0.0f, -10.0f, 0.0f) - position), -1 });
+        atlas.addLight(SHADOW_SPOT_LIGHT, true);
+    }
+    const unsigned int lightCount = static_cast<unsigned int>(lights.size());
+    std::vector<RenderedShadow> renderedShadows(lightCount);
+    std::vector<ShadowView> shadowViews(lightCount * 6);
+    std::vector<float> screenSizes(lightCount);
+
+    // configure shadow atlas FBO
+    // --------------------------
+    unsigned int atlasFBO;
+    glGenFramebuffers(1, &atlasFBO);
+    unsigned int atlasTexture;
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, ATLAS_SIZE, ATLAS_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, atlasTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Shadow atlas framebuffer is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // light and shadow view buffers
+    // -----------------------------
+    unsigned int lightBuffer, shadowViewBuffer;
+    glGenBuffers(1, &lightBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, lightCount * sizeof(SceneLight), NULL, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &shadowViewBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, shadowViewBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, shadowViews.size() * sizeof(ShadowView), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, shadowViewBuffer);
+
+    // shader configuration
+    // --------------------
+    shader.use();
+    shader.setInt("diffuseTexture", 0);
+    shader.setInt("shadowAtlas", 1);
+    debugDepthQuad.use();
+    debugDepthQuad.setInt("depthMap", 0);
+
+    float lastTitleUpdate = 0.0f;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // move the dynamic lights; their shadow maps go stale
+        for (unsigned int i = 0; i < dynamicLights.size(); ++i)
+        {
+            const float angle = currentFrame * 0.4f + i * 3.14159265f;
+            lights[dynamicLights[i]].position = glm::vec3(std::sin(angle) * 9.0f, -1.0f, std::cos(angle) * 9.0f); // above the pillars
+            atlas.invalidate(dynamicLights[i]);
+        }
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 0. importance of every light: its size on screen, 0 when its sphere is out of view
+        // ------------------------------------------------------------------------------------
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::vec4 frustumPlanes[6];
+        extractFrustumPlanes(projection * view, frustumPlanes);
+        for (unsigned int i = 0; i < lightCount; ++i)
+        {
+            const glm::vec4 sphere = glm::vec4(lights[i].position, lights[i].radius);
+            screenSizes[i] = isSphereInFrustum(sphere, frustumPlanes) ?
+                shadowScreenSize(glm::vec4(glm::vec3(view * glm::vec4(lights[i].position, 1.0f)), lights[i].radius), glm::radians(camera.Zoom), SCR_HEIGHT) : 0.0f;
+        }
+        atlas.faceBudget = faceBudgets[faceBudgetIndex];
+        atlas.update(screenSizes.data());
+
+        // 1. render the shadow maps the atlas scheduled into their tiles
+        // --------------------------------------------------------------
+        glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+        glEnable(GL_SCISSOR_TEST);
+        simpleDepthShader.use();
+        for (unsigned int index : atlas.renderList)
+        {
+            const ShadowAtlas::Light& atlasLight = atlas.lights[index];
+            computeShadowViews(lights[index], renderedShadows[index]);
+            simpleDepthShader.setVec3("lightPos", lights[index].position);
+            simpleDepthShader.setFloat("far_plane", lights[index].radius);
+            for (unsigned int face = 0; face < shadowFaceCount(atlasLight.type); ++face)
+            {
+                const ShadowAtlasTile& tile = atlasLight.tiles[face];
+                glViewport(tile.x, tile.y, tile.size, tile.size);
+                glScissor(tile.x, tile.y, tile.size, tile.size);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                simpleDepthShader.setMat4("lightSpaceMatrix", renderedShadows[index].faces[face]);
+                renderScene(simpleDepthShader);
+            }
+        }
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 2. upload the lights and the shadow views of the visible ones
+        // -------------------------------------------------------------
+        unsigned int viewCount = 0;
+        for (unsigned int i = 0; i < lightCount; ++i)
+        {
+            const ShadowAtlas::Light& atlasLight = atlas.lights[i];
+            lights[i].firstView = -1;
+            if (screenSizes[i] <= 0.0f || atlasLight.tileSize == 0)
+                continue;
+            lights[i].firstView = static_cast<int>(viewCount);
+            for (unsigned int face = 0; face < shadowFaceCount(atlasLight.type); ++face)
+            {
+                const ShadowAtlasTile& tile = atlasLight.tiles[face];
+                shadowViews[viewCount++] = ShadowView{ renderedShadows[i].faces[face], glm::vec4(tile.x, tile.y, tile.size, 0.0f) / (float)ATLAS_SIZE, renderedShadows[i].origin };
+            }
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lightCount * sizeof(SceneLight), lights.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, shadowViewBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, viewCount * sizeof(ShadowView), shadowViews.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // 3. render scene as normal
+        // -------------------------
+        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("viewPos", camera.Position);
+        shader.setInt("lightCount", lightCount);
+        shader.setInt("shadows", shadows); // enable/disable shadows by pressing 'SPACE'
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, woodTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        renderScene(shader);
+
+        // render the atlas to a corner of the screen for visual debugging (F)
+        // -------------------------------------------------------------------
+        if (showAtlas)
+        {
+            glViewport(SCR_WIDTH - SCR_HEIGHT / 2, 0, SCR_HEIGHT / 2, SCR_HEIGHT / 2);
+            debugDepthQuad.use();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, atlasTexture);
+            renderQuad();
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        }
+
+        // what the atlas did this frame
+        // -----------------------------
+        if (currentFrame - lastTitleUpdate > 0.5f)
+        {
+            const ShadowAtlas::Stats& stats = atlas.stats;
+            std::string title = "LearnOpenGL - shadowed " + std::to_string(stats.shadowedLights) + "/" + std::to_string(stats.visibleLights) + " visible lights, rendered " +
+                std::to_string(stats.renderedFaces) + " views (budget " + std::to_string(atlas.faceBudget) + ", " + std::to_string(stats.deferredLights) + " lights deferred), " +
+                std::to_string(stats.cacheHits) + " cache hits, atlas " + std::to_string(static_cast<int>(atlas.occupancy() * 100.0f)) + "% used";
+            glfwSetWindowTitle(window, title.c_str());
+            lastTitleUpdate = currentFrame;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteFramebuffers(1, &atlasFBO);
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &shadowViewBuffer);
+
+    glfwTerminate();
+    return 0;
+}
+
+// renders the 3D scene
+// --------------------
+void renderScene(const Shader &shader)
+{
+    // room cube
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::scale(model, glm::vec3(10.0f));
+    shader.setMat4("model", model);
+    glDisable(GL_CULL_FACE); // note that we disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal culling methods.
+    shader.setInt("reverse_normals", 1); // A small little hack to invert normals when drawing cube from the inside so lighting still works.
+    renderCube();
+    shader.setInt("reverse_normals", 0); // and of course disable it
+    glEnable(GL_CULL_FACE);
+    // pillars
+    for (const glm::mat4& pillar : cubeModels)
+    {
+        shader.setMat4("model", pillar);
+        renderCube();
+    }
+}
+
+// renderCube() renders a 1x1 3D cube in NDC.
+// -------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube()
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glBindVertexArray(0);
+}
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !shadowsKeyPressed)
+    {
+        shadows = !shadows;
+        shadowsKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE)
+    {
+        shadowsKeyPressed = false;
+    }
+
+    static int fPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE && fPress == GLFW_PRESS)
+    {
+        showAtlas = !showAtlas;
+    }
+    fPress = glfwGetKey(window, GLFW_KEY_F);
+
+    static int bPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE && bPress == GLFW_PRESS)
+    {
+        faceBudgetIndex = (faceBudgetIndex + 1) % (sizeof(faceBudgets) / sizeof(faceBudgets[0]));
+        std::cout << "shadow update budget: " << faceBudgets[faceBudgetIndex] << " views per frame" << std::endl;
+    }
+    bPress = glfwGetKey(window, GLFW_KEY_B);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+unsigned int loadTexture(char const * path)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        GLenum format;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+        else if (nrComponents == 4)
+            format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT); // for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat 
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
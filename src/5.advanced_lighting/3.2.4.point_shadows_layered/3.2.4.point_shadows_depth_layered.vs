@@ -0,0 +1,23 @@
+#version 410 core
+// writing gl_Layer from the vertex shader needs one of these; the application defines which one it found
+#ifdef ARB_SHADER_VIEWPORT_LAYER_ARRAY
+#extension GL_ARB_shader_viewport_layer_array : require
+#else
+#extension GL_AMD_vertex_shader_layer : require
+#endif
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 shadowMatrices[6];
+// the cube faces this draw covers; instance i renders the mesh into faces[i]
+uniform int faces[6];
+
+out vec4 FragPos;
+
+void main()
+{
+    int face = faces[gl_InstanceID];
+    FragPos = model * vec4(aPos, 1.0);
+    gl_Position = shadowMatrices[face] * FragPos;
+    gl_Layer = face;
+}
@@ -0,0 +1,650 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/instance_culling.h>
+#include <learnopengl/gpu_timer.h>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+unsigned int loadTexture(const char *path);
+void renderScene(const Shader &shader);
+void renderCube(unsigned int instanceCount = 1);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+bool shadows = true;
+bool shadowsKeyPressed = false;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// how the six faces of the depth cubemap are rendered (M cycles through them)
+enum ShadowPassMode
+{
+    SHADOW_PASS_GEOMETRY_SHADER,   // one draw per mesh, a geometry shader copies every triangle to all six faces, like 3.2.1
+    SHADOW_PASS_LAYERED_INSTANCING, // one instanced draw per mesh with an instance per face it touches, gl_Layer written by the vertex shader
+    SHADOW_PASS_FACE_LOOP,          // one pass per face, drawing only the meshes whose bounds touch it
+    SHADOW_PASS_MODE_COUNT
+};
+const char* shadowPassModeNames[SHADOW_PASS_MODE_COUNT] = { "geometry shader", "layered instancing", "per-face loop" };
+ShadowPassMode shadowPassMode = SHADOW_PASS_GEOMETRY_SHADER;
+// gl_Layer can be written from the vertex shader (ARB_shader_viewport_layer_array or AMD_vertex_shader_layer)
+bool layeredSupported = false;
+// on the next frame, print what every mode would submit for the current light position
+bool printComparison = false;
+
+// scene: the room and the cubes in it, each with a world space bounding sphere for per-face culling
+struct ShadowCaster
+{
+    glm::mat4 model;
+    glm::vec4 bounds;
+    bool room; // seen from the inside: reversed normals and no face culling
+};
+std::vector<ShadowCaster> casters;
+const unsigned int CUBE_TRIANGLES = 12;
+
+// what a shadow pass hands to the GPU for one light
+struct ShadowPassCost
+{
+    unsigned int drawCalls = 0;
+    unsigned int trianglesSubmitted = 0;  // triangles entering the vertex stage
+    unsigned int trianglesRasterized = 0; // triangles reaching a cube face, after geometry shader amplification
+};
+
+// cost of rendering the casters with a mode; faceMasks holds per caster the cube faces its bounds touch
+ShadowPassCost shadowPassCost(ShadowPassMode mode, const std::vector<unsigned int>& faceMasks)
+{
+    ShadowPassCost cost;
+    for (unsigned int mask : faceMasks)
+    {
+        unsigned int faces = 0;
+        for (unsigned int face = 0; face < 6; ++face)
+            faces += (mask >> face) & 1;
+        if (mode == SHADOW_PASS_GEOMETRY_SHADER)
+        {
+            cost.drawCalls++;
+            cost.trianglesSubmitted += CUBE_TRIANGLES;
+            cost.trianglesRasterized += 6 * CUBE_TRIANGLES;
+        }
+        else
+        {
+            cost.drawCalls += mode == SHADOW_PASS_LAYERED_INSTANCING ? (faces > 0 ? 1 : 0) : faces;
+            cost.trianglesSubmitted += faces * CUBE_TRIANGLES;
+            cost.trianglesRasterized += faces * CUBE_TRIANGLES;
+        }
+    }
+    return cost;
+}
+
+bool hasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        if (std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // build and compile shaders; the layered path only where the vertex shader may write gl_Layer
+    // --------------------------------------------------------------------------------------------
+    Shader shader("3.2.4.point_shadows.vs", "3.2.4.point_shadows.fs");
+    Shader simpleDepthShader("3.2.4.point_shadows_depth.vs", "3.2.4.point_shadows_depth.fs", "3.2.4.point_shadows_depth.gs");
+    Shader faceDepthShader("3.2.4.point_shadows_depth_face.vs", "3.2.4.point_shadows_depth.fs");
+    Shader* layeredDepthShader = nullptr;
+    if (hasExtension("GL_ARB_shader_viewport_layer_array"))
+        layeredDepthShader = new Shader("3.2.4.point_shadows_depth_layered.vs", "3.2.4.point_shadows_depth.fs", nullptr, "#define ARB_SHADER_VIEWPORT_LAYER_ARRAY\n");
+    else if (hasExtension("GL_AMD_vertex_shader_layer"))
+        layeredDepthShader = new Shader("3.2.4.point_shadows_depth_layered.vs", "3.2.4.point_shadows_depth.fs");
+    layeredSupported = layeredDepthShader != nullptr;
+    if (layeredSupported)
+        shadowPassMode = SHADOW_PASS_LAYERED_INSTANCING;
+    else
+        std::cout << "gl_Layer can't be written from the vertex shader here, layered instancing is unavailable" << std::endl;
+    std::cout << "shadow pass: " << shadowPassModeNames[shadowPassMode] << " (M to switch, P to compare)" << std::endl;
+
+    // load textures
+    // -------------
+    unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str());
+
+    // scene: the room and cubes of 3.2.1, plus more cubes scattered around the light's path
+    // --------------------------------------------------------------------------------------
+    const BoundingSphere cubeSphere = { glm::vec3(0.0f), std::sqrt(3.0f) };
+    auto addCaster = [&](const glm::mat4& model, bool room) {
+        casters.push_back(ShadowCaster{ model, transformBoundingSphere(model, cubeSphere), room });
+    };
+    addCaster(glm::scale(glm::mat4(1.0f), glm::vec3(5.0f)), true);
+    addCaster(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(4.0f, -3.5f, 0.0)), glm::vec3(0.5f)), false);
+    addCaster(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(2.0f, 3.0f, 1.0)), glm::vec3(0.75f)), false);
+    addCaster(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-3.0f, -1.0f, 0.0)), glm::vec3(0.5f)), false);
+    addCaster(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-1.5f, 1.0f, 1.5)), glm::vec3(0.5f)), false);
+    addCaster(glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(-1.5f, 2.0f, -3.0)), glm::radians(60.0f), glm::normalize(glm::vec3(1.0, 0.0, 1.0))), glm::vec3(0.75f)), false);
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> positionDistribution(-4.5f, 4.5f);
+    std::uniform_real_distribution<float> scaleDistribution(0.2f, 0.45f);
+    std::uniform_real_distribution<float> rotationDistribution(0.0f, 180.0f);
+    while (casters.size() < 48)
+    {
+        const glm::vec3 position(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        if (std::abs(position.x) < 1.2f && std::abs(position.y) < 1.2f)
+            continue; // keep the light's path along z clear
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+        model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 1.0, 0.0)));
+        addCaster(glm::scale(model, glm::vec3(scaleDistribution(generator))), false);
+    }
+    std::vector<unsigned int> faceMasks(casters.size());
+
+    // configure depth map FBOs: one with the whole cubemap for layered rendering, one per face
+    // ----------------------------------------------------------------------------------------
+    const unsigned int SHADOW_WIDTH = 1024, SHADOW_HEIGHT = 1024;
+    // create depth cubemap texture
+    unsigned int depthCubemap;
+    glGenTextures(1, &depthCubemap);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+    for (unsigned int i = 0; i < 6; ++i)
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_DEPTH_COMPONENT, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    unsigned int depthMapFBO;
+    glGenFramebuffers(1, &depthMapFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthCubemap, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    unsigned int faceFBOs[6];
+    glGenFramebuffers(6, faceFBOs);
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, faceFBOs[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, depthCubemap, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+
+    // shader configuration
+    // --------------------
+    shader.use();
+    shader.setInt("diffuseTexture", 0);
+    shader.setInt("depthMap", 1);
+    const int facesLocation = layeredSupported ? glGetUniformLocation(layeredDepthShader->ID, "faces") : -1;
+
+    // lighting info
+    // -------------
+    glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
+
+    GpuTimer timers[SHADOW_PASS_MODE_COUNT] = { GpuTimer(1), GpuTimer(1), GpuTimer(1) };
+    float lastTitleUpdate = 0.0f;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // move light position over time
+        lightPos.z = static_cast<float>(sin(glfwGetTime() * 0.5) * 3.0);
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 0. create depth cubemap transformation matrices and find the faces every caster touches
+        // ----------------------------------------------------------------------------------------
+        float near_plane = 1.0f;
+        float far_plane  = 25.0f;
+        glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), (float)SHADOW_WIDTH / (float)SHADOW_HEIGHT, near_plane, far_plane);
+        glm::mat4 shadowTransforms[6] = {
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
+            shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
+        };
+        std::fill(faceMasks.begin(), faceMasks.end(), 0u);
+        for (unsigned int face = 0; face < 6; ++face)
+        {
+            glm::vec4 planes[6];
+            extractFrustumPlanes(shadowTransforms[face], planes);
+            for (unsigned int i = 0; i < casters.size(); ++i)
+            {
+                if (isSphereInFrustum(casters[i].bounds, planes))
+                    faceMasks[i] |= 1u << face;
+            }
+        }
+        if (printComparison)
+        {
+            std::cout << "light at (" << lightPos.x << ", " << lightPos.y << ", " << lightPos.z << "), " << casters.size() << " casters:" << std::endl;
+            for (unsigned int mode = 0; mode < SHADOW_PASS_MODE_COUNT; ++mode)
+            {
+                const ShadowPassCost cost = shadowPassCost(static_cast<ShadowPassMode>(mode), faceMasks);
+                std::cout << "  " << shadowPassModeNames[mode] << ": " << cost.drawCalls << " draws, " << cost.trianglesSubmitted << " triangles submitted, "
+                    << cost.trianglesRasterized << " rasterized, " << timers[mode].average(0) << " ms on the GPU" << std::endl;
+            }
+            printComparison = false;
+        }
+
+        // 1. render scene to depth cubemap
+        // --------------------------------
+        GpuTimer& timer = timers[shadowPassMode];
+        timer.mark(0);
+        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+        if (shadowPassMode == SHADOW_PASS_GEOMETRY_SHADER)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            simpleDepthShader.use();
+            for (unsigned int i = 0; i < 6; ++i)
+                simpleDepthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
+            simpleDepthShader.setFloat("far_plane", far_plane);
+            simpleDepthShader.setVec3("lightPos", lightPos);
+            renderScene(simpleDepthShader);
+        }
+        else if (shadowPassMode == SHADOW_PASS_LAYERED_INSTANCING)
+        {
+            // every caster once, instanced over the faces it touches
+            glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            layeredDepthShader->use();
+            for (unsigned int i = 0; i < 6; ++i)
+                layeredDepthShader->setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
+            layeredDepthShader->setFloat("far_plane", far_plane);
+            layeredDepthShader->setVec3("lightPos", lightPos);
+            for (unsigned int i = 0; i < casters.size(); ++i)
+            {
+                int faces[6];
+                unsigned int faceCount = 0;
+                for (unsigned int face = 0; face < 6; ++face)
+                {
+                    if (faceMasks[i] & (1u << face))
+                        faces[faceCount++] = face;
+                }
+                if (faceCount == 0)
+                    continue;
+                glUniform1iv(facesLocation, faceCount, faces);
+                layeredDepthShader->setMat4("model", casters[i].model);
+                if (casters[i].room)
+                    glDisable(GL_CULL_FACE);
+                renderCube(faceCount);
+                if (casters[i].room)
+                    glEnable(GL_CULL_FACE);
+            }
+        }
+        else
+        {
+            // one pass per face; faces without casters are only cleared
+            faceDepthShader.use();
+            faceDepthShader.setFloat("far_plane", far_plane);
+            faceDepthShader.setVec3("lightPos", lightPos);
+            for (unsigned int face = 0; face < 6; ++face)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, faceFBOs[face]);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                faceDepthShader.setMat4("shadowMatrix", shadowTransforms[face]);
+                for (unsigned int i = 0; i < casters.size(); ++i)
+                {
+                    if (!(faceMasks[i] & (1u << face)))
+                        continue;
+                    faceDepthShader.setMat4("model", casters[i].model);
+                    if (casters[i].room)
+                        glDisable(GL_CULL_FACE);
+                    renderCube();
+                    if (casters[i].room)
+                        glEnable(GL_CULL_FACE);
+                }
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        timer.mark(1);
+        timer.endFrame();
+
+        // 2. render scene as normal 
+        // -------------------------
+        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        // set lighting uniforms
+        shader.setVec3("lightPos", lightPos);
+        shader.setVec3("viewPos", camera.Position);
+        shader.setInt("shadows", shadows); // enable/disable shadows by pressing 'SPACE'
+        shader.setFloat("far_plane", far_plane);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, woodTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, depthCubemap);
+        renderScene(shader);
+
+        // cost of the current mode
+        // ------------------------
+        if (currentFrame - lastTitleUpdate > 0.5f && timer.collectedFrames() > 0)
+        {
+            const ShadowPassCost cost = shadowPassCost(shadowPassMode, faceMasks);
+            std::string title = std::string("LearnOpenGL - ") + shadowPassModeNames[shadowPassMode] + ": " + std::to_string(timer.average(0)) + " ms, " +
+                std::to_string(cost.drawCalls) + " draws, " + std::to_string(cost.trianglesSubmitted) + " triangles submitted, " +
+                std::to_string(cost.trianglesRasterized) + " rasterized";
+            glfwSetWindowTitle(window, title.c_str());
+            lastTitleUpdate = currentFrame;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    for (unsigned int mode = 0; mode < SHADOW_PASS_MODE_COUNT; ++mode)
+    {
+        if (timers[mode].collectedFrames() > 0)
+            std::cout << shadowPassModeNames[mode] << ": " << timers[mode].average(0) << " ms per shadow pass over " << timers[mode].collectedFrames() << " frames" << std::endl;
+    }
+    delete layeredDepthShader;
+
+    glfwTerminate();
+    return 0;
+}
+
+// renders the 3D scene
+// --------------------
+void renderScene(const Shader &shader)
+{
+    for (const ShadowCaster& caster : casters)
+    {
+        shader.setMat4("model", caster.model);
+        if (caster.room)
+        {
+            glDisable(GL_CULL_FACE); // note that we disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal culling methods.
+            shader.setInt("reverse_normals", 1); // A small little hack to invert normals when drawing cube from the inside so lighting still works.
+            renderCube();
+            shader.setInt("reverse_normals", 0); // and of course disable it
+            glEnable(GL_CULL_FACE);
+        }
+        else
+        {
+            renderCube();
+        }
+    }
+}
+
+// renderCube() renders a 1x1 3D cube in NDC.
+// -------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube(unsigned int instanceCount)
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instanceCount);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !shadowsKeyPressed)
+    {
+        shadows = !shadows;
+        shadowsKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE)
+    {
+        shadowsKeyPressed = false;
+    }
+
+    static int mPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE && mPress == GLFW_PRESS)
+    {
+        shadowPassMode = static_cast<ShadowPassMode>((shadowPassMode + 1) % SHADOW_PASS_MODE_COUNT);
+        if (shadowPassMode == SHADOW_PASS_LAYERED_INSTANCING && !layeredSupported)
+            shadowPassMode = static_cast<ShadowPassMode>((shadowPassMode + 1) % SHADOW_PASS_MODE_COUNT);
+        std::cout << "shadow pass: " << shadowPassModeNames[shadowPassMode] << std::endl;
+    }
+    mPress = glfwGetKey(window, GLFW_KEY_M);
+
+    static int pPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE && pPress == GLFW_PRESS)
+    {
+        printComparison = true;
+    }
+    pPress = glfwGetKey(window, GLFW_KEY_P);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+unsigned int loadTexture(char const * path)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        GLenum format;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+        else if (nrComponents == 4)
+            format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT); // for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat 
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
@@ -3,7 +3,12 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
+#ifdef COMPACT_GBUFFER
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+#else
 uniform sampler2D gPosition;
+#endif
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
@@ -18,11 +23,25 @@ const int NR_LIGHTS = 32;
 uniform Light lights[NR_LIGHTS];
 uniform vec3 viewPos;
 
+#include "8.1.g_buffer_packing.glsl"
+
 void main()
 {             
     // retrieve data from gbuffer
+#ifdef COMPACT_GBUFFER
+    float depth = texture(gDepth, TexCoords).r;
+    // nothing was drawn here
+    if (depth == 1.0)
+        discard;
+    vec3 FragPos = reconstructPosition(TexCoords, depth, inverseViewProjection);
+    vec3 Normal = octahedralDecode(texture(gNormal, TexCoords).rg * 2.0 - 1.0);
+#else
     vec3 FragPos = texture(gPosition, TexCoords).rgb;
     vec3 Normal = texture(gNormal, TexCoords).rgb;
+    // nothing was drawn here
+    if (Normal == vec3(0.0))
+        discard;
+#endif
     vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
     float Specular = texture(gAlbedoSpec, TexCoords).a;
     
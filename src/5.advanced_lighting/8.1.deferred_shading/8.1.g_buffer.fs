@@ -1,7 +1,12 @@
 #version 330 core
+#ifdef COMPACT_GBUFFER
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedoSpec;
+#else
 layout (location = 0) out vec3 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec4 gAlbedoSpec;
+#endif
 
 in vec2 TexCoords;
 in vec3 FragPos;
@@ -10,14 +15,21 @@ in vec3 Normal;
 uniform sampler2D texture_diffuse1;
 uniform sampler2D texture_specular1;
 
+#include "8.1.g_buffer_packing.glsl"
+
 void main()
 {    
+#ifdef COMPACT_GBUFFER
+    // the position follows from the depth buffer, the normal is stored as two octahedral coordinates
+    gNormal = octahedralEncode(normalize(Normal)) * 0.5 + 0.5;
+#else
     // store the fragment position vector in the first gbuffer texture
     gPosition = FragPos;
     // also store the per-fragment normals into the gbuffer
     gNormal = normalize(Normal);
+#endif
     // and the diffuse per-fragment color
     gAlbedoSpec.rgb = texture(texture_diffuse1, TexCoords).rgb;
     // store specular intensity in gAlbedoSpec's alpha component
     gAlbedoSpec.a = texture(texture_specular1, TexCoords).r;
-}
\ No newline at end of file
+}
@@ -0,0 +1,26 @@
+// Encoding of the compact g-buffer layout (see learnopengl/gbuffer.h).
+
+// Folds a unit vector onto the octahedron |x| + |y| + |z| = 1 and unfolds that into the [-1, 1] square,
+// so two coordinates are enough to store a normal.
+vec2 octahedralEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signs;
+}
+
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy -= vec2(n.x >= 0.0 ? t : -t, n.y >= 0.0 ? t : -t);
+    return normalize(n);
+}
+
+// the point at texture coordinate uv and depth buffer value depth, taken back through the inverse of the
+// matrix that brought it to clip space
+vec3 reconstructPosition(vec2 uv, float depth, mat4 inverseMatrix)
+{
+    vec4 position = inverseMatrix * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    return position.xyz / position.w;
+}
@@ -9,8 +9,11 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <string>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -34,8 +37,11 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main()
+int main(int argc, char* argv[])
 {
+    // start with "--gbuffer compact" to reconstruct positions from depth and pack the normals
+    const GBufferLayout gBufferLayout = gBufferLayoutFromArguments(argc, argv);
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -81,8 +87,8 @@ int main()
 
     // build and compile shaders
     // -------------------------
-    Shader shaderGeometryPass("8.1.g_buffer.vs", "8.1.g_buffer.fs");
-    Shader shaderLightingPass("8.1.deferred_shading.vs", "8.1.deferred_shading.fs");
+    Shader shaderGeometryPass("8.1.g_buffer.vs", "8.1.g_buffer.fs", nullptr, gBufferDefines(gBufferLayout));
+    Shader shaderLightingPass("8.1.deferred_shading.vs", "8.1.deferred_shading.fs", nullptr, gBufferDefines(gBufferLayout));
     Shader shaderLightBox("8.1.deferred_light_box.vs", "8.1.deferred_light_box.fs");
 
     // load models
@@ -102,44 +108,9 @@ int main()
 
     // configure g-buffer framebuffer
     // ------------------------------
-    unsigned int gBuffer;
-    glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition, gNormal, gAlbedoSpec;
-    // position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-    // normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-    // color + specular color buffer
-    glGenTextures(1, &gAlbedoSpec);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-    glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GBuffer gBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
+    std::cout << "G-buffer: " << gBufferLayoutName(gBufferLayout) << " layout, " << gBufferBytesPerPixel(gBufferLayout) << " bytes per pixel ("
+        << gBufferBytesPerPixel(gBufferLayout) * SCR_WIDTH * SCR_HEIGHT / (1024.0 * 1024.0) << " MB)" << std::endl;
 
     // lighting info
     // -------------
@@ -165,9 +136,14 @@ int main()
     // --------------------
     shaderLightingPass.use();
     shaderLightingPass.setInt("gPosition", 0);
+    shaderLightingPass.setInt("gDepth", 0);
     shaderLightingPass.setInt("gNormal", 1);
     shaderLightingPass.setInt("gAlbedoSpec", 2);
 
+    // GPU time of the geometry and the lighting pass, shown in the window title
+    GpuTimer timer(2);
+    float lastTitleUpdate = 0.0f;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -189,7 +165,8 @@ int main()
 
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        timer.mark(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.ID);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
             glm::mat4 view = camera.GetViewMatrix();
@@ -209,14 +186,17 @@ int main()
 
         // 2. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
         // -----------------------------------------------------------------------------------------------------------------------
+        timer.mark(1);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         shaderLightingPass.use();
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.positionSource());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.gNormal);
         glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.gAlbedoSpec);
+        // the compact layout takes the depth buffer back to world space
+        shaderLightingPass.setMat4("inverseViewProjection", glm::inverse(projection * view));
         // send light relevant uniforms
         for (unsigned int i = 0; i < lightPositions.size(); i++)
         {
@@ -231,10 +211,12 @@ int main()
         shaderLightingPass.setVec3("viewPos", camera.Position);
         // finally render quad
         renderQuad();
+        timer.mark(2);
+        timer.endFrame();
 
         // 2.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
         // ----------------------------------------------------------------------------------
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer.ID);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
         // blit to default framebuffer. Note that this may or may not work as the internal formats of both the FBO and default framebuffer have to match.
         // the internal formats are implementation defined. This works on all of my systems, but if it doesn't on yours you'll likely have to write to the 		
@@ -257,6 +239,14 @@ int main()
             renderCube();
         }
 
+        // show the pass timings about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f && timer.collectedFrames() > 0)
+        {
+            std::string title = std::string("LearnOpenGL - ") + gBufferLayoutName(gBufferLayout) + " g-buffer, geometry " + std::to_string(timer.average(0)) +
+                " ms, lighting " + std::to_string(timer.average(1)) + " ms";
+            glfwSetWindowTitle(window, title.c_str());
+            lastTitleUpdate = currentFrame;
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -264,6 +254,10 @@ int main()
         glfwPollEvents();
     }
 
+    // averages over the whole run, to compare against a run with the other layout
+    std::cout << gBufferLayoutName(gBufferLayout) << " g-buffer over " << timer.collectedFrames() << " frames: geometry pass " << timer.average(0)
+        << " ms, lighting pass " << timer.average(1) << " ms" << std::endl;
+
     glfwTerminate();
     return 0;
 }
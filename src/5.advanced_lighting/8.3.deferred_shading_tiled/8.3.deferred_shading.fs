@@ -0,0 +1,83 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+// keep in sync with 8.3.light_culling.cs
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 256
+
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+layout (std430, binding = 1) readonly buffer TileLightIndices
+{
+    uint tileLightIndices[];
+};
+layout (std430, binding = 2) readonly buffer TileLightCounts
+{
+    uint tileLightCounts[];
+};
+
+uniform int tilesX;
+uniform int tilesY;
+uniform int lightCount;
+uniform bool tiled; // false: loop over every light like 8.2 does
+uniform vec3 viewPos;
+
+vec3 shadeLight(Light light, vec3 FragPos, vec3 Normal, vec3 viewDir, vec3 Diffuse, float Specular)
+{
+    // calculate distance between light source and current fragment
+    float distance = length(light.Position - FragPos);
+    if(distance >= light.Radius)
+        return vec3(0.0);
+    // diffuse
+    vec3 lightDir = normalize(light.Position - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.Color;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = light.Color * spec * Specular;
+    // attenuation
+    float attenuation = 1.0 / (1.0 + light.Linear * distance + light.Quadratic * distance * distance);
+    return (diffuse + specular) * attenuation;
+}
+
+void main()
+{             
+    // retrieve data from gbuffer
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+    
+    // then calculate lighting as usual, but only for the lights the culling pass found in this pixel's tile
+    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    if (tiled)
+    {
+        ivec2 tileId = min(ivec2(gl_FragCoord.xy) / TILE_SIZE, ivec2(tilesX, tilesY) - 1);
+        uint tile = uint(tileId.y * tilesX + tileId.x);
+        uint count = tileLightCounts[tile];
+        for(uint i = 0u; i < count; ++i)
+            lighting += shadeLight(lights[tileLightIndices[tile * uint(MAX_LIGHTS_PER_TILE) + i]], FragPos, Normal, viewDir, Diffuse, Specular);
+    }
+    else
+    {
+        for(int i = 0; i < lightCount; ++i)
+            lighting += shadeLight(lights[i], FragPos, Normal, viewDir, Diffuse, Specular);
+    }
+    FragColor = vec4(lighting, 1.0);
+}
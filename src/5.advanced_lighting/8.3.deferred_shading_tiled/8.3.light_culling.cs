@@ -0,0 +1,111 @@
+#version 430 core
+// one work group per screen tile; keep in sync with learnopengl/light_culling.h
+#define TILE_SIZE 16
+#define MAX_LIGHTS_PER_TILE 256
+layout (local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+// MAX_LIGHTS_PER_TILE slots per tile, of which the first tileLightCounts[tile] are used
+layout (std430, binding = 1) writeonly buffer TileLightIndices
+{
+    uint tileLightIndices[];
+};
+layout (std430, binding = 2) writeonly buffer TileLightCounts
+{
+    uint tileLightCounts[];
+};
+
+uniform sampler2D depthMap;
+uniform mat4 projection;
+uniform mat4 view;
+uniform uint lightCount;
+uniform ivec2 screenSize;
+
+// depth bounds as float bits: non-negative floats order like their bit patterns
+shared uint minDepthBits;
+shared uint maxDepthBits;
+shared uint visibleCount;
+shared uint visibleLights[MAX_LIGHTS_PER_TILE];
+
+// same math as linearizeDepth in light_culling.h
+float linearizeDepth(float depth)
+{
+    return projection[3][2] / ((depth * 2.0 - 1.0) + projection[2][2]);
+}
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0u)
+    {
+        minDepthBits = floatBitsToUint(1.0);
+        maxDepthBits = 0u;
+        visibleCount = 0u;
+    }
+    barrier();
+
+    // 1. depth bounds of the geometry in this tile; the background doesn't receive light
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x < screenSize.x && pixel.y < screenSize.y)
+    {
+        float depth = texelFetch(depthMap, pixel, 0).r;
+        if (depth < 1.0)
+        {
+            atomicMin(minDepthBits, floatBitsToUint(depth));
+            atomicMax(maxDepthBits, floatBitsToUint(depth));
+        }
+    }
+    barrier();
+
+    // 2. test the lights against the tile's frustum, TILE_SIZE * TILE_SIZE lights at a time
+    if (minDepthBits <= maxDepthBits)
+    {
+        // same planes as computeTilePlanes in light_culling.h
+        mat4 m = transpose(projection);
+        vec2 ndcMin = 2.0 * vec2(gl_WorkGroupID.xy * uint(TILE_SIZE)) / vec2(screenSize) - 1.0;
+        vec2 ndcMax = 2.0 * vec2((gl_WorkGroupID.xy + 1u) * uint(TILE_SIZE)) / vec2(screenSize) - 1.0;
+        vec4 planes[6];
+        planes[0] = m[0] - ndcMin.x * m[3];
+        planes[1] = ndcMax.x * m[3] - m[0];
+        planes[2] = m[1] - ndcMin.y * m[3];
+        planes[3] = ndcMax.y * m[3] - m[1];
+        for (int i = 0; i < 4; ++i)
+            planes[i] /= length(planes[i].xyz);
+        planes[4] = vec4(0.0, 0.0, -1.0, -linearizeDepth(uintBitsToFloat(minDepthBits)));
+        planes[5] = vec4(0.0, 0.0, 1.0, linearizeDepth(uintBitsToFloat(maxDepthBits)));
+
+        for (uint i = gl_LocalInvocationIndex; i < lightCount; i += uint(TILE_SIZE * TILE_SIZE))
+        {
+            vec3 center = (view * vec4(lights[i].Position, 1.0)).xyz;
+            float radius = lights[i].Radius;
+            bool inside = true;
+            for (int p = 0; p < 6 && inside; ++p)
+                inside = dot(planes[p].xyz, center) + planes[p].w >= -radius;
+            if (inside)
+            {
+                uint slot = atomicAdd(visibleCount, 1u);
+                if (slot < uint(MAX_LIGHTS_PER_TILE))
+                    visibleLights[slot] = i;
+            }
+        }
+    }
+    barrier();
+
+    // 3. write the tile's list out
+    uint tile = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    uint count = min(visibleCount, uint(MAX_LIGHTS_PER_TILE));
+    for (uint i = gl_LocalInvocationIndex; i < count; i += uint(TILE_SIZE * TILE_SIZE))
+        tileLightIndices[tile * uint(MAX_LIGHTS_PER_TILE) + i] = visibleLights[i];
+    if (gl_LocalInvocationIndex == 0u)
+        tileLightCounts[tile] = count;
+}
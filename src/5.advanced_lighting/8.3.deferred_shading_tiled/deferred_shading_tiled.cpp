@@ -0,0 +1,560 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/light_culling.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+void renderQuad();
+void renderCube(unsigned int instanceCount);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 14.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// lights
+const unsigned int MAX_LIGHTS = 4096;
+unsigned int lightCount = 1024;
+// shade with the per-tile light lists (T toggles), or loop over every light per pixel
+bool tiledShading = true;
+// compare the GPU tile lists against the CPU reference on the next frame
+bool verifyBinning = false;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
+    stbi_set_flip_vertically_on_load(true);
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader shaderGeometryPass("8.3.g_buffer.vs", "8.3.g_buffer.fs");
+    Shader shaderLightingPass("8.3.deferred_shading.vs", "8.3.deferred_shading.fs");
+    Shader shaderLightBox("8.3.deferred_light_box.vs", "8.3.deferred_light_box.fs");
+    ComputeShader lightCullingShader("8.3.light_culling.cs");
+
+    // load models
+    // -----------
+    Model backpack(FileSystem::getPath("resources/objects/backpack/backpack.obj"));
+    std::vector<glm::vec3> objectPositions;
+    for (int z = -3; z <= 3; z++)
+        for (int x = -3; x <= 3; x++)
+            objectPositions.push_back(glm::vec3(x * 3.0f, -0.5f, z * 3.0f));
+
+
+    // configure g-buffer framebuffer
+    // ------------------------------
+    unsigned int gBuffer;
+    glGenFramebuffers(1, &gBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    unsigned int gPosition, gNormal, gAlbedoSpec;
+    // position color buffer
+    glGenTextures(1, &gPosition);
+    glBindTexture(GL_TEXTURE_2D, gPosition);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+    // normal color buffer
+    glGenTextures(1, &gNormal);
+    glBindTexture(GL_TEXTURE_2D, gNormal);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    // color + specular color buffer
+    glGenTextures(1, &gAlbedoSpec);
+    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
+    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
+    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, attachments);
+    // depth buffer: a texture this time, the light culling pass reads the depth bounds of every tile from it
+    unsigned int gDepth;
+    glGenTextures(1, &gDepth);
+    glBindTexture(GL_TEXTURE_2D, gDepth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, gDepth, 0);
+    // finally check if framebuffer is complete
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // lighting info
+    // -------------
+    // all lights share one steep attenuation so that each only touches a small part of the scene
+    const float linear = 2.0f;
+    const float quadratic = 20.0f;
+    std::vector<PointLight> lights(MAX_LIGHTS);
+    std::vector<glm::vec3> lightBasePositions(MAX_LIGHTS);
+    srand(13);
+    for (unsigned int i = 0; i < MAX_LIGHTS; i++)
+    {
+        // calculate slightly random offsets
+        float xPos = static_cast<float>(((rand() % 1000) / 1000.0) * 21.0 - 10.5);
+        float yPos = static_cast<float>(((rand() % 1000) / 1000.0) * 2.5 - 1.5);
+        float zPos = static_cast<float>(((rand() % 1000) / 1000.0) * 21.0 - 10.5);
+        lightBasePositions[i] = glm::vec3(xPos, yPos, zPos);
+        // also calculate random color
+        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        lights[i].position = lightBasePositions[i];
+        lights[i].color = glm::vec3(rColor, gColor, bColor);
+        lights[i].linear = linear;
+        lights[i].quadratic = quadratic;
+        lights[i].radius = lightVolumeRadius(lights[i].color, linear, quadratic);
+    }
+
+    // configure light and tile buffers
+    // --------------------------------
+    // the lights live in an SSBO that is refilled every frame with a single upload
+    unsigned int lightBuffer;
+    glGenBuffers(1, &lightBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, MAX_LIGHTS * sizeof(PointLight), lights.data(), GL_DYNAMIC_DRAW);
+    // per tile: the indices of the lights that touch it and how many there are
+    const glm::uvec2 tiles = lightTileCount(SCR_WIDTH, SCR_HEIGHT);
+    unsigned int tileIndexBuffer;
+    glGenBuffers(1, &tileIndexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileIndexBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, tiles.x * tiles.y * MAX_LIGHTS_PER_TILE * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+    unsigned int tileCountBuffer;
+    glGenBuffers(1, &tileCountBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileCountBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, tiles.x * tiles.y * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, tileIndexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, tileCountBuffer);
+
+    // GPU time of light culling + shading, shown in the window title; two queries so we never wait on the current frame's
+    unsigned int timerQueries[2];
+    glGenQueries(2, timerQueries);
+    unsigned int frame = 0;
+    double lightingTime = 0.0;
+    unsigned int timedFrames = 0;
+    float lastTitleUpdate = 0.0f;
+
+    // shader configuration
+    // --------------------
+    shaderLightingPass.use();
+    shaderLightingPass.setInt("gPosition", 0);
+    shaderLightingPass.setInt("gNormal", 1);
+    shaderLightingPass.setInt("gAlbedoSpec", 2);
+    shaderLightingPass.setInt("tilesX", tiles.x);
+    shaderLightingPass.setInt("tilesY", tiles.y);
+    lightCullingShader.use();
+    lightCullingShader.setInt("depthMap", 3);
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        auto currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // move the lights up and down a little and upload them
+        for (unsigned int i = 0; i < lightCount; i++)
+            lights[i].position.y = lightBasePositions[i].y + 0.25f * std::sin(currentFrame + static_cast<float>(i));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lightCount * sizeof(PointLight), lights.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // render
+        // ------
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 1. geometry pass: render scene's geometry/color data into gbuffer
+        // -----------------------------------------------------------------
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 model = glm::mat4(1.0f);
+        shaderGeometryPass.use();
+        shaderGeometryPass.setMat4("projection", projection);
+        shaderGeometryPass.setMat4("view", view);
+        for (unsigned int i = 0; i < objectPositions.size(); i++)
+        {
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, objectPositions[i]);
+            model = glm::scale(model, glm::vec3(0.25f));
+            shaderGeometryPass.setMat4("model", model);
+            backpack.Draw(shaderGeometryPass);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 2. light culling pass: one work group per 16x16 tile bins the lights that intersect the tile's depth bounds
+        // -----------------------------------------------------------------------------------------------------------
+        // the previous query of this slot was issued two frames ago, so its result is normally ready
+        if (frame >= 2)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(timerQueries[frame % 2], GL_QUERY_RESULT, &elapsed);
+            lightingTime += elapsed / 1000000.0;
+            timedFrames++;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, timerQueries[frame % 2]);
+        if (tiledShading)
+        {
+            lightCullingShader.use();
+            lightCullingShader.setMat4("projection", projection);
+            lightCullingShader.setMat4("view", view);
+            lightCullingShader.setUInt("lightCount", lightCount);
+            glUniform2i(glGetUniformLocation(lightCullingShader.ID, "screenSize"), SCR_WIDTH, SCR_HEIGHT);
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, gDepth);
+            glDispatchCompute(tiles.x, tiles.y, 1);
+            // make the tile lists visible to the lighting pass
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        // 3. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
+        // -----------------------------------------------------------------------------------------------------------------------
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shaderLightingPass.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        shaderLightingPass.setBool("tiled", tiledShading);
+        shaderLightingPass.setInt("lightCount", lightCount);
+        shaderLightingPass.setVec3("viewPos", camera.Position);
+        // finally render quad
+        renderQuad();
+        glEndQuery(GL_TIME_ELAPSED);
+        frame++;
+
+        // on request: read the depth buffer and the GPU tile lists back and check them against the CPU reference
+        if (verifyBinning && tiledShading)
+        {
+            std::vector<float> depth(SCR_WIDTH * SCR_HEIGHT);
+            glBindTexture(GL_TEXTURE_2D, gDepth);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+            std::vector<unsigned int> gpuCounts(tiles.x * tiles.y), gpuIndices(tiles.x * tiles.y * MAX_LIGHTS_PER_TILE);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileCountBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuCounts.size() * sizeof(unsigned int), gpuCounts.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileIndexBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuIndices.size() * sizeof(unsigned int), gpuIndices.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            std::vector<unsigned int> cpuCounts, cpuIndices;
+            unsigned int saturated = binLightsToTiles(lights.data(), lightCount, view, projection, depth.data(), SCR_WIDTH, SCR_HEIGHT, cpuCounts, cpuIndices);
+            unsigned int mismatched = countMismatchedTiles(gpuCounts, gpuIndices, cpuCounts, cpuIndices);
+            unsigned int pairs = 0;
+            for (unsigned int count : gpuCounts)
+                pairs += count;
+            std::cout << "tile light lists: " << mismatched << " of " << gpuCounts.size() << " tiles differ from the CPU reference, "
+                << saturated << " tiles over " << MAX_LIGHTS_PER_TILE << " lights, " << pairs / static_cast<float>(gpuCounts.size())
+                << " lights per tile on average (of " << lightCount << ")" << std::endl;
+        }
+        verifyBinning = false;
+
+        // 3.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
+        // ----------------------------------------------------------------------------------
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+        // blit to default framebuffer. Note that this may or may not work as the internal formats of both the FBO and default framebuffer have to match.
+        // the internal formats are implementation defined. This works on all of my systems, but if it doesn't on yours you'll likely have to write to the 		
+        // depth buffer in another shader stage (or somehow see to match the default framebuffer's internal format with the FBO's internal format).
+        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 4. render lights on top of scene, all of them in one instanced draw straight from the light buffer
+        // --------------------------------------------------------------------------------------------------
+        shaderLightBox.use();
+        shaderLightBox.setMat4("projection", projection);
+        shaderLightBox.setMat4("view", view);
+        shaderLightBox.setFloat("boxSize", 0.03f);
+        renderCube(lightCount);
+
+        // show the lighting cost about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f && timedFrames > 0)
+        {
+            std::string title = "LearnOpenGL - " + std::to_string(lightCount) + " lights, " + (tiledShading ? "tiled" : "all lights per pixel") +
+                ", culling + shading " + std::to_string(lightingTime / timedFrames) + " ms";
+            glfwSetWindowTitle(window, title.c_str());
+            lightingTime = 0.0;
+            timedFrames = 0;
+            lastTitleUpdate = currentFrame;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteQueries(2, timerQueries);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &tileIndexBuffer);
+    glDeleteBuffers(1, &tileCountBuffer);
+
+    glfwTerminate();
+    return 0;
+}
+
+// renderCube() renders instanceCount instances of a 1x1 3D cube in NDC.
+// ---------------------------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube(unsigned int instanceCount)
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instanceCount);
+    glBindVertexArray(0);
+}
+
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // T: toggle between tiled shading and looping over every light
+    static int tPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE && tPress == GLFW_PRESS)
+        tiledShading = !tiledShading;
+    tPress = glfwGetKey(window, GLFW_KEY_T);
+
+    // +/-: double or halve the number of lights
+    static int plusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_RELEASE && plusPress == GLFW_PRESS && lightCount < MAX_LIGHTS)
+        lightCount *= 2;
+    plusPress = glfwGetKey(window, GLFW_KEY_KP_ADD);
+    static int minusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_RELEASE && minusPress == GLFW_PRESS && lightCount > 32)
+        lightCount /= 2;
+    minusPress = glfwGetKey(window, GLFW_KEY_KP_SUBTRACT);
+
+    // V: verify the GPU tile lists against the CPU reference
+    static int vPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE && vPress == GLFW_PRESS)
+        verifyBinning = true;
+    vPress = glfwGetKey(window, GLFW_KEY_V);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
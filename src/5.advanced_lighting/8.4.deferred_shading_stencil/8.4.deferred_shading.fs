@@ -0,0 +1,33 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+#include "8.4.point_light.glsl"
+
+// 0 only writes the ambient term, the light volumes add the lights on top
+uniform int lightCount;
+uniform vec3 viewPos;
+
+void main()
+{             
+    // retrieve data from gbuffer
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+    // pixels without geometry have nothing to light and keep the clear color
+    if (Normal == vec3(0.0))
+        discard;
+    
+    // then calculate lighting as usual, every pixel looping over every light like 8.2 does
+    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    for(int i = 0; i < lightCount; ++i)
+        lighting += shadeLight(uint(i), FragPos, Normal, viewDir, Diffuse, Specular);
+    FragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,27 @@
+#version 430 core
+out vec4 FragColor;
+
+flat in uint lightIndex;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+#include "8.4.point_light.glsl"
+
+uniform vec2 screenSize;
+uniform vec3 viewPos;
+
+void main()
+{             
+    // the volume covers the pixel, so look up the gbuffer at the pixel itself
+    vec2 TexCoords = gl_FragCoord.xy / screenSize;
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+
+    // blended additively on top of the ambient term
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    FragColor = vec4(shadeLight(lightIndex, FragPos, Normal, viewDir, Diffuse, Specular), 1.0);
+}
@@ -0,0 +1,28 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+
+uniform mat4 projection;
+uniform mat4 view;
+// light of the first instance; the stencil pass draws the lights one at a time
+uniform uint baseLight;
+
+flat out uint lightIndex;
+
+void main()
+{
+    // the sphere mesh encloses the unit sphere, scale it up to the light's radius
+    lightIndex = baseLight + uint(gl_InstanceID);
+    gl_Position = projection * view * vec4(aPos * lights[lightIndex].Radius + lights[lightIndex].Position, 1.0);
+}
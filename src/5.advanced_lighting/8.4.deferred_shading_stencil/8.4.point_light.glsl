@@ -0,0 +1,44 @@
+// Point lights of the 8.4 lighting shaders, shared by the full-screen and the light volume passes.
+
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+// per light: fragments that evaluated it and how many of those were inside its radius
+layout (std430, binding = 1) buffer LightCoverage
+{
+    uint lightCoverage[];
+};
+uniform bool countCoverage;
+
+vec3 shadeLight(uint index, vec3 FragPos, vec3 Normal, vec3 viewDir, vec3 Diffuse, float Specular)
+{
+    Light light = lights[index];
+    // calculate distance between light source and current fragment
+    float distance = length(light.Position - FragPos);
+    if (countCoverage)
+    {
+        atomicAdd(lightCoverage[index * 2u], 1u);
+        if (distance < light.Radius)
+            atomicAdd(lightCoverage[index * 2u + 1u], 1u);
+    }
+    if (distance >= light.Radius)
+        return vec3(0.0);
+    // diffuse
+    vec3 lightDir = normalize(light.Position - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.Color;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = light.Color * spec * Specular;
+    // attenuation
+    float attenuation = 1.0 / (1.0 + light.Linear * distance + light.Quadratic * distance * distance);
+    return (diffuse + specular) * attenuation;
+}
@@ -0,0 +1,6 @@
+#version 430 core
+
+// the stencil pass only marks pixels, it writes no color
+void main()
+{
+}
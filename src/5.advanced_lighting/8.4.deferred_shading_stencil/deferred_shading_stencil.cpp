@@ -0,0 +1,755 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/light_culling.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+void renderQuad();
+void renderCube(unsigned int instanceCount);
+void renderSphere(unsigned int instanceCount);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 14.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// lights
+const unsigned int MAX_LIGHTS = 4096;
+unsigned int lightCount = 256;
+
+// how the lighting pass finds the pixels a light has to shade (M cycles through them)
+enum LightingMode
+{
+    LIGHTING_FULL_SCREEN, // a screen filled quad on which every pixel loops over every light, like 8.2
+    LIGHTING_VOLUMES,     // one instanced draw of the lights' spheres, depth tested against the scene
+    LIGHTING_STENCIL,     // per light a stencil pass marks the pixels inside its sphere and only those are shaded
+    LIGHTING_MODE_COUNT
+};
+const char* lightingModeNames[LIGHTING_MODE_COUNT] = { "full-screen quad", "light volumes", "stencil light volumes" };
+LightingMode lightingMode = LIGHTING_STENCIL;
+// on the next frame, count the pixels every light shades in each mode and print the comparison
+bool measureCoverage = false;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
+    stbi_set_flip_vertically_on_load(true);
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader shaderGeometryPass("8.3.g_buffer.vs", "8.3.g_buffer.fs");
+    Shader shaderLightingPass("8.3.deferred_shading.vs", "8.4.deferred_shading.fs");
+    Shader shaderLightVolume("8.4.light_volume.vs", "8.4.light_volume.fs");
+    Shader shaderStencilPass("8.4.light_volume.vs", "8.4.stencil_pass.fs");
+    Shader shaderLightBox("8.3.deferred_light_box.vs", "8.3.deferred_light_box.fs");
+
+    // load models
+    // -----------
+    Model backpack(FileSystem::getPath("resources/objects/backpack/backpack.obj"));
+    std::vector<glm::vec3> objectPositions;
+    for (int z = -3; z <= 3; z++)
+        for (int x = -3; x <= 3; x++)
+            objectPositions.push_back(glm::vec3(x * 3.0f, -0.5f, z * 3.0f));
+
+
+    // configure g-buffer framebuffer
+    // ------------------------------
+    unsigned int gBuffer;
+    glGenFramebuffers(1, &gBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    unsigned int gPosition, gNormal, gAlbedoSpec;
+    // position color buffer
+    glGenTextures(1, &gPosition);
+    glBindTexture(GL_TEXTURE_2D, gPosition);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+    // normal color buffer
+    glGenTextures(1, &gNormal);
+    glBindTexture(GL_TEXTURE_2D, gNormal);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    // color + specular color buffer
+    glGenTextures(1, &gAlbedoSpec);
+    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
+    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering
+    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, attachments);
+    // depth + stencil buffer: a texture this time, so the lighting framebuffer can share it
+    unsigned int gDepthStencil;
+    glGenTextures(1, &gDepthStencil);
+    glBindTexture(GL_TEXTURE_2D, gDepthStencil);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, gDepthStencil, 0);
+    // finally check if framebuffer is complete
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+
+    // configure lighting framebuffer
+    // ------------------------------
+    // the lights are accumulated here rather than in the default framebuffer, because the light volumes
+    // have to be depth and stencil tested against the scene: it shares the g-buffer's depth/stencil texture
+    unsigned int lightingFBO;
+    glGenFramebuffers(1, &lightingFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightingFBO);
+    unsigned int lightingBuffer;
+    glGenTextures(1, &lightingBuffer);
+    glBindTexture(GL_TEXTURE_2D, lightingBuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightingBuffer, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, gDepthStencil, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // lighting info
+    // -------------
+    // all lights share one attenuation; the radius is where a light's contribution becomes negligible
+    const float linear = 1.0f;
+    const float quadratic = 4.0f;
+    std::vector<PointLight> lights(MAX_LIGHTS);
+    std::vector<glm::vec3> lightBasePositions(MAX_LIGHTS);
+    srand(13);
+    for (unsigned int i = 0; i < MAX_LIGHTS; i++)
+    {
+        // calculate slightly random offsets
+        float xPos = static_cast<float>(((rand() % 1000) / 1000.0) * 21.0 - 10.5);
+        float yPos = static_cast<float>(((rand() % 1000) / 1000.0) * 2.5 - 1.5);
+        float zPos = static_cast<float>(((rand() % 1000) / 1000.0) * 21.0 - 10.5);
+        lightBasePositions[i] = glm::vec3(xPos, yPos, zPos);
+        // also calculate random color
+        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        lights[i].position = lightBasePositions[i];
+        lights[i].color = glm::vec3(rColor, gColor, bColor);
+        lights[i].linear = linear;
+        lights[i].quadratic = quadratic;
+        lights[i].radius = lightVolumeRadius(lights[i].color, linear, quadratic);
+    }
+
+    // configure light and coverage buffers
+    // ------------------------------------
+    unsigned int lightBuffer;
+    glGenBuffers(1, &lightBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, MAX_LIGHTS * sizeof(PointLight), lights.data(), GL_DYNAMIC_DRAW);
+    // per light: the number of pixels that evaluated it and how many of those lie inside its radius,
+    // counted by the lighting shaders while measuring
+    std::vector<unsigned int> coverage(MAX_LIGHTS * 2);
+    unsigned int coverageBuffer;
+    glGenBuffers(1, &coverageBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, coverageBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, coverage.size() * sizeof(unsigned int), NULL, GL_DYNAMIC_READ);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, coverageBuffer);
+
+    // GPU time of the lighting pass, shown in the window title; two queries so we never wait on the current frame's
+    unsigned int timerQueries[2];
+    glGenQueries(2, timerQueries);
+    unsigned int frame = 0;
+    double lightingTime = 0.0;
+    unsigned int timedFrames = 0;
+    float lastTitleUpdate = 0.0f;
+
+    // shader configuration
+    // --------------------
+    shaderLightingPass.use();
+    shaderLightingPass.setInt("gPosition", 0);
+    shaderLightingPass.setInt("gNormal", 1);
+    shaderLightingPass.setInt("gAlbedoSpec", 2);
+    shaderLightVolume.use();
+    shaderLightVolume.setInt("gPosition", 0);
+    shaderLightVolume.setInt("gNormal", 1);
+    shaderLightVolume.setInt("gAlbedoSpec", 2);
+    shaderLightVolume.setVec2("screenSize", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+    const int volumeBaseLight = glGetUniformLocation(shaderLightVolume.ID, "baseLight");
+    const int stencilBaseLight = glGetUniformLocation(shaderStencilPass.ID, "baseLight");
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        auto currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // move the lights up and down a little and upload them
+        for (unsigned int i = 0; i < lightCount; i++)
+            lights[i].position.y = lightBasePositions[i].y + 0.25f * std::sin(currentFrame + static_cast<float>(i));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lightCount * sizeof(PointLight), lights.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        // render
+        // ------
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 1. geometry pass: render scene's geometry/color data into gbuffer
+        // -----------------------------------------------------------------
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 model = glm::mat4(1.0f);
+        shaderGeometryPass.use();
+        shaderGeometryPass.setMat4("projection", projection);
+        shaderGeometryPass.setMat4("view", view);
+        for (unsigned int i = 0; i < objectPositions.size(); i++)
+        {
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, objectPositions[i]);
+            model = glm::scale(model, glm::vec3(0.25f));
+            shaderGeometryPass.setMat4("model", model);
+            backpack.Draw(shaderGeometryPass);
+        }
+
+        // 2. lighting pass: add every light to the pixels it can reach, found as configured by the lighting mode
+        // -------------------------------------------------------------------------------------------------------
+        // the previous query of this slot was issued two frames ago, so its result is normally ready
+        if (frame >= 2)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(timerQueries[frame % 2], GL_QUERY_RESULT, &elapsed);
+            lightingTime += elapsed / 1000000.0;
+            timedFrames++;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, lightingFBO);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        glm::vec4 frustumPlanes[6];
+        extractFrustumPlanes(projection * view, frustumPlanes);
+        // while measuring, every mode is rendered in turn; the current one comes last, so its result stays on screen
+        unsigned long long shadedPerMode[LIGHTING_MODE_COUNT] = {};
+        const unsigned int modeCount = measureCoverage ? LIGHTING_MODE_COUNT : 1;
+        for (unsigned int m = 0; m < modeCount; m++)
+        {
+            const LightingMode mode = static_cast<LightingMode>((lightingMode + 1 + m + LIGHTING_MODE_COUNT - modeCount) % LIGHTING_MODE_COUNT);
+            if (measureCoverage)
+            {
+                const unsigned int zero = 0;
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, coverageBuffer);
+                glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            }
+            if (mode == lightingMode)
+                glBeginQuery(GL_TIME_ELAPSED, timerQueries[frame % 2]);
+
+            // the ambient term (and in full-screen mode every light) comes from a screen filled quad
+            glDisable(GL_DEPTH_TEST);
+            shaderLightingPass.use();
+            shaderLightingPass.setInt("lightCount", mode == LIGHTING_FULL_SCREEN ? lightCount : 0);
+            shaderLightingPass.setBool("countCoverage", measureCoverage);
+            shaderLightingPass.setVec3("viewPos", camera.Position);
+            renderQuad();
+
+            if (mode != LIGHTING_FULL_SCREEN)
+            {
+                // the volumes are added on top and never write depth; only their back faces are shaded, which
+                // stay in front of the camera when it is inside a volume, and depth clamping keeps the ones
+                // beyond the far plane from being clipped
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
+                glEnable(GL_CULL_FACE);
+                glCullFace(GL_FRONT);
+                glEnable(GL_DEPTH_CLAMP);
+                glDepthMask(GL_FALSE);
+                glEnable(GL_DEPTH_TEST);
+                shaderLightVolume.use();
+                shaderLightVolume.setMat4("projection", projection);
+                shaderLightVolume.setMat4("view", view);
+                shaderLightVolume.setBool("countCoverage", measureCoverage);
+                shaderLightVolume.setVec3("viewPos", camera.Position);
+                if (mode == LIGHTING_VOLUMES)
+                {
+                    // all lights in one draw: a back face only passes where the scene lies in front of it, which
+                    // rejects the pixels behind the volume but not the ones in front of it
+                    glDepthFunc(GL_GREATER);
+                    glUniform1ui(volumeBaseLight, 0);
+                    renderSphere(lightCount);
+                }
+                else
+                {
+                    shaderStencilPass.use();
+                    shaderStencilPass.setMat4("projection", projection);
+                    shaderStencilPass.setMat4("view", view);
+                    glClear(GL_STENCIL_BUFFER_BIT);
+                    for (unsigned int i = 0; i < lightCount; i++)
+                    {
+                        if (!isSphereInFrustum(glm::vec4(lights[i].position, lights[i].radius), frustumPlanes))
+                            continue;
+                        if (glm::distance(camera.Position, lights[i].position) < lights[i].radius)
+                        {
+                            // camera inside the volume: the volume is convex, so everything in front of a back face
+                            // is inside it and the depth test alone is exact; no stencil pass needed
+                            shaderLightVolume.use();
+                            glDisable(GL_STENCIL_TEST);
+                            glEnable(GL_DEPTH_TEST);
+                            glDepthFunc(GL_GREATER);
+                            glUniform1ui(volumeBaseLight, i);
+                            renderSphere(1);
+                            continue;
+                        }
+                        // stencil pass: both faces depth tested against the scene without writing color. A back
+                        // face hidden by the scene increments, a hidden front face decrements, which leaves a
+                        // nonzero value exactly where the scene lies between the two
+                        shaderStencilPass.use();
+                        glUniform1ui(stencilBaseLight, i);
+                        glEnable(GL_STENCIL_TEST);
+                        glEnable(GL_DEPTH_TEST);
+                        glDepthFunc(GL_LESS);
+                        glDisable(GL_CULL_FACE);
+                        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                        glStencilFunc(GL_ALWAYS, 0, 0);
+                        glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+                        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+                        renderSphere(1);
+                        // light pass: the back faces again, without depth test but only where the stencil is set;
+                        // it zeroes what it shades, which leaves the stencil clear for the next light
+                        shaderLightVolume.use();
+                        glUniform1ui(volumeBaseLight, i);
+                        glDisable(GL_DEPTH_TEST);
+                        glEnable(GL_CULL_FACE);
+                        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                        glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+                        glStencilOp(GL_KEEP, GL_ZERO, GL_ZERO);
+                        renderSphere(1);
+                    }
+                    glDisable(GL_STENCIL_TEST);
+                }
+                glDisable(GL_BLEND);
+                glDisable(GL_CULL_FACE);
+                glCullFace(GL_BACK);
+                glDisable(GL_DEPTH_CLAMP);
+                glDepthMask(GL_TRUE);
+                glDepthFunc(GL_LESS);
+            }
+            glEnable(GL_DEPTH_TEST);
+            if (mode == lightingMode)
+                glEndQuery(GL_TIME_ELAPSED);
+
+            // report how many pixels every light was evaluated on; the pixels inside the radius are the same in
+            // every mode, the rest is fill rate spent for nothing
+            if (measureCoverage)
+            {
+                glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, coverageBuffer);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, lightCount * 2 * sizeof(unsigned int), coverage.data());
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+                unsigned long long shaded = 0, inside = 0;
+                unsigned int maxShaded = 0;
+                for (unsigned int i = 0; i < lightCount; i++)
+                {
+                    shaded += coverage[i * 2];
+                    inside += coverage[i * 2 + 1];
+                    maxShaded = std::max(maxShaded, coverage[i * 2]);
+                }
+                shadedPerMode[mode] = shaded;
+                std::cout << lightingModeNames[mode] << ": " << shaded / lightCount << " pixels shaded per light on average (max " << maxShaded
+                    << "), " << inside << " of " << shaded << " inside the light radius" << std::endl;
+            }
+        }
+        if (measureCoverage && shadedPerMode[LIGHTING_FULL_SCREEN] > 0)
+            std::cout << "light volumes shade " << 100.0 * shadedPerMode[LIGHTING_VOLUMES] / shadedPerMode[LIGHTING_FULL_SCREEN] << "% and stencil light volumes "
+                << 100.0 * shadedPerMode[LIGHTING_STENCIL] / shadedPerMode[LIGHTING_FULL_SCREEN] << "% of the pixels the full-screen quad does" << std::endl;
+        measureCoverage = false;
+        frame++;
+
+        // 2.5. copy the lit image and the geometry's depth buffer to the default framebuffer
+        // ----------------------------------------------------------------------------------
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, lightingFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+        // blit to default framebuffer. Note that this may or may not work as the internal formats of both the FBO and default framebuffer have to match.
+        // the internal formats are implementation defined. This works on all of my systems, but if it doesn't on yours you'll likely have to write to the
+        // depth buffer in another shader stage (or somehow see to match the default framebuffer's internal format with the FBO's internal format).
+        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 3. render lights on top of scene, all of them in one instanced draw straight from the light buffer
+        // --------------------------------------------------------------------------------------------------
+        shaderLightBox.use();
+        shaderLightBox.setMat4("projection", projection);
+        shaderLightBox.setMat4("view", view);
+        shaderLightBox.setFloat("boxSize", 0.03f);
+        renderCube(lightCount);
+
+        // show the lighting cost about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f && timedFrames > 0)
+        {
+            std::string title = "LearnOpenGL - " + std::to_string(lightCount) + " lights, " + lightingModeNames[lightingMode] +
+                ", lighting " + std::to_string(lightingTime / timedFrames) + " ms";
+            glfwSetWindowTitle(window, title.c_str());
+            lightingTime = 0.0;
+            timedFrames = 0;
+            lastTitleUpdate = currentFrame;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteQueries(2, timerQueries);
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &coverageBuffer);
+
+    glfwTerminate();
+    return 0;
+}
+
+// renderSphere() renders instanceCount instances of a low-poly sphere: an icosahedron subdivided once (80
+// triangles) and scaled so that its flat faces lie just outside the unit sphere, a light volume drawn with
+// it never misses a pixel of the light.
+// ---------------------------------------------------------------------------------------------------------
+unsigned int sphereVAO = 0;
+unsigned int sphereIndexCount;
+void renderSphere(unsigned int instanceCount)
+{
+    if (sphereVAO == 0)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+        std::vector<glm::vec3> positions = {
+            glm::vec3(-1.0f,  t, 0.0f), glm::vec3(1.0f,  t, 0.0f), glm::vec3(-1.0f, -t, 0.0f), glm::vec3(1.0f, -t, 0.0f),
+            glm::vec3(0.0f, -1.0f,  t), glm::vec3(0.0f, 1.0f,  t), glm::vec3(0.0f, -1.0f, -t), glm::vec3(0.0f, 1.0f, -t),
+            glm::vec3( t, 0.0f, -1.0f), glm::vec3( t, 0.0f, 1.0f), glm::vec3(-t, 0.0f, -1.0f), glm::vec3(-t, 0.0f, 1.0f)
+        };
+        for (glm::vec3& position : positions)
+            position = glm::normalize(position);
+        std::vector<unsigned int> indices = {
+            0, 11, 5,   0, 5, 1,   0, 1, 7,   0, 7, 10,   0, 10, 11,
+            1, 5, 9,   5, 11, 4,   11, 10, 2,   10, 7, 6,   7, 1, 8,
+            3, 9, 4,   3, 4, 2,   3, 2, 6,   3, 6, 8,   3, 8, 9,
+            4, 9, 5,   2, 4, 11,   6, 2, 10,   8, 6, 7,   9, 8, 1
+        };
+        // split every triangle into four, pushing the new edge midpoints out onto the sphere
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        std::vector<unsigned int> subdivided;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            unsigned int corner[3] = { indices[i], indices[i + 1], indices[i + 2] };
+            unsigned int middle[3];
+            for (unsigned int e = 0; e < 3; e++)
+            {
+                std::pair<unsigned int, unsigned int> edge(std::min(corner[e], corner[(e + 1) % 3]), std::max(corner[e], corner[(e + 1) % 3]));
+                std::map<std::pair<unsigned int, unsigned int>, unsigned int>::iterator found = midpoints.find(edge);
+                if (found == midpoints.end())
+                {
+                    found = midpoints.insert(std::make_pair(edge, static_cast<unsigned int>(positions.size()))).first;
+                    positions.push_back(glm::normalize(positions[edge.first] + positions[edge.second]));
+                }
+                middle[e] = found->second;
+            }
+            unsigned int triangles[12] = {
+                corner[0], middle[0], middle[2],
+                corner[1], middle[1], middle[0],
+                corner[2], middle[2], middle[1],
+                middle[0], middle[1], middle[2]
+            };
+            subdivided.insert(subdivided.end(), triangles, triangles + 12);
+        }
+        // the flat faces cut into the sphere; grow the mesh until the closest face plane touches it
+        float inradius = 1.0f;
+        for (size_t i = 0; i < subdivided.size(); i += 3)
+        {
+            const glm::vec3 a = positions[subdivided[i]], b = positions[subdivided[i + 1]], c = positions[subdivided[i + 2]];
+            inradius = std::min(inradius, glm::dot(glm::normalize(glm::cross(b - a, c - a)), a));
+        }
+        for (glm::vec3& position : positions)
+            position /= inradius;
+        sphereIndexCount = static_cast<unsigned int>(subdivided.size());
+
+        unsigned int vbo, ebo;
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, subdivided.size() * sizeof(unsigned int), subdivided.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        glBindVertexArray(0);
+    }
+    glBindVertexArray(sphereVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, instanceCount);
+    glBindVertexArray(0);
+}
+
+// renderCube() renders instanceCount instances of a 1x1 3D cube in NDC.
+// ---------------------------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube(unsigned int instanceCount)
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instanceCount);
+    glBindVertexArray(0);
+}
+
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // M: cycle through the lighting modes
+    static int mPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE && mPress == GLFW_PRESS)
+        lightingMode = static_cast<LightingMode>((lightingMode + 1) % LIGHTING_MODE_COUNT);
+    mPress = glfwGetKey(window, GLFW_KEY_M);
+
+    // +/-: double or halve the number of lights
+    static int plusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_RELEASE && plusPress == GLFW_PRESS && lightCount < MAX_LIGHTS)
+        lightCount *= 2;
+    plusPress = glfwGetKey(window, GLFW_KEY_KP_ADD);
+    static int minusPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_RELEASE && minusPress == GLFW_PRESS && lightCount > 32)
+        lightCount /= 2;
+    minusPress = glfwGetKey(window, GLFW_KEY_KP_SUBTRACT);
+
+    // P: print the pixel coverage of every lighting mode
+    static int pPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE && pPress == GLFW_PRESS)
+        measureCoverage = true;
+    pPress = glfwGetKey(window, GLFW_KEY_P);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
@@ -3,7 +3,12 @@ out float FragColor;
 
 in vec2 TexCoords;
 
+#ifdef COMPACT_GBUFFER
+uniform sampler2D gDepth;
+uniform mat4 inverseProjection;
+#else
 uniform sampler2D gPosition;
+#endif
 uniform sampler2D gNormal;
 uniform sampler2D texNoise;
 
@@ -19,11 +24,18 @@ const vec2 noiseScale = vec2(800.0/4.0, 600.0/4.0);
 
 uniform mat4 projection;
 
+#include "9.ssao_g_buffer_packing.glsl"
+
 void main()
 {
     // get input for SSAO algorithm
+#ifdef COMPACT_GBUFFER
+    vec3 fragPos = reconstructPosition(TexCoords, texture(gDepth, TexCoords).r, inverseProjection);
+    vec3 normal = octahedralDecode(texture(gNormal, TexCoords).rg * 2.0 - 1.0);
+#else
     vec3 fragPos = texture(gPosition, TexCoords).xyz;
     vec3 normal = normalize(texture(gNormal, TexCoords).rgb);
+#endif
     vec3 randomVec = normalize(texture(texNoise, TexCoords * noiseScale).xyz);
     // create TBN change-of-basis matrix: from tangent-space to view-space
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
@@ -44,7 +56,11 @@ void main()
         offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
         
         // get sample depth
+#ifdef COMPACT_GBUFFER
+        float sampleDepth = viewSpaceDepth(texture(gDepth, offset.xy).r, projection); // view space z straight from the depth buffer
+#else
         float sampleDepth = texture(gPosition, offset.xy).z; // get depth value of kernel sample
+#endif
         
         // range check & accumulate
         float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
@@ -1,18 +1,30 @@
 #version 330 core
+#ifdef COMPACT_GBUFFER
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec3 gAlbedo;
+#else
 layout (location = 0) out vec3 gPosition;
 layout (location = 1) out vec3 gNormal;
 layout (location = 2) out vec3 gAlbedo;
+#endif
 
 in vec2 TexCoords;
 in vec3 FragPos;
 in vec3 Normal;
 
+#include "9.ssao_g_buffer_packing.glsl"
+
 void main()
 {    
+#ifdef COMPACT_GBUFFER
+    // the position follows from the depth buffer, the normal is stored as two octahedral coordinates
+    gNormal = octahedralEncode(normalize(Normal)) * 0.5 + 0.5;
+#else
     // store the fragment position vector in the first gbuffer texture
     gPosition = FragPos;
     // also store the per-fragment normals into the gbuffer
     gNormal = normalize(Normal);
+#endif
     // and the diffuse per-fragment color
     gAlbedo.rgb = vec3(0.95);
 }
\ No newline at end of file
@@ -3,7 +3,12 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
+#ifdef COMPACT_GBUFFER
+uniform sampler2D gDepth;
+uniform mat4 inverseProjection;
+#else
 uniform sampler2D gPosition;
+#endif
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedo;
 uniform sampler2D ssao;
@@ -17,11 +22,18 @@ struct Light {
 };
 uniform Light light;
 
+#include "9.ssao_g_buffer_packing.glsl"
+
 void main()
 {             
     // retrieve data from gbuffer
+#ifdef COMPACT_GBUFFER
+    vec3 FragPos = reconstructPosition(TexCoords, texture(gDepth, TexCoords).r, inverseProjection);
+    vec3 Normal = octahedralDecode(texture(gNormal, TexCoords).rg * 2.0 - 1.0);
+#else
     vec3 FragPos = texture(gPosition, TexCoords).rgb;
     vec3 Normal = texture(gNormal, TexCoords).rgb;
+#endif
     vec3 Diffuse = texture(gAlbedo, TexCoords).rgb;
     float AmbientOcclusion = texture(ssao, TexCoords).r;
     
@@ -9,9 +9,12 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
 #include <random>
+#include <string>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -40,8 +43,11 @@ float lerp(float a, float b, float f)
     return a + f * (b - a);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    // start with "--gbuffer compact" to reconstruct positions from depth and pack the normals
+    const GBufferLayout gBufferLayout = gBufferLayoutFromArguments(argc, argv);
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -84,9 +90,9 @@ int main()
 
     // build and compile shaders
     // -------------------------
-    Shader shaderGeometryPass("9.ssao_geometry.vs", "9.ssao_geometry.fs");
-    Shader shaderLightingPass("9.ssao.vs", "9.ssao_lighting.fs");
-    Shader shaderSSAO("9.ssao.vs", "9.ssao.fs");
+    Shader shaderGeometryPass("9.ssao_geometry.vs", "9.ssao_geometry.fs", nullptr, gBufferDefines(gBufferLayout));
+    Shader shaderLightingPass("9.ssao.vs", "9.ssao_lighting.fs", nullptr, gBufferDefines(gBufferLayout));
+    Shader shaderSSAO("9.ssao.vs", "9.ssao.fs", nullptr, gBufferDefines(gBufferLayout));
     Shader shaderSSAOBlur("9.ssao.vs", "9.ssao_blur.fs");
 
     // load models
@@ -95,46 +101,9 @@ int main()
 
     // configure g-buffer framebuffer
     // ------------------------------
-    unsigned int gBuffer;
-    glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition, gNormal, gAlbedo;
-    // position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-    // normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-    // color + specular color buffer
-    glGenTextures(1, &gAlbedo);
-    glBindTexture(GL_TEXTURE_2D, gAlbedo);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-    glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GBuffer gBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
+    std::cout << "G-buffer: " << gBufferLayoutName(gBufferLayout) << " layout, " << gBufferBytesPerPixel(gBufferLayout) << " bytes per pixel ("
+        << gBufferBytesPerPixel(gBufferLayout) * SCR_WIDTH * SCR_HEIGHT / (1024.0 * 1024.0) << " MB)" << std::endl;
 
     // also create framebuffer to hold SSAO processing stage 
     // -----------------------------------------------------
@@ -206,16 +175,22 @@ int main()
     // --------------------
     shaderLightingPass.use();
     shaderLightingPass.setInt("gPosition", 0);
+    shaderLightingPass.setInt("gDepth", 0);
     shaderLightingPass.setInt("gNormal", 1);
     shaderLightingPass.setInt("gAlbedo", 2);
     shaderLightingPass.setInt("ssao", 3);
     shaderSSAO.use();
     shaderSSAO.setInt("gPosition", 0);
+    shaderSSAO.setInt("gDepth", 0);
     shaderSSAO.setInt("gNormal", 1);
     shaderSSAO.setInt("texNoise", 2);
     shaderSSAOBlur.use();
     shaderSSAOBlur.setInt("ssaoInput", 0);
 
+    // GPU time of the geometry, SSAO (with blur) and lighting passes, shown in the window title
+    GpuTimer timer(3);
+    float lastTitleUpdate = 0.0f;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -237,7 +212,8 @@ int main()
 
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        timer.mark(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.ID);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 50.0f);
             glm::mat4 view = camera.GetViewMatrix();
@@ -265,6 +241,7 @@ int main()
 
         // 2. generate SSAO texture
         // ------------------------
+        timer.mark(1);
         glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
             glClear(GL_COLOR_BUFFER_BIT);
             shaderSSAO.use();
@@ -272,10 +249,11 @@ int main()
             for (unsigned int i = 0; i < 64; ++i)
                 shaderSSAO.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
             shaderSSAO.setMat4("projection", projection);
+            shaderSSAO.setMat4("inverseProjection", glm::inverse(projection));
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, gPosition);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.positionSource());
             glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, gNormal);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.gNormal);
             glActiveTexture(GL_TEXTURE2);
             glBindTexture(GL_TEXTURE_2D, noiseTexture);
             renderQuad();
@@ -295,8 +273,11 @@ int main()
 
         // 4. lighting pass: traditional deferred Blinn-Phong lighting with added screen-space ambient occlusion
         // -----------------------------------------------------------------------------------------------------
+        timer.mark(2);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         shaderLightingPass.use();
+        // the compact layout takes the depth buffer back to view space
+        shaderLightingPass.setMat4("inverseProjection", glm::inverse(projection));
         // send light relevant uniforms
         glm::vec3 lightPosView = glm::vec3(camera.GetViewMatrix() * glm::vec4(lightPos, 1.0));
         shaderLightingPass.setVec3("light.Position", lightPosView);
@@ -307,14 +288,25 @@ int main()
         shaderLightingPass.setFloat("light.Linear", linear);
         shaderLightingPass.setFloat("light.Quadratic", quadratic);
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.positionSource());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.gNormal);
         glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedo);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.gAlbedoSpec);
         glActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
         glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
         renderQuad();
+        timer.mark(3);
+        timer.endFrame();
+
+        // show the pass timings about once a second
+        if (currentFrame - lastTitleUpdate > 1.0f && timer.collectedFrames() > 0)
+        {
+            std::string title = std::string("LearnOpenGL - ") + gBufferLayoutName(gBufferLayout) + " g-buffer, geometry " + std::to_string(timer.average(0)) +
+                " ms, SSAO " + std::to_string(timer.average(1)) + " ms, lighting " + std::to_string(timer.average(2)) + " ms";
+            glfwSetWindowTitle(window, title.c_str());
+            lastTitleUpdate = currentFrame;
+        }
 
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -323,6 +315,10 @@ int main()
         glfwPollEvents();
     }
 
+    // averages over the whole run, to compare against a run with the other layout
+    std::cout << gBufferLayoutName(gBufferLayout) << " g-buffer over " << timer.collectedFrames() << " frames: geometry pass " << timer.average(0)
+        << " ms, SSAO pass " << timer.average(1) << " ms, lighting pass " << timer.average(2) << " ms" << std::endl;
+
     glfwTerminate();
     return 0;
 }
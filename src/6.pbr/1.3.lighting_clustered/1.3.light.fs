@@ -0,0 +1,11 @@
+#version 430 core
+out vec4 FragColor;
+
+flat in vec3 lightColor;
+
+void main()
+{
+    // same tone mapping as the spheres so the lights don't all clip to white
+    vec3 color = lightColor / (lightColor + vec3(1.0));
+    FragColor = vec4(pow(color, vec3(1.0/2.2)), 1.0);
+}
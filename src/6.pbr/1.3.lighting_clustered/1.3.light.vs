@@ -0,0 +1,27 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+
+struct Light {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer Lights
+{
+    Light lights[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float sphereSize;
+
+flat out vec3 lightColor;
+
+void main()
+{
+    // one instance per light, placed straight from the light buffer
+    lightColor = lights[gl_InstanceID].Color;
+    gl_Position = projection * view * vec4(aPos * sphereSize + lights[gl_InstanceID].Position, 1.0);
+}
@@ -1,6 +1,6 @@
 #include <iostream>
-#include <map>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -9,30 +9,25 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/glyph_atlas.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color);
+void BenchmarkText(Shader &shader);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // Size of glyph
-    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
-    unsigned int Advance;   // Horizontal offset to advance to next glyph
-};
-
-std::map<GLchar, Character> Characters;
+// all glyphs of the font in one texture
+GlyphAtlas Atlas;
 unsigned int VAO, VBO;
+// vertices of the string being rendered and the capacity of VBO (in floats)
+std::vector<float> Vertices;
+size_t VBOSize = 0;
 
 int main()
 {
@@ -82,14 +77,6 @@ int main()
 
     // FreeType
     // --------
-    FT_Library ft;
-    // All functions return a value different than 0 whenever an error occurred
-    if (FT_Init_FreeType(&ft))
-    {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-        return -1;
-    }
-
 	// find path to font
     std::string font_name = FileSystem::getPath("resources/fonts/Antonio-Bold.ttf");
     if (font_name.empty())
@@ -98,62 +85,10 @@ int main()
         return -1;
     }
 	
-	// load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font_name.c_str(), 0, &face)) {
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+    // load the font and pack its first 128 characters into the atlas; other
+    // characters are added the first time they are rendered
+    if (!Atlas.load(font_name, 48))
         return -1;
-    }
-    else {
-        // set size to load glyphs as
-        FT_Set_Pixel_Sizes(face, 0, 48);
-
-        // disable byte-alignment restriction
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-        // load first 128 characters of ASCII set
-        for (unsigned char c = 0; c < 128; c++)
-        {
-            // Load character glyph 
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-            {
-                std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-                continue;
-            }
-            // generate texture
-            unsigned int texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            // now store character for later use
-            Character character = {
-                texture,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                static_cast<unsigned int>(face->glyph->advance.x)
-            };
-            Characters.insert(std::pair<char, Character>(c, character));
-        }
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
 
     
     // configure VAO/VBO for texture quads
@@ -162,12 +97,15 @@ int main()
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
+    // measure how fast long strings are laid out and drawn
+    // ----------------------------------------------------
+    BenchmarkText(shader);
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -214,47 +152,88 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 
 // render line of text
 // -------------------
-void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color)
+bool BuildTextVertices(std::string &text, float x, float y, float scale)
 {
-    // activate corresponding render state	
-    shader.use();
-    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
-
+    int atlasHeight = Atlas.height();
     // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) 
+    for (size_t i = 0; i < text.size();)
     {
-        Character ch = Characters[*c];
+        const Glyph *ch = Atlas.glyph(GlyphAtlas::decodeUtf8(text, i));
+        if (!ch)
+            break;
 
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+        float xpos = x + ch->bearing.x * scale;
+        float ypos = y - (ch->size.y - ch->bearing.y) * scale;
 
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
+        float w = ch->size.x * scale;
+        float h = ch->size.y * scale;
+        // two triangles per glyph, textured with the glyph's rectangle in the atlas
         float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },            
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
+            { xpos,     ypos + h,   ch->uvMin.x, ch->uvMin.y },
+            { xpos,     ypos,       ch->uvMin.x, ch->uvMax.y },
+            { xpos + w, ypos,       ch->uvMax.x, ch->uvMax.y },
 
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }           
+            { xpos,     ypos + h,   ch->uvMin.x, ch->uvMin.y },
+            { xpos + w, ypos,       ch->uvMax.x, ch->uvMax.y },
+            { xpos + w, ypos + h,   ch->uvMax.x, ch->uvMin.y }
         };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
+        if (ch->size.x > 0)
+            Vertices.insert(Vertices.end(), &vertices[0][0], &vertices[0][0] + 24);
+        // now advance cursors for next glyph
+        x += ch->advance * scale;
+    }
+    // a new character may have made the atlas grow, which moves every texture coordinate
+    return Atlas.height() == atlasHeight;
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color)
+{
+    // build the quads of the whole string first
+    Vertices.clear();
+    if (!BuildTextVertices(text, x, y, scale))
+    {
+        Vertices.clear();
+        BuildTextVertices(text, x, y, scale);
     }
+    if (Vertices.empty())
+        return;
+
+    // activate corresponding render state	
+    shader.use();
+    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, Atlas.textureID);
+    glBindVertexArray(VAO);
+
+    // update content of VBO memory; re-specifying the storage lets the driver hand out fresh memory
+    // instead of waiting for the previous draw to finish with it
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    VBOSize = std::max(VBOSize, Vertices.size());
+    glBufferData(GL_ARRAY_BUFFER, VBOSize * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, Vertices.size() * sizeof(float), Vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // render all glyphs with a single draw call
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(Vertices.size() / 4));
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+// renders a long text a number of times and prints the throughput in characters per millisecond
+// ---------------------------------------------------------------------------------------------
+void BenchmarkText(Shader &shader)
+{
+    std::string text;
+    while (text.size() < 100000)
+        text += "The quick brown fox jumps over the lazy dog. 0123456789 ";
+    const int runs = 20;
+    // warm up (uploads, driver state) outside of the measurement
+    RenderText(shader, text, 0.0f, 0.0f, 0.25f, glm::vec3(1.0f));
+    glFinish();
+    double start = glfwGetTime();
+    for (int i = 0; i < runs; ++i)
+        RenderText(shader, text, 0.0f, 0.0f, 0.25f, glm::vec3(1.0f));
+    glFinish();
+    double milliseconds = (glfwGetTime() - start) * 1000.0;
+    std::cout << "text benchmark: " << text.size() * runs / milliseconds << " characters/ms (" << text.size()
+              << " characters, " << runs << " draw calls, atlas " << Atlas.height() << " texels high)" << std::endl;
+}
@@ -0,0 +1,222 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "audio_mixer.h"
+
+#include <irrklang/irrKlang.h>
+using namespace irrklang;
+
+#include <algorithm>
+
+
+IrrKlangAudioBackend::IrrKlangAudioBackend()
+    : engine(createIrrKlangDevice()), nextVoice(0)
+{
+
+}
+
+IrrKlangAudioBackend::~IrrKlangAudioBackend()
+{
+    for (auto &voice : this->voices)
+    {
+        voice.second->stop();
+        voice.second->drop();
+    }
+    if (this->engine)
+        this->engine->drop();
+}
+
+bool IrrKlangAudioBackend::Load(unsigned int sound, const std::string &file, bool stream)
+{
+    if (sound >= this->sources.size())
+        this->sources.resize(sound + 1, nullptr);
+    if (!this->engine)
+        return false;
+    // preloading a non-streamed source decodes the whole file now instead of on the first play
+    this->sources[sound] = this->engine->addSoundSourceFromFile(file.c_str(), stream ? ESM_STREAMING : ESM_NO_STREAMING, !stream);
+    return this->sources[sound] != nullptr;
+}
+
+unsigned int IrrKlangAudioBackend::Play(unsigned int sound, bool loop)
+{
+    if (sound >= this->sources.size() || !this->sources[sound])
+        return 0;
+    // tracked, so the mixer can tell when it finishes and stop it early
+    ISound *voice = this->engine->play2D(this->sources[sound], loop, false, true);
+    if (!voice)
+        return 0;
+    unsigned int handle = ++this->nextVoice;
+    this->voices[handle] = voice;
+    return handle;
+}
+
+bool IrrKlangAudioBackend::IsPlaying(unsigned int voice)
+{
+    auto found = this->voices.find(voice);
+    return found != this->voices.end() && !found->second->isFinished();
+}
+
+void IrrKlangAudioBackend::Stop(unsigned int voice)
+{
+    auto found = this->voices.find(voice);
+    if (found == this->voices.end())
+        return;
+    found->second->stop();
+    found->second->drop();
+    this->voices.erase(found);
+}
+
+
+NullAudioBackend::NullAudioBackend(float voiceSeconds)
+    : Voices(0), PeakVoices(0), voiceLength(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(voiceSeconds))), nextVoice(0)
+{
+
+}
+
+bool NullAudioBackend::Load(unsigned int /*sound*/, const std::string &/*file*/, bool /*stream*/)
+{
+    return true;
+}
+
+unsigned int NullAudioBackend::Play(unsigned int /*sound*/, bool loop)
+{
+    unsigned int handle = ++this->nextVoice;
+    this->voices[handle] = loop ? std::chrono::steady_clock::time_point::max() : std::chrono::steady_clock::now() + this->voiceLength;
+    ++this->Voices;
+    this->PeakVoices = std::max(this->PeakVoices, static_cast<unsigned int>(this->voices.size()));
+    return handle;
+}
+
+bool NullAudioBackend::IsPlaying(unsigned int voice)
+{
+    auto found = this->voices.find(voice);
+    return found != this->voices.end() && std::chrono::steady_clock::now() < found->second;
+}
+
+void NullAudioBackend::Stop(unsigned int voice)
+{
+    this->voices.erase(voice);
+}
+
+
+AudioMixer::AudioMixer(AudioBackend *backend)
+    : backend(backend), running(false), sleeping(false), handled(0)
+{
+
+}
+
+AudioMixer::~AudioMixer()
+{
+    if (this->thread.joinable())
+    {
+        this->running = false;
+        this->wake.notify_one();
+        this->thread.join();
+    }
+    for (Sound &sound : this->sounds)
+        for (unsigned int voice : sound.Voices)
+            this->backend->Stop(voice);
+}
+
+int AudioMixer::Load(const std::string &file, unsigned int maxVoices, bool stream)
+{
+    unsigned int id = static_cast<unsigned int>(this->sounds.size());
+    if (!this->backend->Load(id, file, stream))
+        return -1;
+    Sound sound;
+    sound.MaxVoices = std::max(maxVoices, 1u);
+    this->sounds.push_back(sound);
+    return static_cast<int>(id);
+}
+
+void AudioMixer::Start()
+{
+    if (this->thread.joinable())
+        return;
+    this->running = true;
+    this->thread = std::thread(&AudioMixer::run, this);
+}
+
+bool AudioMixer::Play(int sound, bool loop)
+{
+    if (sound < 0)
+        return true;
+    ++this->Stats.Requested;
+    Request request = { static_cast<unsigned int>(sound), loop };
+    if (!this->requests.Push(request))
+    {
+        ++this->Stats.Dropped;
+        return false;
+    }
+    // only wake the mixer thread if it went to sleep; notifying without holding the
+    // mutex keeps the game thread from ever blocking on it
+    if (this->sleeping.load(std::memory_order_seq_cst))
+        this->wake.notify_one();
+    return true;
+}
+
+void AudioMixer::Flush()
+{
+    while (this->thread.joinable() && this->handled < this->Stats.Requested - this->Stats.Dropped)
+        std::this_thread::yield();
+}
+
+void AudioMixer::run()
+{
+    while (this->running)
+    {
+        Request request;
+        while (this->requests.Pop(request))
+        {
+            this->start(request);
+            ++this->handled;
+        }
+        // sleep until the next request; the timeout bounds the latency of a missed wake-up
+        std::unique_lock<std::mutex> lock(this->wakeMutex);
+        this->sleeping = true;
+        if (!this->requests.Empty())
+        {
+            this->sleeping = false;
+            continue;
+        }
+        this->wake.wait_for(lock, std::chrono::milliseconds(2));
+        this->sleeping = false;
+    }
+}
+
+void AudioMixer::start(const Request &request)
+{
+    if (request.Sound >= this->sounds.size())
+        return;
+    Sound &sound = this->sounds[request.Sound];
+    this->reclaim(sound);
+    if (sound.Voices.size() >= sound.MaxVoices)
+    {
+        // the oldest voice is the least audible one: replace it
+        this->backend->Stop(sound.Voices.front());
+        sound.Voices.erase(sound.Voices.begin());
+        ++this->Stats.Stolen;
+    }
+    unsigned int voice = this->backend->Play(request.Sound, request.Loop);
+    if (voice == 0)
+        return;
+    sound.Voices.push_back(voice);
+    ++this->Stats.Started;
+}
+
+void AudioMixer::reclaim(Sound &sound)
+{
+    auto finished = std::remove_if(sound.Voices.begin(), sound.Voices.end(), [this](unsigned int voice)
+    {
+        if (this->backend->IsPlaying(voice))
+            return false;
+        this->backend->Stop(voice);
+        return true;
+    });
+    sound.Voices.erase(finished, sound.Voices.end());
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "spsc_queue.h"
+
+namespace irrklang { class ISoundEngine; class ISoundSource; class ISound; }
+
+
+// Plays sounds on behalf of an AudioMixer. Load is called before the
+// mixer thread starts; everything else only from the mixer thread.
+class AudioBackend
+{
+public:
+    virtual ~AudioBackend() { }
+    // prepares sound for playback: short sounds are decoded completely up front, streamed ones only opened
+    virtual bool         Load(unsigned int sound, const std::string &file, bool stream) = 0;
+    // starts a voice of a loaded sound; returns its handle, or 0 if it couldn't be started
+    virtual unsigned int Play(unsigned int sound, bool loop) = 0;
+    // whether a voice is still audible
+    virtual bool         IsPlaying(unsigned int voice) = 0;
+    // stops a voice (if it still plays) and releases its handle
+    virtual void         Stop(unsigned int voice) = 0;
+};
+
+// Outputs through irrKlang. Short sounds are loaded as non-streamed,
+// preloaded sound sources, which irrKlang decodes into PCM once.
+class IrrKlangAudioBackend : public AudioBackend
+{
+public:
+    IrrKlangAudioBackend();
+    ~IrrKlangAudioBackend();
+    // false if no audio device could be opened (all sounds then fail to load)
+    bool         Valid() const { return this->engine != nullptr; }
+    bool         Load(unsigned int sound, const std::string &file, bool stream) override;
+    unsigned int Play(unsigned int sound, bool loop) override;
+    bool         IsPlaying(unsigned int voice) override;
+    void         Stop(unsigned int voice) override;
+private:
+    irrklang::ISoundEngine                             *engine;
+    std::vector<irrklang::ISoundSource*>                sources;
+    std::unordered_map<unsigned int, irrklang::ISound*> voices;
+    unsigned int                                        nextVoice;
+};
+
+// Plays nothing. Every voice counts as audible for a fixed duration,
+// so the mixer's voice management behaves as with real output; used
+// without an audio device and for headless tests.
+class NullAudioBackend : public AudioBackend
+{
+public:
+    // voices started and the most that were audible at once
+    unsigned int Voices, PeakVoices;
+    NullAudioBackend(float voiceSeconds = 0.25f);
+    bool         Load(unsigned int sound, const std::string &file, bool stream) override;
+    unsigned int Play(unsigned int sound, bool loop) override;
+    bool         IsPlaying(unsigned int voice) override;
+    void         Stop(unsigned int voice) override;
+private:
+    std::chrono::steady_clock::duration                                          voiceLength;
+    // end time of every audible voice (time_point::max for looping ones)
+    std::unordered_map<unsigned int, std::chrono::steady_clock::time_point>      voices;
+    unsigned int                                                                 nextVoice;
+};
+
+// Counters of an AudioMixer, updated by the mixer thread.
+struct AudioStats
+{
+    std::atomic<unsigned int> Requested{0}; // Play calls
+    std::atomic<unsigned int> Dropped{0};   // requests lost to a full queue
+    std::atomic<unsigned int> Started{0};   // voices started
+    std::atomic<unsigned int> Stolen{0};    // voices stopped early to stay within a sound's voice limit
+};
+
+// AudioMixer triggers sounds by integer id without touching files or
+// the audio library on the game thread. Play pushes the id onto a
+// lock-free single producer/single consumer queue; a mixer thread
+// drains it, keeps every sound within its voice limit (replacing the
+// oldest voice when a sound is triggered too often) and starts the
+// voices on the backend. Play must always be called from the same
+// thread; sounds are loaded before Start.
+class AudioMixer
+{
+public:
+    AudioStats Stats;
+    // takes ownership of the backend
+    AudioMixer(AudioBackend *backend);
+    // stops the mixer thread and all voices
+    ~AudioMixer();
+    // loads a sound that may play at most maxVoices times at once; returns its id, or -1 if it failed to load
+    int  Load(const std::string &file, unsigned int maxVoices, bool stream = false);
+    // starts the mixer thread
+    void Start();
+    // requests a voice of a loaded sound (ignored for ids that failed to load); returns false if the request was dropped
+    bool Play(int sound, bool loop = false);
+    // waits until the mixer thread has handled all requests made so far
+    void Flush();
+private:
+    struct Request
+    {
+        unsigned int Sound;
+        bool         Loop;
+    };
+    struct Sound
+    {
+        unsigned int              MaxVoices;
+        // started voices, oldest first
+        std::vector<unsigned int> Voices;
+    };
+    std::unique_ptr<AudioBackend> backend;
+    std::vector<Sound>            sounds;
+    SpscQueue<Request, 256>       requests;
+    std::thread                   thread;
+    std::atomic<bool>             running, sleeping;
+    std::atomic<unsigned int>     handled;
+    std::mutex                    wakeMutex;
+    std::condition_variable       wake;
+    // mixer thread
+    void run();
+    void start(const Request &request);
+    // forgets voices that finished playing
+    void reclaim(Sound &sound);
+};
+
+#endif
\ No newline at end of file
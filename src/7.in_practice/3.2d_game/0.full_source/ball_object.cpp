@@ -8,6 +8,9 @@
 ******************************************************************/
 #include "ball_object.h"
 
+#include <algorithm>
+#include <cmath>
+
 
 BallObject::BallObject() 
     : GameObject(), Radius(12.5f), Stuck(true), Sticky(false), PassThrough(false)  { }
@@ -15,33 +18,6 @@ BallObject::BallObject()
 BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite)
     : GameObject(pos, glm::vec2(radius * 2.0f, radius * 2.0f), sprite, glm::vec3(1.0f), velocity), Radius(radius), Stuck(true), Sticky(false), PassThrough(false) { }
 
-glm::vec2 BallObject::Move(float dt, unsigned int window_width)
-{
-    // if not stuck to player board
-    if (!this->Stuck)
-    {
-        // move the ball
-        this->Position += this->Velocity * dt;
-        // then check if outside window bounds and if so, reverse velocity and restore at correct position
-        if (this->Position.x <= 0.0f)
-        {
-            this->Velocity.x = -this->Velocity.x;
-            this->Position.x = 0.0f;
-        }
-        else if (this->Position.x + this->Size.x >= window_width)
-        {
-            this->Velocity.x = -this->Velocity.x;
-            this->Position.x = window_width - this->Size.x;
-        }
-        if (this->Position.y <= 0.0f)
-        {
-            this->Velocity.y = -this->Velocity.y;
-            this->Position.y = 0.0f;
-        }
-    }
-    return this->Position;
-}
-
 // resets the ball to initial Stuck Position (if ball is outside window bounds)
 void BallObject::Reset(glm::vec2 position, glm::vec2 velocity)
 {
@@ -51,4 +27,81 @@ void BallObject::Reset(glm::vec2 position, glm::vec2 velocity)
     this->Sticky = false;
     this->PassThrough = false;
 
-}
\ No newline at end of file
+}
+
+bool BallObject::Sweep(const GameObject &box, glm::vec2 displacement, float &t, glm::vec2 &normal) const
+{
+    glm::vec2 center = this->Position + this->Radius;
+    glm::vec2 boxMin = box.Position, boxMax = box.Position + box.Size;
+    // already overlapping: resolve at t = 0 along the direction of least penetration
+    glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+    glm::vec2 difference = center - closest;
+    float distance2 = glm::dot(difference, difference);
+    if (distance2 < this->Radius * this->Radius)
+    {
+        if (distance2 > 0.0f)
+            normal = difference / std::sqrt(distance2);
+        else
+        {   // center inside the box, push out through the nearest face
+            glm::vec2 toMin = center - boxMin, toMax = boxMax - center;
+            float nearest = std::min(std::min(toMin.x, toMax.x), std::min(toMin.y, toMax.y));
+            normal = nearest == toMin.x ? glm::vec2(-1.0f, 0.0f) : nearest == toMax.x ? glm::vec2(1.0f, 0.0f)
+                   : nearest == toMin.y ? glm::vec2(0.0f, -1.0f) : glm::vec2(0.0f, 1.0f);
+        }
+        t = 0.0f;
+        return glm::dot(displacement, normal) < 0.0f;
+    }
+
+    // the swept circle hits the box where its center path enters the box grown by the radius (a rounded
+    // rectangle): the four faces pushed out by the radius, and a circle of that radius around each corner
+    bool hit = false;
+    t = 1.0f;
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (displacement[axis] == 0.0f)
+            continue;
+        int other = 1 - axis;
+        // only the face the ball moves towards can be entered
+        float plane = displacement[axis] > 0.0f ? boxMin[axis] - this->Radius : boxMax[axis] + this->Radius;
+        float tFace = (plane - center[axis]) / displacement[axis];
+        if (tFace < 0.0f || tFace > t)
+            continue;
+        float along = center[other] + displacement[other] * tFace;
+        if (along < boxMin[other] || along > boxMax[other])
+            continue;
+        hit = true;
+        t = tFace;
+        normal = glm::vec2(0.0f);
+        normal[axis] = displacement[axis] > 0.0f ? -1.0f : 1.0f;
+    }
+    float a = glm::dot(displacement, displacement);
+    if (a > 0.0f)
+    {
+        const glm::vec2 corners[4] = { boxMin, glm::vec2(boxMax.x, boxMin.y), boxMax, glm::vec2(boxMin.x, boxMax.y) };
+        for (const glm::vec2 &corner : corners)
+        {
+            // |center + displacement * s - corner| = radius, first root
+            glm::vec2 m = center - corner;
+            float b = glm::dot(m, displacement);
+            float c = glm::dot(m, m) - this->Radius * this->Radius;
+            if (b >= 0.0f)
+                continue; // moving away from the corner
+            float discriminant = b * b - a * c;
+            if (discriminant < 0.0f)
+                continue;
+            float tCorner = (-b - std::sqrt(discriminant)) / a;
+            if (tCorner < 0.0f || tCorner > t)
+                continue;
+            glm::vec2 contact = center + displacement * tCorner;
+            // a corner only counts outside the face regions, which the face tests above cover
+            bool outsideX = contact.x < boxMin.x || contact.x > boxMax.x;
+            bool outsideY = contact.y < boxMin.y || contact.y > boxMax.y;
+            if (!outsideX || !outsideY)
+                continue;
+            hit = true;
+            t = tCorner;
+            normal = (contact - corner) / this->Radius;
+        }
+    }
+    return hit;
+}
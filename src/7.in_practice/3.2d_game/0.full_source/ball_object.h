@@ -30,10 +30,11 @@ public:
     // constructor(s)
     BallObject();
     BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
-    // moves the ball, keeping it constrained within the window bounds (except bottom edge); returns new position
-    glm::vec2 Move(float dt, unsigned int window_width);
     // resets the ball to original state with given position and velocity
     void      Reset(glm::vec2 position, glm::vec2 velocity);
+    // sweeps the ball by displacement against box; on impact returns true with the time of impact
+    // t in [0, 1] and the surface normal at the contact point. Contacts the ball moves away from are ignored.
+    bool      Sweep(const GameObject &box, glm::vec2 displacement, float &t, glm::vec2 &normal) const;
 };
 
 #endif
\ No newline at end of file
@@ -8,40 +8,26 @@
 ******************************************************************/
 #include "game_level.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 
 
 void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
 {
-    // clear old data
-    this->Bricks.clear();
-    // load from file
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
-    {
-        while (std::getline(fstream, line)) // read each line from level file
-        {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode) // read each word separated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
-        }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
-    }
+    LevelData data;
+    ReadLevel(file, data);
+    this->Build(data, levelWidth, levelHeight);
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+void GameLevel::LoadStress(unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight)
+{
+    this->Build(GenerateStressLevel(columns, rows), levelWidth, levelHeight);
+}
+
+void GameLevel::Draw(SpriteBatch &batch, int layer)
 {
     for (GameObject &tile : this->Bricks)
         if (!tile.Destroyed)
-            tile.Draw(renderer);
+            tile.Draw(batch, layer);
 }
 
 bool GameLevel::IsCompleted()
@@ -52,41 +38,54 @@ bool GameLevel::IsCompleted()
     return true;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Build(const LevelData &data, unsigned int levelWidth, unsigned int levelHeight)
 {
+    // clear old data
+    this->Bricks.clear();
+    this->Grid.clear();
+    if (data.Width == 0 || data.Height == 0)
+        return;
     // calculate dimensions
-    unsigned int height = tileData.size();
-    unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
-    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height; 
-    // initialize level tiles based on tileData		
+    unsigned int height = data.Height;
+    unsigned int width = data.Width;
+    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / static_cast<float>(height);
+    // cells as large as a tile's longer edge, so a brick spans at most two cells per axis
+    this->Grid = SpatialHash<2>(std::max(unit_width, unit_height));
+    this->Bricks.reserve(data.Tiles.size() - std::count(data.Tiles.begin(), data.Tiles.end(), 0));
+    Texture2D solidTexture = ResourceManager::GetTexture("block_solid");
+    Texture2D blockTexture = ResourceManager::GetTexture("block");
+    // initialize level tiles based on tile data
     for (unsigned int y = 0; y < height; ++y)
     {
         for (unsigned int x = 0; x < width; ++x)
         {
             // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
+            unsigned char tile = data.At(x, y);
+            if (tile == 1) // solid
             {
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
+                GameObject obj(pos, size, solidTexture, glm::vec3(0.8f, 0.8f, 0.7f));
                 obj.IsSolid = true;
+                this->Grid.insert(this->Bricks.size(), SpatialBox<2>(pos, pos + size));
                 this->Bricks.push_back(obj);
             }
-            else if (tileData[y][x] > 1)	// non-solid; now determine its color based on level data
+            else if (tile > 1)	// non-solid; now determine its color based on level data
             {
                 glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
+                if (tile == 2)
                     color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
+                else if (tile == 3)
                     color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
+                else if (tile == 4)
                     color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
+                else if (tile == 5)
                     color = glm::vec3(1.0f, 0.5f, 0.0f);
 
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                this->Grid.insert(this->Bricks.size(), SpatialBox<2>(pos, pos + size));
+                this->Bricks.push_back(GameObject(pos, size, blockTexture, color));
             }
         }
     }
@@ -12,10 +12,12 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <learnopengl/spatial_index.h>
 
 #include "game_object.h"
-#include "sprite_renderer.h"
+#include "sprite_batch.h"
 #include "resource_manager.h"
+#include "level_file.h"
 
 
 /// GameLevel holds all Tiles as part of a Breakout level and 
@@ -25,17 +27,20 @@ class GameLevel
 public:
     // level state
     std::vector<GameObject> Bricks;
+    // broad phase over the remaining bricks, by brick index
+    SpatialHash<2>          Grid;
     // constructor
     GameLevel() { }
-    // loads level from file
+    // loads level from file (text .lvl or binary .blvl)
     void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+    // generates a synthetic columns x rows level for stress testing collisions
+    void LoadStress(unsigned int columns, unsigned int rows, unsigned int levelWidth, unsigned int levelHeight);
+    // creates the level's tiles from already loaded tile data
+    void Build(const LevelData &data, unsigned int levelWidth, unsigned int levelHeight);
     // render level
-    void Draw(SpriteRenderer &renderer);
+    void Draw(SpriteBatch &batch, int layer = 0);
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
-private:
-    // initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
 };
 
 #endif
\ No newline at end of file
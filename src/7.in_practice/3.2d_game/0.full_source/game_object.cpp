@@ -15,7 +15,7 @@ GameObject::GameObject()
 GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity) 
     : Position(pos), Size(size), Velocity(velocity), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false) { }
 
-void GameObject::Draw(SpriteRenderer &renderer)
+void GameObject::Draw(SpriteBatch &batch, int layer)
 {
-    renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
+    batch.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color, layer);
 }
\ No newline at end of file
@@ -13,7 +13,7 @@
 #include <glm/glm.hpp>
 
 #include "texture.h"
-#include "sprite_renderer.h"
+#include "sprite_batch.h"
 
 
 // Container object for holding all state relevant for a single
@@ -34,7 +34,7 @@ public:
     GameObject();
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
     // draw sprite
-    virtual void Draw(SpriteRenderer &renderer);
+    virtual void Draw(SpriteBatch &batch, int layer = 0);
 };
 
 #endif
\ No newline at end of file
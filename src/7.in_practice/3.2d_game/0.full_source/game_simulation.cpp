@@ -0,0 +1,610 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "game_simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+
+#include "resource_manager.h"
+
+
+// maximum number of impacts resolved for the ball within a single step
+const unsigned int MAX_BALL_IMPACTS = 8;
+// dimensions of the synthetic stress level
+const unsigned int STRESS_LEVEL_SIZE = 500;
+
+
+unsigned char GameInput::Pack() const
+{
+    return (this->Left ? 1 : 0) | (this->Right ? 2 : 0) | (this->Launch ? 4 : 0) |
+           (this->Confirm ? 8 : 0) | (this->NextLevel ? 16 : 0) | (this->PreviousLevel ? 32 : 0);
+}
+
+GameInput GameInput::Unpack(unsigned char bits)
+{
+    GameInput input;
+    input.Left = (bits & 1) != 0;
+    input.Right = (bits & 2) != 0;
+    input.Launch = (bits & 4) != 0;
+    input.Confirm = (bits & 8) != 0;
+    input.NextLevel = (bits & 16) != 0;
+    input.PreviousLevel = (bits & 32) != 0;
+    return input;
+}
+
+// file layout: "BKRP", uint32 seed, uint32 frame count, one byte per frame
+bool InputRecording::Save(const char *file) const
+{
+    std::ofstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    unsigned int count = static_cast<unsigned int>(this->Frames.size());
+    stream.write("BKRP", 4);
+    stream.write(reinterpret_cast<const char*>(&this->Seed), sizeof(this->Seed));
+    stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    stream.write(reinterpret_cast<const char*>(this->Frames.data()), count);
+    return static_cast<bool>(stream);
+}
+
+bool InputRecording::Load(const char *file)
+{
+    std::ifstream stream(file, std::ios::binary);
+    char magic[4];
+    unsigned int seed, count;
+    if (!stream.read(magic, 4) || std::memcmp(magic, "BKRP", 4) != 0)
+        return false;
+    if (!stream.read(reinterpret_cast<char*>(&seed), sizeof(seed)) || !stream.read(reinterpret_cast<char*>(&count), sizeof(count)))
+        return false;
+    std::vector<unsigned char> frames(count);
+    if (!stream.read(reinterpret_cast<char*>(frames.data()), count))
+        return false;
+    this->Seed = seed;
+    this->Frames.swap(frames);
+    return true;
+}
+
+
+// collision detection
+bool CheckCollision(GameObject &one, const PowerUp &two);
+Collision CheckCollision(BallObject &one, GameObject &two);
+Direction VectorDirection(glm::vec2 closest);
+
+
+GameSimulation::GameSimulation(unsigned int width, unsigned int height)
+    : State(GAME_MENU), Width(width), Height(height), Level(0), Lives(3), Shake(false), Confuse(false), Chaos(false),
+      CollisionChecks(0), BroadPhase(true), Steps(0), shakeTime(0.0f), powerUpGrid(POWERUP_SIZE.x), activePowerUps()
+{
+
+}
+
+void GameSimulation::LoadLevels(const std::vector<std::string> &files, bool stressLevel)
+{
+    // levels are only read once they are about to be played
+    std::vector<LevelStreamer::Source> sources;
+    for (const std::string &file : files)
+        sources.push_back([file](LevelData &level) { return ReadLevel(file, level); });
+    if (stressLevel)
+        sources.push_back([](LevelData &level) { level = GenerateStressLevel(STRESS_LEVEL_SIZE, STRESS_LEVEL_SIZE); return true; });
+    this->levels.SetSources(sources);
+    this->Levels.assign(sources.size(), GameLevel());
+}
+
+void GameSimulation::Init(unsigned int seed)
+{
+    for (GameLevel &level : this->Levels)
+        level = GameLevel();
+    this->selectLevel(0);
+    this->Lives = 3;
+    this->State = GAME_MENU;
+    this->PowerUps.Clear();
+    this->powerUpTimers.clear();
+    std::fill(std::begin(this->activePowerUps), std::end(this->activePowerUps), 0);
+    this->Events.clear();
+    this->CollisionChecks = 0;
+    this->Steps = 0;
+    this->shakeTime = 0.0f;
+    this->Shake = false;
+    this->random.seed(seed);
+    // resolve the textures once; without a renderer they stay empty
+    this->paddleTexture = ResourceManager::FindTexture("paddle");
+    this->ballTexture = ResourceManager::FindTexture("face");
+    for (unsigned int type = 0; type < POWERUP_TYPE_COUNT; ++type)
+        this->powerUpTextures[type] = ResourceManager::FindTexture(POWERUP_INFO[type].Texture);
+    // configure game objects
+    this->Player = GameObject(glm::vec2(0.0f), PLAYER_SIZE, ResourceManager::GetTexture(this->paddleTexture));
+    this->Ball = BallObject(glm::vec2(0.0f), BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture(this->ballTexture));
+    this->resetPlayer();
+}
+
+void GameSimulation::Step(const GameInput &input)
+{
+    const float dt = SIMULATION_TIMESTEP;
+    this->Events.clear();
+    this->CollisionChecks = 0;
+    this->processInput(input);
+    // move the ball, resolving its impacts along the way
+    this->moveBall(dt);
+    // check for collisions
+    this->doCollisions();
+    // update PowerUps
+    this->updatePowerUps(dt);
+    // reduce shake time
+    if (this->shakeTime > 0.0f)
+    {
+        this->shakeTime -= dt;
+        if (this->shakeTime <= 0.0f)
+            this->Shake = false;
+    }
+    // check loss condition
+    if (this->Ball.Position.y >= this->Height) // did ball reach bottom edge?
+    {
+        --this->Lives;
+        // did the player lose all his lives? : game over
+        if (this->Lives == 0)
+        {
+            this->resetLevel();
+            this->State = GAME_MENU;
+        }
+        this->resetPlayer();
+    }
+    // check win condition
+    if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
+    {
+        this->resetLevel();
+        this->resetPlayer();
+        this->Chaos = true;
+        this->State = GAME_WIN;
+    }
+    ++this->Steps;
+}
+
+// FNV-1a over everything that influences future steps
+unsigned long long GameSimulation::Checksum() const
+{
+    unsigned long long hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+    unsigned int scalars[] = { static_cast<unsigned int>(this->State), this->Level, this->Lives,
+                               this->Ball.Stuck, this->Ball.Sticky, this->Ball.PassThrough, this->Shake, this->Confuse, this->Chaos };
+    mix(scalars, sizeof(scalars));
+    mix(&this->Ball.Position, sizeof(glm::vec2));
+    mix(&this->Ball.Velocity, sizeof(glm::vec2));
+    mix(&this->Player.Position, sizeof(glm::vec2));
+    mix(&this->Player.Size, sizeof(glm::vec2));
+    for (const GameObject &brick : this->Levels[this->Level].Bricks)
+        mix(&brick.Destroyed, sizeof(bool));
+    for (const PowerUp &powerUp : this->PowerUps)
+    {
+        mix(&powerUp.Type, sizeof(PowerUpType));
+        mix(&powerUp.Position, sizeof(glm::vec2));
+    }
+    for (const PowerUpTimer &timer : this->powerUpTimers)
+    {
+        mix(&timer.Type, sizeof(PowerUpType));
+        mix(&timer.Expiry, sizeof(unsigned long long));
+    }
+    return hash;
+}
+
+void GameSimulation::processInput(const GameInput &input)
+{
+    const float dt = SIMULATION_TIMESTEP;
+    if (this->State == GAME_MENU)
+    {
+        if (input.Confirm)
+            this->State = GAME_ACTIVE;
+        if (input.NextLevel)
+            this->selectLevel((this->Level + 1) % this->Levels.size());
+        if (input.PreviousLevel)
+        {
+            if (this->Level > 0)
+                this->selectLevel(this->Level - 1);
+            else
+                this->selectLevel(this->Levels.size() - 1);
+        }
+    }
+    if (this->State == GAME_WIN)
+    {
+        if (input.Confirm)
+        {
+            this->Chaos = false;
+            this->State = GAME_MENU;
+        }
+    }
+    if (this->State == GAME_ACTIVE)
+    {
+        float velocity = PLAYER_VELOCITY * dt;
+        // move playerboard
+        if (input.Left)
+        {
+            if (this->Player.Position.x >= 0.0f)
+            {
+                this->Player.Position.x -= velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x -= velocity;
+            }
+        }
+        if (input.Right)
+        {
+            if (this->Player.Position.x <= this->Width - this->Player.Size.x)
+            {
+                this->Player.Position.x += velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x += velocity;
+            }
+        }
+        if (input.Launch)
+            this->Ball.Stuck = false;
+    }
+}
+
+void GameSimulation::moveBall(float dt)
+{
+    BallObject &ball = this->Ball;
+    if (ball.Stuck)
+        return;
+    GameLevel &level = this->Levels[this->Level];
+    // advance to the earliest impact, respond, and continue with the remaining time
+    float remaining = dt;
+    for (unsigned int impact = 0; impact < MAX_BALL_IMPACTS && remaining > 0.0f; ++impact)
+    {
+        glm::vec2 displacement = ball.Velocity * remaining;
+        float t = 1.0f;
+        glm::vec2 normal(0.0f);
+        int hitBrick = -1;
+        bool hitWall = false;
+        // window edges (the bottom edge is open)
+        if (displacement.x < 0.0f && -ball.Position.x / displacement.x < t)
+        {
+            t = std::max(-ball.Position.x / displacement.x, 0.0f);
+            normal = glm::vec2(1.0f, 0.0f);
+            hitWall = true;
+        }
+        else if (displacement.x > 0.0f && (this->Width - ball.Size.x - ball.Position.x) / displacement.x < t)
+        {
+            t = std::max((this->Width - ball.Size.x - ball.Position.x) / displacement.x, 0.0f);
+            normal = glm::vec2(-1.0f, 0.0f);
+            hitWall = true;
+        }
+        if (displacement.y < 0.0f && -ball.Position.y / displacement.y < t)
+        {
+            t = std::max(-ball.Position.y / displacement.y, 0.0f);
+            normal = glm::vec2(0.0f, 1.0f);
+            hitWall = true;
+        }
+        // broad phase: only the bricks overlapping the box around this sweep
+        glm::vec2 end = ball.Position + displacement;
+        this->candidates.clear();
+        if (this->BroadPhase)
+            level.Grid.queryBox(SpatialBox<2>(glm::min(ball.Position, end), glm::max(ball.Position, end) + 2.0f * ball.Radius),
+                                [this](unsigned int index) { this->candidates.push_back(index); });
+        else
+            for (unsigned int index = 0; index < level.Bricks.size(); ++index)
+                this->candidates.push_back(index);
+        // on ties the lowest brick index wins, like testing the whole level in order would
+        std::sort(this->candidates.begin(), this->candidates.end());
+        for (unsigned int index : this->candidates)
+        {
+            GameObject &box = level.Bricks[index];
+            // don't stop at non-solid bricks if pass-through is activated, they are destroyed below
+            if (box.Destroyed || (ball.PassThrough && !box.IsSolid))
+                continue;
+            ++this->CollisionChecks;
+            float tBrick;
+            glm::vec2 brickNormal;
+            if (ball.Sweep(box, displacement, tBrick, brickNormal) && tBrick < t)
+            {
+                t = tBrick;
+                normal = brickNormal;
+                hitBrick = index;
+                hitWall = false;
+            }
+        }
+        // destroy the non-solid bricks passed through on the way to the impact
+        if (ball.PassThrough)
+        {
+            for (unsigned int index : this->candidates)
+            {
+                GameObject &box = level.Bricks[index];
+                if (box.Destroyed || box.IsSolid)
+                    continue;
+                ++this->CollisionChecks;
+                float tBrick;
+                glm::vec2 brickNormal;
+                if (ball.Sweep(box, displacement, tBrick, brickNormal) && tBrick <= t)
+                {
+                    box.Destroyed = true;
+                    level.Grid.remove(index);
+                    this->spawnPowerUps(box);
+                    this->Events.push_back(EVENT_BRICK_DESTROYED);
+                }
+            }
+        }
+        ball.Position += displacement * t;
+        if (hitBrick < 0 && !hitWall)
+            break;
+        if (hitBrick >= 0)
+        {
+            GameObject &box = level.Bricks[hitBrick];
+            // destroy block if not solid
+            if (!box.IsSolid)
+            {
+                box.Destroyed = true;
+                level.Grid.remove(hitBrick);
+                this->spawnPowerUps(box);
+                this->Events.push_back(EVENT_BRICK_DESTROYED);
+            }
+            else
+            {   // if block is solid, enable shake effect
+                this->shakeTime = 0.05f;
+                this->Shake = true;
+                this->Events.push_back(EVENT_SOLID_HIT);
+            }
+        }
+        // reflect the velocity about the contact normal (a plain axis flip on faces and walls)
+        ball.Velocity -= 2.0f * glm::dot(ball.Velocity, normal) * normal;
+        remaining -= remaining * t;
+    }
+}
+
+void GameSimulation::doCollisions()
+{
+    // check collisions on PowerUps and if so, activate them
+    this->powerUpGrid.clear();
+    for (unsigned int i = 0; i < this->PowerUps.Size(); )
+    {
+        // first check if powerup passed bottom edge, if so: remove it (the last one moves into its place)
+        if (this->PowerUps[i].Position.y >= this->Height)
+            this->PowerUps.Remove(i);
+        else
+        {
+            this->powerUpGrid.insert(i, SpatialBox<2>(this->PowerUps[i].Position, this->PowerUps[i].Position + POWERUP_SIZE));
+            ++i;
+        }
+    }
+    this->candidates.clear();
+    if (this->BroadPhase)
+        this->powerUpGrid.queryBox(SpatialBox<2>(this->Player.Position, this->Player.Position + this->Player.Size),
+                                   [this](unsigned int index) { this->candidates.push_back(index); });
+    else
+        for (unsigned int index = 0; index < this->PowerUps.Size(); ++index)
+            this->candidates.push_back(index);
+    // collect simultaneous pickups in the order they spawned
+    std::sort(this->candidates.begin(), this->candidates.end(), [this](unsigned int a, unsigned int b)
+    {
+        return this->PowerUps[a].Serial < this->PowerUps[b].Serial;
+    });
+    unsigned int collected = 0;
+    for (unsigned int index : this->candidates)
+    {
+        ++this->CollisionChecks;
+        if (CheckCollision(this->Player, this->PowerUps[index]))
+        {	// collided with player, now activate powerup
+            this->activatePowerUp(this->PowerUps[index].Type);
+            this->Events.push_back(EVENT_POWERUP_ACTIVATED);
+            this->candidates[collected++] = index;
+        }
+    }
+    // remove the collected ones, highest index first so the remaining indices stay valid
+    std::sort(this->candidates.begin(), this->candidates.begin() + collected, std::greater<unsigned int>());
+    for (unsigned int i = 0; i < collected; ++i)
+        this->PowerUps.Remove(this->candidates[i]);
+
+    // and finally check collisions for player pad (unless stuck)
+    Collision result = CheckCollision(this->Ball, this->Player);
+    if (!this->Ball.Stuck && std::get<0>(result))
+    {
+        // check where it hit the board, and change velocity based on where it hit the board
+        float centerBoard = this->Player.Position.x + this->Player.Size.x / 2.0f;
+        float distance = (this->Ball.Position.x + this->Ball.Radius) - centerBoard;
+        float percentage = distance / (this->Player.Size.x / 2.0f);
+        // then move accordingly
+        float strength = 2.0f;
+        glm::vec2 oldVelocity = this->Ball.Velocity;
+        this->Ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+        this->Ball.Velocity = glm::normalize(this->Ball.Velocity) * glm::length(oldVelocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+        // fix sticky paddle
+        this->Ball.Velocity.y = -1.0f * std::abs(this->Ball.Velocity.y);
+
+        // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+        this->Ball.Stuck = this->Ball.Sticky;
+
+        this->Events.push_back(EVENT_PADDLE_HIT);
+    }
+}
+
+void GameSimulation::updatePowerUps(float dt)
+{
+    for (unsigned int i = 0; i < this->PowerUps.Size(); ++i)
+        this->PowerUps[i].Position += VELOCITY * dt;
+    // effects whose time is up wear off once no other power-up of their type is active
+    while (!this->powerUpTimers.empty() && this->powerUpTimers.front().Expiry <= this->Steps)
+    {
+        PowerUpType type = this->powerUpTimers.front().Type;
+        std::pop_heap(this->powerUpTimers.begin(), this->powerUpTimers.end(), std::greater<PowerUpTimer>());
+        this->powerUpTimers.pop_back();
+        if (--this->activePowerUps[type] == 0)
+            this->deactivatePowerUp(type);
+    }
+}
+
+void GameSimulation::resetLevel()
+{
+    this->Levels[this->Level].Build(this->levels.Get(this->Level), this->Width, this->Height / 2);
+    this->Lives = 3;
+}
+
+void GameSimulation::selectLevel(unsigned int index)
+{
+    // only the level being played is kept in memory as bricks
+    if (index != this->Level && this->Level < this->Levels.size())
+        this->Levels[this->Level] = GameLevel();
+    this->Level = index;
+    this->Levels[index].Build(this->levels.Get(index), this->Width, this->Height / 2);
+    // read the level that is most likely selected next while this one is played
+    this->levels.Prefetch((index + 1) % this->Levels.size());
+}
+
+void GameSimulation::resetPlayer()
+{
+    // reset player/ball stats
+    this->Player.Size = PLAYER_SIZE;
+    this->Player.Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    this->Ball.Reset(this->Player.Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+    // also disable all active powerups
+    this->Chaos = this->Confuse = false;
+    this->Ball.PassThrough = this->Ball.Sticky = false;
+    this->Player.Color = glm::vec3(1.0f);
+    this->Ball.Color = glm::vec3(1.0f);
+}
+
+bool GameSimulation::shouldSpawn(unsigned int chance)
+{
+    unsigned int random = this->random() % chance;
+    return random == 0;
+}
+
+void GameSimulation::spawnPowerUps(GameObject &block)
+{
+    for (unsigned int type = 0; type < POWERUP_TYPE_COUNT; ++type)
+        if (this->shouldSpawn(POWERUP_INFO[type].Chance))
+            this->PowerUps.Spawn(static_cast<PowerUpType>(type), block.Position);
+}
+
+void GameSimulation::SpawnPowerUp(PowerUpType type, glm::vec2 position)
+{
+    this->PowerUps.Spawn(type, position);
+}
+
+void GameSimulation::activatePowerUp(PowerUpType type)
+{
+    if (type == POWERUP_SPEED)
+    {
+        this->Ball.Velocity *= 1.2;
+    }
+    else if (type == POWERUP_STICKY)
+    {
+        this->Ball.Sticky = true;
+        this->Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
+    }
+    else if (type == POWERUP_PASS_THROUGH)
+    {
+        this->Ball.PassThrough = true;
+        this->Ball.Color = glm::vec3(1.0f, 0.5f, 0.5f);
+    }
+    else if (type == POWERUP_PAD_SIZE_INCREASE)
+    {
+        this->Player.Size.x += 50;
+    }
+    else if (type == POWERUP_CONFUSE)
+    {
+        if (!this->Chaos)
+            this->Confuse = true; // only activate if chaos wasn't already active
+    }
+    else if (type == POWERUP_CHAOS)
+    {
+        if (!this->Confuse)
+            this->Chaos = true;
+    }
+    // lasting effects wear off after their duration, counted from (and including) this step
+    float duration = POWERUP_INFO[type].Duration;
+    if (duration > 0.0f)
+    {
+        unsigned long long steps = static_cast<unsigned long long>(std::ceil(duration / SIMULATION_TIMESTEP));
+        PowerUpTimer timer = { this->Steps + steps - 1, type };
+        this->powerUpTimers.push_back(timer);
+        std::push_heap(this->powerUpTimers.begin(), this->powerUpTimers.end(), std::greater<PowerUpTimer>());
+        ++this->activePowerUps[type];
+    }
+}
+
+void GameSimulation::deactivatePowerUp(PowerUpType type)
+{
+    if (type == POWERUP_STICKY)
+    {
+        this->Ball.Sticky = false;
+        this->Player.Color = glm::vec3(1.0f);
+    }
+    else if (type == POWERUP_PASS_THROUGH)
+    {
+        this->Ball.PassThrough = false;
+        this->Ball.Color = glm::vec3(1.0f);
+    }
+    else if (type == POWERUP_CONFUSE)
+    {
+        this->Confuse = false;
+    }
+    else if (type == POWERUP_CHAOS)
+    {
+        this->Chaos = false;
+    }
+}
+
+bool CheckCollision(GameObject &one, const PowerUp &two) // AABB - AABB collision
+{
+    // collision x-axis?
+    bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
+        two.Position.x + POWERUP_SIZE.x >= one.Position.x;
+    // collision y-axis?
+    bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
+        two.Position.y + POWERUP_SIZE.y >= one.Position.y;
+    // collision only if on both axes
+    return collisionX && collisionY;
+}
+Collision CheckCollision(BallObject &one, GameObject &two) // AABB - Circle collision
+{
+    // get center point circle first 
+    glm::vec2 center(one.Position + one.Radius);
+    // calculate AABB info (center, half-extents)
+    glm::vec2 aabb_half_extents(two.Size.x / 2.0f, two.Size.y / 2.0f);
+    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
+    // get difference vector between both centers
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+    // now that we know the the clamped values, add this to AABB_center and we get the value of box closest to circle
+    glm::vec2 closest = aabb_center + clamped;
+    // now retrieve vector between center circle and closest point AABB and check if length < radius
+    difference = closest - center;
+    
+    if (glm::length(difference) < one.Radius) // not <= since in that case a collision also occurs when object one exactly touches object two, which they are at the end of each collision resolution stage.
+        return std::make_tuple(true, VectorDirection(difference), difference);
+    else
+        return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+}
+
+// calculates which direction a vector is facing (N,E,S or W)
+Direction VectorDirection(glm::vec2 target)
+{
+    glm::vec2 compass[] = {
+        glm::vec2(0.0f, 1.0f),	// up
+        glm::vec2(1.0f, 0.0f),	// right
+        glm::vec2(0.0f, -1.0f),	// down
+        glm::vec2(-1.0f, 0.0f)	// left
+    };
+    float max = 0.0f;
+    unsigned int best_match = -1;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        float dot_product = glm::dot(glm::normalize(target), compass[i]);
+        if (dot_product > max)
+        {
+            max = dot_product;
+            best_match = i;
+        }
+    }
+    return (Direction)best_match;
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_SIMULATION_H
+#define GAME_SIMULATION_H
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "game_level.h"
+#include "game_object.h"
+#include "ball_object.h"
+#include "power_up.h"
+#include "level_file.h"
+#include "resource_manager.h"
+
+// Represents the current state of the game
+enum GameState {
+    GAME_ACTIVE,
+    GAME_MENU,
+    GAME_WIN
+};
+
+// Represents the four possible (collision) directions
+enum Direction {
+    UP,
+    RIGHT,
+    DOWN,
+    LEFT
+};
+// Defines a Collision typedef that represents collision data
+typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
+
+// Initial size of the player paddle
+const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
+// Initial velocity of the player paddle
+const float PLAYER_VELOCITY(500.0f);
+// Initial velocity of the Ball
+const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+// Radius of the ball object
+const float BALL_RADIUS = 12.5f;
+// Duration of a single simulation step
+const float SIMULATION_TIMESTEP = 1.0f / 120.0f;
+
+// Input for a single simulation step. The held controls are sampled
+// every step; the others are only true on the step their key went down.
+struct GameInput
+{
+    bool Left = false, Right = false, Launch = false;
+    bool Confirm = false, NextLevel = false, PreviousLevel = false;
+    // one byte per step in recordings
+    unsigned char Pack() const;
+    static GameInput Unpack(unsigned char bits);
+};
+
+// A recorded input stream together with the seed it was played with;
+// replaying it reproduces the game exactly.
+struct InputRecording
+{
+    unsigned int               Seed = 0;
+    std::vector<unsigned char> Frames;
+    // writes/reads the recording as a small binary file; returns false on failure
+    bool Save(const char *file) const;
+    bool Load(const char *file);
+};
+
+// Things that happened during a step that the presentation layer
+// (audio, screen effects) may want to react to.
+enum GameEvent {
+    EVENT_BRICK_DESTROYED,
+    EVENT_SOLID_HIT,
+    EVENT_POWERUP_ACTIVATED,
+    EVENT_PADDLE_HIT
+};
+
+// GameSimulation holds all of Breakout's game logic: levels, paddle,
+// ball, power-ups and collisions. It advances in fixed steps driven by
+// GameInput, draws randomness from a seeded generator and touches no
+// rendering, audio or windowing code, so identical seeds and inputs
+// always produce identical games and it can run without a GPU.
+class GameSimulation
+{
+public:
+    // game state
+    GameState               State;
+    unsigned int            Width, Height;
+    // only Levels[Level] holds bricks, the others are empty until selected
+    std::vector<GameLevel>  Levels;
+    // falling power-ups; collected ones only live on as timers
+    PowerUpPool             PowerUps;
+    unsigned int            Level;
+    unsigned int            Lives;
+    GameObject              Player;
+    BallObject              Ball;
+    // screen effects requested by the game logic
+    bool                    Shake, Confuse, Chaos;
+    // events of the last step
+    std::vector<GameEvent>  Events;
+    // narrow phase collision tests during the last step
+    unsigned int            CollisionChecks;
+    // query the broad phase grids; off, every brick and power-up is tested (for comparison)
+    bool                    BroadPhase;
+    // number of steps since Init
+    unsigned long long      Steps;
+    // constructor
+    GameSimulation(unsigned int width, unsigned int height);
+    // loads the levels, optionally followed by the synthetic stress level
+    void LoadLevels(const std::vector<std::string> &files, bool stressLevel = false);
+    // resets the game (levels included) and reseeds its random generator
+    void Init(unsigned int seed = 0);
+    // advances the game by SIMULATION_TIMESTEP
+    void Step(const GameInput &input);
+    // hash of the complete game state, for comparing runs
+    unsigned long long Checksum() const;
+    // drops a power-up from position (bricks do this when destroyed)
+    void SpawnPowerUp(PowerUpType type, glm::vec2 position);
+    // whether the effect of a collected power-up of this type is active
+    bool IsPowerUpActive(PowerUpType type) const { return this->activePowerUps[type] > 0; }
+    // number of collected power-ups whose effect is still active
+    unsigned int ActivePowerUps() const { return static_cast<unsigned int>(this->powerUpTimers.size()); }
+    // texture of a power-up type
+    TextureHandle PowerUpTexture(PowerUpType type) const { return this->powerUpTextures[type]; }
+private:
+    std::mt19937             random;
+    float                    shakeTime;
+    // tile data of the levels, read on first use; resets rebuild the bricks from it
+    LevelStreamer            levels;
+    // power-ups bucketed by screen cell, rebuilt every step
+    SpatialHash<2>           powerUpGrid;
+    // candidate indices returned by the broad phase, reused between queries
+    std::vector<unsigned int> candidates;
+    // textures of the objects the simulation creates, resolved once in Init
+    TextureHandle            paddleTexture, ballTexture;
+    TextureHandle            powerUpTextures[POWERUP_TYPE_COUNT];
+    // active power-up effects: a min-heap on expiry and the number active per type
+    std::vector<PowerUpTimer> powerUpTimers;
+    unsigned int             activePowerUps[POWERUP_TYPE_COUNT];
+    // game loop stages
+    void processInput(const GameInput &input);
+    void moveBall(float dt);
+    void doCollisions();
+    void updatePowerUps(float dt);
+    // reset
+    void resetLevel();
+    void resetPlayer();
+    // makes index the current level, building its bricks from the tile data
+    void selectLevel(unsigned int index);
+    // powerups
+    bool shouldSpawn(unsigned int chance);
+    void spawnPowerUps(GameObject &block);
+    void activatePowerUp(PowerUpType type);
+    void deactivatePowerUp(PowerUpType type);
+};
+
+#endif
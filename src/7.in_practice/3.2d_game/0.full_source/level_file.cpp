@@ -0,0 +1,287 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "level_file.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+// header of a binary level file
+struct BinaryLevelHeader
+{
+    char         Magic[4];
+    unsigned int Version, Width, Height;
+};
+const unsigned int BINARY_LEVEL_VERSION = 1;
+
+// A read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    const unsigned char *Data;
+    size_t               Size;
+    MappedFile(const std::string &file);
+    ~MappedFile();
+private:
+#ifdef _WIN32
+    HANDLE file, mapping;
+#else
+    int file;
+#endif
+};
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path)
+    : Data(nullptr), Size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr)
+{
+    this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (this->file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(this->file, &size) || size.QuadPart == 0)
+        return;
+    this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!this->mapping)
+        return;
+    this->Data = static_cast<const unsigned char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (this->Data)
+        this->Size = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (this->Data)
+        UnmapViewOfFile(this->Data);
+    if (this->mapping)
+        CloseHandle(this->mapping);
+    if (this->file != INVALID_HANDLE_VALUE)
+        CloseHandle(this->file);
+}
+
+// last write time of a file, false if it does not exist
+static bool ModifiedTime(const std::string &path, unsigned long long &time)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &info))
+        return false;
+    time = (static_cast<unsigned long long>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+    : Data(nullptr), Size(0), file(-1)
+{
+    this->file = open(path.c_str(), O_RDONLY);
+    if (this->file < 0)
+        return;
+    struct stat info;
+    if (fstat(this->file, &info) != 0 || info.st_size == 0)
+        return;
+    void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, this->file, 0);
+    if (data == MAP_FAILED)
+        return;
+    this->Data = static_cast<const unsigned char*>(data);
+    this->Size = static_cast<size_t>(info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (this->Data)
+        munmap(const_cast<unsigned char*>(this->Data), this->Size);
+    if (this->file >= 0)
+        close(this->file);
+}
+
+// last write time of a file, false if it does not exist
+static bool ModifiedTime(const std::string &path, unsigned long long &time)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return false;
+    time = static_cast<unsigned long long>(info.st_mtime);
+    return true;
+}
+#endif
+
+
+bool ReadLevel(const std::string &file, LevelData &level)
+{
+    size_t extension = sizeof(BINARY_LEVEL_EXTENSION) - 1;
+    if (file.size() >= extension && file.compare(file.size() - extension, extension, BINARY_LEVEL_EXTENSION) == 0)
+        return ReadBinaryLevel(file, level);
+    // a converted copy of a text level takes precedence, unless the text
+    // level was edited after the conversion
+    std::string binary = BinaryLevelPath(file);
+    unsigned long long textTime, binaryTime;
+    bool stale = ModifiedTime(file, textTime) && ModifiedTime(binary, binaryTime) && textTime > binaryTime;
+    if (!stale && ReadBinaryLevel(binary, level))
+        return true;
+    return ReadTextLevel(file, level);
+}
+
+std::string BinaryLevelPath(const std::string &file)
+{
+    size_t dot = file.find_last_of('.');
+    size_t slash = file.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return file + BINARY_LEVEL_EXTENSION;
+    return file.substr(0, dot) + BINARY_LEVEL_EXTENSION;
+}
+
+bool ReadTextLevel(const std::string &file, LevelData &level)
+{
+    level = LevelData();
+    // map the whole file and scan it by hand; rows are as wide as the first one
+    MappedFile mapped(file);
+    if (!mapped.Data)
+        return false;
+    const unsigned char *c = mapped.Data, *end = mapped.Data + mapped.Size;
+    unsigned int column = 0;
+    while (c < end)
+    {
+        if (*c >= '0' && *c <= '9')
+        {
+            unsigned int code = 0;
+            for (; c < end && *c >= '0' && *c <= '9'; ++c)
+                code = code * 10 + (*c - '0');
+            if (level.Height == 0)
+                level.Tiles.push_back(static_cast<unsigned char>(code > 255 ? 255 : code));
+            else if (column < level.Width)
+                level.Tiles[level.Height * level.Width + column] = static_cast<unsigned char>(code > 255 ? 255 : code);
+            ++column;
+        }
+        else if (*c++ == '\n' && column > 0)
+        {
+            // end of a (non-empty) row
+            if (level.Height == 0)
+                level.Width = column;
+            ++level.Height;
+            level.Tiles.resize((level.Height + 1) * level.Width, 0);
+            column = 0;
+        }
+    }
+    if (column > 0)
+    {
+        if (level.Height == 0)
+            level.Width = column;
+        ++level.Height;
+    }
+    level.Tiles.resize(level.Height * level.Width);
+    return level.Width > 0;
+}
+
+bool ReadBinaryLevel(const std::string &file, LevelData &level)
+{
+    level = LevelData();
+    MappedFile mapped(file);
+    BinaryLevelHeader header;
+    if (mapped.Size < sizeof(header))
+        return false;
+    std::memcpy(&header, mapped.Data, sizeof(header));
+    if (std::memcmp(header.Magic, "BLVL", 4) != 0 || header.Version != BINARY_LEVEL_VERSION ||
+        header.Width == 0 || mapped.Size - sizeof(header) < static_cast<size_t>(header.Width) * header.Height)
+        return false;
+    level.Width = header.Width;
+    level.Height = header.Height;
+    level.Tiles.assign(mapped.Data + sizeof(header), mapped.Data + sizeof(header) + static_cast<size_t>(header.Width) * header.Height);
+    return true;
+}
+
+bool WriteBinaryLevel(const std::string &file, const LevelData &level)
+{
+    FILE *stream = std::fopen(file.c_str(), "wb");
+    if (!stream)
+        return false;
+    BinaryLevelHeader header = { { 'B', 'L', 'V', 'L' }, BINARY_LEVEL_VERSION, level.Width, level.Height };
+    bool written = std::fwrite(&header, sizeof(header), 1, stream) == 1 &&
+                   std::fwrite(level.Tiles.data(), 1, level.Tiles.size(), stream) == level.Tiles.size();
+    return std::fclose(stream) == 0 && written;
+}
+
+LevelData GenerateStressLevel(unsigned int columns, unsigned int rows)
+{
+    LevelData level;
+    level.Width = columns;
+    level.Height = rows;
+    level.Tiles.resize(columns * rows);
+    for (unsigned int y = 0; y < rows; ++y)
+        for (unsigned int x = 0; x < columns; ++x)
+            level.Tiles[y * columns + x] = (x * 7 + y * 13) % 31 == 0 ? 1 : 2 + (x + y) % 4;
+    return level;
+}
+
+
+LevelStreamer::LevelStreamer()
+    : Prefetched(0)
+{
+
+}
+
+LevelStreamer::~LevelStreamer()
+{
+    for (Entry &entry : this->entries)
+        if (entry.Pending.valid())
+            entry.Pending.wait();
+}
+
+void LevelStreamer::SetSources(const std::vector<Source> &sources)
+{
+    for (Entry &entry : this->entries)
+        if (entry.Pending.valid())
+            entry.Pending.wait();
+    this->entries.clear();
+    this->entries.resize(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i)
+        this->entries[i].Load = sources[i];
+}
+
+void LevelStreamer::Prefetch(unsigned int index)
+{
+    if (index >= this->entries.size())
+        return;
+    Entry &entry = this->entries[index];
+    if (entry.Ready || entry.Pending.valid())
+        return;
+    Source load = entry.Load;
+    entry.Pending = std::async(std::launch::async, [load]()
+    {
+        LevelData level;
+        if (!load(level))
+            level = LevelData();
+        return level;
+    });
+}
+
+const LevelData& LevelStreamer::Get(unsigned int index)
+{
+    Entry &entry = this->entries[index];
+    if (!entry.Ready)
+    {
+        if (entry.Pending.valid())
+        {
+            entry.Data = entry.Pending.get();
+            ++this->Prefetched;
+        }
+        else if (!entry.Load(entry.Data))
+            entry.Data = LevelData();
+        entry.Ready = true;
+    }
+    return entry.Data;
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef LEVEL_FILE_H
+#define LEVEL_FILE_H
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+
+// The tile codes of a level, row by row (0: empty, 1: solid, 2-5: colored).
+struct LevelData
+{
+    unsigned int               Width = 0, Height = 0;
+    std::vector<unsigned char> Tiles;
+    // tile code at column x, row y
+    unsigned char At(unsigned int x, unsigned int y) const { return this->Tiles[y * this->Width + x]; }
+};
+
+// Binary levels (.blvl) are a 16 byte header ("BLVL", version, width,
+// height as 32-bit little endian integers) followed by one byte per
+// tile, row by row. They are memory mapped instead of parsed.
+const char BINARY_LEVEL_EXTENSION[] = ".blvl";
+
+// reads a level as text (.lvl: whitespace separated codes, one row per line) or binary (.blvl), by
+// extension; for a text level its converted binary version is read instead if there is one that
+// is not older than the text file
+bool ReadLevel(const std::string &file, LevelData &level);
+// path of the binary version of a level file (the extension replaced by .blvl)
+std::string BinaryLevelPath(const std::string &file);
+// reads a text level
+bool ReadTextLevel(const std::string &file, LevelData &level);
+// reads a binary level through a read-only memory mapping
+bool ReadBinaryLevel(const std::string &file, LevelData &level);
+// writes a binary level
+bool WriteBinaryLevel(const std::string &file, const LevelData &level);
+// generates a synthetic columns x rows level, mostly breakable bricks with a sprinkling of solid ones
+LevelData GenerateStressLevel(unsigned int columns, unsigned int rows);
+
+
+// LevelStreamer hands out levels by index, reading each one only when
+// it is first needed. Reading and parsing can also be started ahead of
+// time on a worker thread (Prefetch), so that switching to the next
+// level doesn't wait for the disk. Only the tile data is produced off
+// the main thread; callers turn it into bricks.
+class LevelStreamer
+{
+public:
+    // produces the tile data of one level; runs on a worker thread when prefetched
+    typedef std::function<bool(LevelData&)> Source;
+    // number of levels that were read before they were needed
+    unsigned int Prefetched;
+    // constructor
+    LevelStreamer();
+    // waits for background reads still in flight
+    ~LevelStreamer();
+    // replaces all levels; nothing is read yet
+    void SetSources(const std::vector<Source> &sources);
+    unsigned int Count() const { return static_cast<unsigned int>(this->entries.size()); }
+    // starts reading level index in the background unless it is already read or being read
+    void Prefetch(unsigned int index);
+    // tile data of level index, reading it now (or waiting for the prefetch) if needed; empty if it failed to load
+    const LevelData& Get(unsigned int index);
+private:
+    struct Entry
+    {
+        Source                  Load;
+        bool                    Ready = false;
+        LevelData               Data;
+        std::future<LevelData>  Pending;
+    };
+    std::vector<Entry> entries;
+};
+
+#endif
\ No newline at end of file
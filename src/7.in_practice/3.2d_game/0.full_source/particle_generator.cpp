@@ -8,59 +8,360 @@
 ******************************************************************/
 #include "particle_generator.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PARTICLES_USE_SSE 1
+#else
+#define PARTICLES_USE_SSE 0
+#endif
+
+// how fast a particle fades out, in alpha per second
+const float PARTICLE_FADE_RATE = 2.5f;
+// local size of the compute shader
+const unsigned int PARTICLE_GROUP_SIZE = 64;
+
+// compute back end stages (must match particles.cs)
+enum ParticleStage {
+    STAGE_EMIT,
+    STAGE_PREPARE,
+    STAGE_SIMULATE,
+    STAGE_FINALIZE
+};
+
+// std430 layout of a particle in particles.cs
+struct GPUParticle {
+    glm::vec2 Position, Velocity;
+    glm::vec4 Color;
+    float     Life;
+    float     padding[3];
+};
+
+// std430 layout of the control buffer in particles.cs; also serves as dispatch and draw indirect buffer
+struct GPUParticleControl {
+    int          DeadCount;
+    unsigned int AliveCount[2];
+    unsigned int padding0;
+    unsigned int DispatchArgs[3];  // num_groups_x/y/z for glDispatchComputeIndirect
+    unsigned int padding1;
+    unsigned int DrawArgs[4];      // count, instanceCount, first, baseInstance for glDrawArraysIndirect
+};
+
+
+static unsigned int hashParticle(unsigned int x)
+{
+    x ^= x >> 16; x *= 0x7feb352du;
+    x ^= x >> 15; x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+unsigned int ParticleRandom(unsigned int seed, unsigned int n, unsigned int channel)
+{
+    return hashParticle(seed ^ hashParticle(n * 2u + channel));
+}
+
+
+bool ParticleStats::Matches(const ParticleStats &other, float tolerance) const
+{
+    auto close = [tolerance](float a, float b) { return std::abs(a - b) <= tolerance * std::max(1.0f, std::abs(a)); };
+    return this->Count == other.Count && close(this->MeanPosition.x, other.MeanPosition.x) && close(this->MeanPosition.y, other.MeanPosition.y) &&
+           close(this->MeanAlpha, other.MeanAlpha) && close(this->MeanLife, other.MeanLife);
+}
+
+
+ParticlePool::ParticlePool(unsigned int capacity)
+    : PositionX(capacity), PositionY(capacity), VelocityX(capacity), VelocityY(capacity),
+      ColorR(capacity), ColorG(capacity), ColorB(capacity), ColorA(capacity), Life(capacity),
+      Count(0), capacity(capacity), recycle(0)
+{
+
+}
+
+void ParticlePool::Spawn(glm::vec2 position, glm::vec2 velocity, glm::vec4 color, float life)
+{
+    if (this->capacity == 0)
+        return;
+    unsigned int i;
+    if (this->Count < this->capacity)
+        i = this->Count++;
+    else
+    {
+        // all particles are taken, override one (if this happens a lot, more particles should be reserved)
+        i = this->recycle;
+        this->recycle = (this->recycle + 1) % this->capacity;
+    }
+    this->PositionX[i] = position.x; this->PositionY[i] = position.y;
+    this->VelocityX[i] = velocity.x; this->VelocityY[i] = velocity.y;
+    this->ColorR[i] = color.r; this->ColorG[i] = color.g; this->ColorB[i] = color.b; this->ColorA[i] = color.a;
+    this->Life[i] = life;
+}
+
+void ParticlePool::Update(float dt)
+{
+    unsigned int i = 0;
+    // integrate every live particle; dead ones are updated as well and removed afterwards, which keeps the loop branch free
+#if PARTICLES_USE_SSE
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vfade = _mm_set1_ps(dt * PARTICLE_FADE_RATE);
+    for (; i + 4 <= this->Count; i += 4)
+    {
+        _mm_storeu_ps(&this->Life[i], _mm_sub_ps(_mm_loadu_ps(&this->Life[i]), vdt));
+        _mm_storeu_ps(&this->PositionX[i], _mm_sub_ps(_mm_loadu_ps(&this->PositionX[i]), _mm_mul_ps(_mm_loadu_ps(&this->VelocityX[i]), vdt)));
+        _mm_storeu_ps(&this->PositionY[i], _mm_sub_ps(_mm_loadu_ps(&this->PositionY[i]), _mm_mul_ps(_mm_loadu_ps(&this->VelocityY[i]), vdt)));
+        _mm_storeu_ps(&this->ColorA[i], _mm_sub_ps(_mm_loadu_ps(&this->ColorA[i]), vfade));
+    }
+#endif
+    for (; i < this->Count; ++i)
+    {
+        this->Life[i] -= dt;
+        this->PositionX[i] -= this->VelocityX[i] * dt;
+        this->PositionY[i] -= this->VelocityY[i] * dt;
+        this->ColorA[i] -= dt * PARTICLE_FADE_RATE;
+    }
+    // compact: move the last live particle into each dead slot
+    for (i = 0; i < this->Count; )
+    {
+        if (this->Life[i] <= 0.0f)
+            this->remove(i);
+        else
+            ++i;
+    }
+    if (this->recycle >= this->Count)
+        this->recycle = 0;
+}
+
+void ParticlePool::Clear()
+{
+    this->Count = 0;
+    this->recycle = 0;
+}
+
+void ParticlePool::remove(unsigned int i)
+{
+    unsigned int last = --this->Count;
+    this->PositionX[i] = this->PositionX[last]; this->PositionY[i] = this->PositionY[last];
+    this->VelocityX[i] = this->VelocityX[last]; this->VelocityY[i] = this->VelocityY[last];
+    this->ColorR[i] = this->ColorR[last]; this->ColorG[i] = this->ColorG[last];
+    this->ColorB[i] = this->ColorB[last]; this->ColorA[i] = this->ColorA[last];
+    this->Life[i] = this->Life[last];
+}
+
+
+ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, unsigned int seed)
+    : Particles(amount), shader(shader), texture(texture), seed(seed), spawnIndex(0), gpu(false),
+      particleSSBO(0), deadListSSBO(0), aliveListSSBO(0), controlBuffer(0), current(0)
 {
     this->init();
 }
 
-void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
+ParticleGenerator::~ParticleGenerator()
 {
-    // add new particles 
-    for (unsigned int i = 0; i < newParticles; ++i)
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->quadVBO);
+    glDeleteBuffers(1, &this->instanceVBO);
+    if (this->gpu)
     {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
+        unsigned int buffers[] = { this->particleSSBO, this->deadListSSBO, this->aliveListSSBO, this->controlBuffer };
+        glDeleteBuffers(4, buffers);
     }
-    // update all particles
-    for (unsigned int i = 0; i < this->amount; ++i)
+}
+
+bool ParticleGenerator::EnableGPU(Shader computeShader, Shader renderShader)
+{
+    int major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major < 4 || (major == 4 && minor < 3))
+        return false;
+    if (this->gpu)
+        return true;
+    this->computeShader = computeShader;
+    this->gpuShader = renderShader;
+    unsigned int capacity = this->Particles.Capacity();
+
+    // every slot starts out on the dead list
+    std::vector<unsigned int> deadList(capacity);
+    for (unsigned int i = 0; i < capacity; ++i)
+        deadList[i] = i;
+    GPUParticleControl control = {};
+    control.DeadCount = static_cast<int>(capacity);
+    control.DispatchArgs[1] = control.DispatchArgs[2] = 1;
+    control.DrawArgs[0] = 6;
+
+    glGenBuffers(1, &this->particleSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->particleSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(GPUParticle), NULL, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &this->deadListSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->deadListSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(unsigned int), deadList.data(), GL_DYNAMIC_COPY);
+    // two halves, ping-ponged between frames: particles that survive are appended to the other half
+    glGenBuffers(1, &this->aliveListSSBO);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->aliveListSSBO);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, 2 * capacity * sizeof(unsigned int), NULL, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &this->controlBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->controlBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GPUParticleControl), &control, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    this->computeShader.Use().SetUnsigned("capacity", capacity);
+    this->Particles.Clear();
+    this->current = 0;
+    this->gpu = true;
+    return true;
+}
+
+void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
+{
+    if (this->gpu)
     {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {	// particle is alive, thus update
-            p.Position -= p.Velocity * dt; 
-            p.Color.a -= dt * 2.5f;
-        }
+        // same spawn parameters as respawnParticle, the randomness is drawn on the GPU
+        this->computeShader.Use();
+        this->computeShader.SetFloat("dt", dt);
+        this->computeShader.SetUnsigned("current", this->current);
+        this->computeShader.SetUnsigned("seed", this->seed);
+        this->computeShader.SetUnsigned("spawnBase", this->spawnIndex);
+        this->computeShader.SetUnsigned("emitCount", newParticles);
+        this->computeShader.SetVector2f("emitterPosition", object.Position + offset);
+        this->computeShader.SetVector2f("emitterVelocity", object.Velocity * 0.1f);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->particleSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->deadListSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->aliveListSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->controlBuffer);
+        // consume dead slots and append them to the current alive list
+        if (newParticles > 0)
+            this->dispatchStage(STAGE_EMIT, (newParticles + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE);
+        // size the simulation dispatch from the GPU side alive count
+        this->dispatchStage(STAGE_PREPARE, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+        // integrate; survivors go to the other alive list, the rest back onto the dead list
+        this->computeShader.SetInteger("stage", STAGE_SIMULATE);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->controlBuffer);
+        glDispatchComputeIndirect(offsetof(GPUParticleControl, DispatchArgs));
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        // write the instance count for glDrawArraysIndirect
+        this->dispatchStage(STAGE_FINALIZE, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+        this->current ^= 1;
+        this->spawnIndex += newParticles;
+        return;
     }
+    // add new particles
+    for (unsigned int i = 0; i < newParticles; ++i)
+        this->respawnParticle(object, offset);
+    // update all particles
+    this->Particles.Update(dt);
 }
 
 // render all particles
 void ParticleGenerator::Draw()
 {
+    if (this->gpu)
+    {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        this->gpuShader.Use();
+        this->gpuShader.SetUnsigned("aliveOffset", this->current * this->Particles.Capacity());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->particleSSBO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->aliveListSSBO);
+        glActiveTexture(GL_TEXTURE0);
+        this->texture.Bind();
+        glBindVertexArray(this->VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->controlBuffer);
+        glDrawArraysIndirect(GL_TRIANGLES, (void*)offsetof(GPUParticleControl, DrawArgs));
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        return;
+    }
+    const ParticlePool &p = this->Particles;
+    if (p.Count == 0)
+        return;
+    // interleave the live particles into the instance stream
+    this->instanceData.resize(p.Count * 6);
+    float *data = this->instanceData.data();
+    for (unsigned int i = 0; i < p.Count; ++i, data += 6)
+    {
+        data[0] = p.PositionX[i]; data[1] = p.PositionY[i];
+        data[2] = p.ColorR[i]; data[3] = p.ColorG[i]; data[4] = p.ColorB[i]; data[5] = p.ColorA[i];
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    // orphan last frame's storage so the upload doesn't wait on the GPU
+    glBufferData(GL_ARRAY_BUFFER, p.Capacity() * 6 * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, p.Count * 6 * sizeof(float), this->instanceData.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     // use additive blending to give it a 'glow' effect
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
     this->shader.Use();
-    for (Particle particle : this->particles)
+    glActiveTexture(GL_TEXTURE0);
+    this->texture.Bind();
+    glBindVertexArray(this->VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, p.Count);
+    glBindVertexArray(0);
+    // don't forget to reset to default blending mode
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+ParticleStats ParticleGenerator::GetStats()
+{
+    ParticleStats stats;
+    if (this->gpu)
     {
-        if (particle.Life > 0.0f)
+        GPUParticleControl control;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->controlBuffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(control), &control);
+        stats.Count = control.AliveCount[this->current];
+        if (stats.Count > 0)
         {
-            this->shader.SetVector2f("offset", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
+            std::vector<unsigned int> alive(stats.Count);
+            std::vector<GPUParticle> particles(this->Particles.Capacity());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->aliveListSSBO);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, this->current * this->Particles.Capacity() * sizeof(unsigned int), stats.Count * sizeof(unsigned int), alive.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->particleSSBO);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, particles.size() * sizeof(GPUParticle), particles.data());
+            for (unsigned int index : alive)
+            {
+                stats.MeanPosition += particles[index].Position;
+                stats.MeanAlpha += particles[index].Color.a;
+                stats.MeanLife += particles[index].Life;
+            }
         }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
     }
-    // don't forget to reset to default blending mode
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    else
+    {
+        const ParticlePool &p = this->Particles;
+        stats.Count = p.Count;
+        for (unsigned int i = 0; i < p.Count; ++i)
+        {
+            stats.MeanPosition += glm::vec2(p.PositionX[i], p.PositionY[i]);
+            stats.MeanAlpha += p.ColorA[i];
+            stats.MeanLife += p.Life[i];
+        }
+    }
+    if (stats.Count > 0)
+    {
+        stats.MeanPosition /= static_cast<float>(stats.Count);
+        stats.MeanAlpha /= static_cast<float>(stats.Count);
+        stats.MeanLife /= static_cast<float>(stats.Count);
+    }
+    return stats;
+}
+
+void ParticleGenerator::dispatchStage(int stage, unsigned int groups)
+{
+    this->computeShader.SetInteger("stage", stage);
+    glDispatchCompute(groups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
-    unsigned int VBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -69,52 +370,36 @@ void ParticleGenerator::init()
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 1.0f, 1.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f
-    }; 
+    };
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->quadVBO);
+    glGenBuffers(1, &this->instanceVBO);
     glBindVertexArray(this->VAO);
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // per-instance offset and color, streamed every frame
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, this->Particles.Capacity() * 6 * sizeof(float), NULL, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
+    glVertexAttribDivisor(2, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    // create this->amount default particle instances
-    for (unsigned int i = 0; i < this->amount; ++i)
-        this->particles.push_back(Particle());
+    this->instanceData.reserve(this->Particles.Capacity() * 6);
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
-unsigned int ParticleGenerator::firstUnusedParticle()
+void ParticleGenerator::respawnParticle(GameObject &object, glm::vec2 offset)
 {
-    // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    unsigned int n = this->spawnIndex++;
+    float random = (static_cast<int>(ParticleRandom(this->seed, n, 0) % 100) - 50) / 10.0f;
+    float rColor = 0.5f + ((ParticleRandom(this->seed, n, 1) % 100) / 100.0f);
+    this->Particles.Spawn(object.Position + random + offset, object.Velocity * 0.1f, glm::vec4(rColor, rColor, rColor, 1.0f), 1.0f);
 }
-
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
-{
-    float random = ((rand() % 100) - 50) / 10.0f;
-    float rColor = 0.5f + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
-}
\ No newline at end of file
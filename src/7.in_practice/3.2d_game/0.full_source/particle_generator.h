@@ -18,42 +18,103 @@
 #include "game_object.h"
 
 
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
-    glm::vec4 Color;
-    float     Life;
+// Deterministic random number for the n-th spawned particle of a generator.
+// Shared bit for bit by the CPU path and the compute shader (see particles.cs),
+// so both back ends spawn identical particles for the same seed.
+unsigned int ParticleRandom(unsigned int seed, unsigned int n, unsigned int channel);
 
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+// Summary of the live particles, used to compare the CPU and GPU back ends.
+struct ParticleStats
+{
+    unsigned int Count = 0;
+    glm::vec2    MeanPosition = glm::vec2(0.0f);
+    float        MeanAlpha = 0.0f;
+    float        MeanLife = 0.0f;
+    // same count, and means that differ by at most tolerance (relative to their size, at least 1)
+    bool Matches(const ParticleStats &other, float tolerance) const;
+};
+
+
+// ParticlePool stores particles as a structure of arrays. Only the
+// first Count entries are alive: dead particles are swap-removed
+// so updates and uploads never touch unused slots. It holds no
+// render state and can be updated without an OpenGL context.
+class ParticlePool
+{
+public:
+    // particle state, one entry per particle
+    std::vector<float> PositionX, PositionY;
+    std::vector<float> VelocityX, VelocityY;
+    std::vector<float> ColorR, ColorG, ColorB, ColorA;
+    std::vector<float> Life;
+    // number of live particles (stored in [0, Count))
+    unsigned int Count;
+    // constructor
+    ParticlePool(unsigned int capacity);
+    // maximum number of particles
+    unsigned int Capacity() const { return this->capacity; }
+    // adds a particle; if the pool is full an existing particle is recycled
+    void Spawn(glm::vec2 position, glm::vec2 velocity, glm::vec4 color, float life);
+    // advances all live particles by dt and removes the ones that died
+    void Update(float dt);
+    // removes all particles
+    void Clear();
+private:
+    unsigned int capacity;
+    // next slot to recycle when the pool is full
+    unsigned int recycle;
+    // moves the last live particle into slot i
+    void remove(unsigned int i);
 };
 
 
-// ParticleGenerator acts as a container for rendering a large number of 
-// particles by repeatedly spawning and updating particles and killing 
-// them after a given amount of time.
+// ParticleGenerator acts as a container for rendering a large number of
+// particles by repeatedly spawning and updating particles and killing
+// them after a given amount of time. All live particles are streamed
+// into an instance buffer and rendered with a single draw call.
+//
+// With EnableGPU the particles instead live in shader storage buffers
+// and are emitted, simulated and recycled by a compute shader; the
+// CPU pool then stays empty and only serves as the reference path.
 class ParticleGenerator
 {
 public:
+    // particle state (CPU back end)
+    ParticlePool Particles;
     // constructor
-    ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+    ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, unsigned int seed = 0);
+    // destructor
+    ~ParticleGenerator();
+    // switches to the compute back end; returns false (and keeps the CPU back end) without OpenGL 4.3
+    bool EnableGPU(Shader computeShader, Shader renderShader);
+    // whether the compute back end is active
+    bool UsesGPU() const { return this->gpu; }
     // update all particles
     void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
     // render all particles
     void Draw();
+    // summarizes the live particles of the active back end (reads back GPU buffers, so not for every frame)
+    ParticleStats GetStats();
 private:
-    // state
-    std::vector<Particle> particles;
-    unsigned int amount;
     // render state
     Shader shader;
     Texture2D texture;
-    unsigned int VAO;
+    unsigned int VAO, quadVBO, instanceVBO;
+    // interleaved per-instance data (vec2 offset, vec4 color), reused every frame
+    std::vector<float> instanceData;
+    // random stream: every spawned particle consumes one index
+    unsigned int seed, spawnIndex;
+    // compute back end state
+    bool gpu;
+    Shader computeShader, gpuShader;
+    unsigned int particleSSBO, deadListSSBO, aliveListSSBO, controlBuffer;
+    unsigned int current; // which half of the alive list holds this frame's particles
     // initializes buffer and vertex attributes
     void init();
-    // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    unsigned int firstUnusedParticle();
+    // runs one compute stage (see particles.cs)
+    void dispatchStage(int stage, unsigned int groups);
     // respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    void respawnParticle(GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
 };
 
 #endif
\ No newline at end of file
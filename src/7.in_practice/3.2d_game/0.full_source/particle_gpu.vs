@@ -0,0 +1,28 @@
+#version 430 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+
+out vec2 TexCoords;
+out vec4 ParticleColor;
+
+struct Particle {
+    vec2 position;
+    vec2 velocity;
+    vec4 color;
+    float life;
+};
+
+// written by particles.cs; one instance per entry of the current alive list
+layout (std430, binding = 0) readonly buffer Particles { Particle particles[]; };
+layout (std430, binding = 2) readonly buffer AliveList { uint aliveList[]; };
+
+uniform mat4 projection;
+uniform uint aliveOffset;
+
+void main()
+{
+    Particle p = particles[aliveList[aliveOffset + uint(gl_InstanceID)]];
+    float scale = 10.0f;
+    TexCoords = vertex.zw;
+    ParticleColor = p.color;
+    gl_Position = projection * vec4((vertex.xy * scale) + p.position, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#version 430 core
+// GPU back end of ParticleGenerator. One program, four stages selected by 'stage':
+//   0 emit:     pop 'emitCount' slots off the dead list and append them to the current alive list
+//   1 prepare:  write the simulate dispatch size from the current alive count (single thread)
+//   2 simulate: integrate the current alive list; survivors go to the other list, the rest back onto the dead list
+//   3 finalize: write the instance count of the indirect draw (single thread)
+layout (local_size_x = 64) in;
+
+struct Particle {
+    vec2 position;
+    vec2 velocity;
+    vec4 color;
+    float life;
+};
+
+layout (std430, binding = 0) buffer Particles { Particle particles[]; };
+layout (std430, binding = 1) buffer DeadList { uint deadList[]; };
+layout (std430, binding = 2) buffer AliveList { uint aliveList[]; }; // two halves of 'capacity' entries
+layout (std430, binding = 3) buffer Control {
+    int deadCount;
+    uint aliveCount[2];
+    uint padding0;
+    uint dispatchArgs[3];
+    uint padding1;
+    uint drawArgs[4];
+};
+
+uniform int stage;
+uniform uint capacity;
+uniform uint current;
+uniform float dt;
+// emission
+uniform uint seed;
+uniform uint spawnBase;
+uniform uint emitCount;
+uniform vec2 emitterPosition;
+uniform vec2 emitterVelocity;
+
+// must match ParticleRandom() in particle_generator.cpp
+uint hashParticle(uint x)
+{
+    x ^= x >> 16; x *= 0x7feb352du;
+    x ^= x >> 15; x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+uint particleRandom(uint n, uint channel)
+{
+    return hashParticle(seed ^ hashParticle(n * 2u + channel));
+}
+
+void main()
+{
+    uint id = gl_GlobalInvocationID.x;
+    uint next = 1u - current;
+    if (stage == 0)
+    {
+        if (id >= emitCount)
+            return;
+        int slot = atomicAdd(deadCount, -1) - 1;
+        if (slot < 0)
+        {
+            // pool exhausted, drop the particle
+            atomicAdd(deadCount, 1);
+            return;
+        }
+        uint index = deadList[slot];
+        uint n = spawnBase + id;
+        float random = float(int(particleRandom(n, 0u) % 100u) - 50) / 10.0;
+        float rColor = 0.5 + float(particleRandom(n, 1u) % 100u) / 100.0;
+        particles[index].position = emitterPosition + random;
+        particles[index].velocity = emitterVelocity;
+        particles[index].color = vec4(rColor, rColor, rColor, 1.0);
+        particles[index].life = 1.0;
+        aliveList[current * capacity + atomicAdd(aliveCount[current], 1u)] = index;
+    }
+    else if (stage == 1)
+    {
+        if (id != 0u)
+            return;
+        aliveCount[next] = 0u;
+        dispatchArgs[0] = (aliveCount[current] + gl_WorkGroupSize.x - 1u) / gl_WorkGroupSize.x;
+    }
+    else if (stage == 2)
+    {
+        if (id >= aliveCount[current])
+            return;
+        uint index = aliveList[current * capacity + id];
+        Particle p = particles[index];
+        p.life -= dt;
+        if (p.life > 0.0)
+        {
+            p.position -= p.velocity * dt;
+            p.color.a -= dt * 2.5;
+            particles[index] = p;
+            aliveList[next * capacity + atomicAdd(aliveCount[next], 1u)] = index;
+        }
+        else
+            deadList[atomicAdd(deadCount, 1)] = index;
+    }
+    else
+    {
+        if (id != 0u)
+            return;
+        drawArgs[1] = aliveCount[next];
+    }
+}
\ No newline at end of file
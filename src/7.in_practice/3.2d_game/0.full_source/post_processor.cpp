@@ -8,32 +8,29 @@
 ******************************************************************/
 #include "post_processor.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height) 
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false)
+PostProcessor::PostProcessor(const char *vShaderFile, const char *fShaderFile, unsigned int width, unsigned int height, float scale, unsigned int samples) 
+    : Texture(), Width(width), Height(height), RenderWidth(width), RenderHeight(height), Scale(scale), Samples(samples), Confuse(false), Chaos(false), Shake(false),
+      MSFBO(0), FBO(0), RBO(0), viewport(), queried(), frame(0)
 {
-    // initialize renderbuffer/framebuffer object
-    glGenFramebuffers(1, &this->MSFBO);
-    glGenFramebuffers(1, &this->FBO);
-    glGenRenderbuffers(1, &this->RBO);
-    // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height); // allocate storage for render buffer object
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
-    // also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    this->Texture.Generate(width, height, NULL);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // attach texture to framebuffer as its color attachment
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // compile a shader permutation for every combination of effects; chaos overrides confuse, so those share one
+    for (unsigned int effects = 0; effects < EFFECT_PERMUTATIONS; ++effects)
+    {
+        if ((effects & EFFECT_CHAOS) && (effects & EFFECT_CONFUSE))
+            continue;
+        std::string name = "postprocessing", defines;
+        if (effects & EFFECT_CHAOS)   { name += "_chaos";   defines += "#define CHAOS\n"; }
+        if (effects & EFFECT_CONFUSE) { name += "_confuse"; defines += "#define CONFUSE\n"; }
+        if (effects & EFFECT_SHAKE)   { name += "_shake";   defines += "#define SHAKE\n"; }
+        this->permutations[effects] = ResourceManager::LoadShader(vShaderFile, fShaderFile, nullptr, name, defines);
+    }
+    this->permutations[EFFECT_CHAOS | EFFECT_CONFUSE] = this->permutations[EFFECT_CHAOS];
+    this->permutations[EFFECT_CHAOS | EFFECT_CONFUSE | EFFECT_SHAKE] = this->permutations[EFFECT_CHAOS | EFFECT_SHAKE];
     // initialize render data and uniforms
     this->initRenderData();
-    this->PostProcessingShader.SetInteger("scene", 0, true);
     float offset = 1.0f / 300.0f;
     float offsets[9][2] = {
         { -offset,  offset  },  // top-left
@@ -46,56 +43,170 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
         {  0.0f,   -offset  },  // bottom-center
         {  offset, -offset  }   // bottom-right    
     };
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
     int edge_kernel[9] = {
         -1, -1, -1,
         -1,  8, -1,
         -1, -1, -1
     };
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
     float blur_kernel[9] = {
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
         2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
     };
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);    
+    // uniforms an effect doesn't use are compiled out; setting them is a no-op
+    for (ShaderHandle permutation : this->permutations)
+    {
+        Shader &shader = ResourceManager::GetShader(permutation);
+        shader.SetInteger("scene", 0, true);
+        glUniform2fv(glGetUniformLocation(shader.ID, "offsets"), 9, (float*)offsets);
+        glUniform1iv(glGetUniformLocation(shader.ID, "edge_kernel"), 9, edge_kernel);
+        glUniform1fv(glGetUniformLocation(shader.ID, "blur_kernel"), 9, blur_kernel);
+    }
+    // timer queries
+    glGenQueries(QUERY_FRAMES * PASS_COUNT, &this->queries[0][0]);
+    // initialize renderbuffer/framebuffer objects
+    this->Configure(scale, samples);
+}
+
+PostProcessor::~PostProcessor()
+{
+    this->deleteTargets();
+    glDeleteQueries(QUERY_FRAMES * PASS_COUNT, &this->queries[0][0]);
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+}
+
+void PostProcessor::Configure(float scale, unsigned int samples)
+{
+    int maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    this->Scale = scale;
+    this->Samples = std::min(samples, static_cast<unsigned int>(std::max(maxSamples, 0)));
+    this->RenderWidth = std::max(1u, static_cast<unsigned int>(std::lround(this->Width * scale)));
+    this->RenderHeight = std::max(1u, static_cast<unsigned int>(std::lround(this->Height * scale)));
+    this->deleteTargets();
+    this->createTargets();
 }
 
 void PostProcessor::BeginRender()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    this->readTimings();
+    glGetIntegerv(GL_VIEWPORT, this->viewport);
+    this->beginPass(PASS_SCENE);
+    // without MSAA the game is rendered straight into the texture
+    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO ? this->MSFBO : this->FBO);
+    glViewport(0, 0, this->RenderWidth, this->RenderHeight);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 void PostProcessor::EndRender()
 {
-    // now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
-    glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    this->endPass();
+    if (this->MSFBO)
+    {
+        // now resolve multisampled color-buffer into intermediate FBO to store to texture
+        this->beginPass(PASS_RESOLVE);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+        glBlitFramebuffer(0, 0, this->RenderWidth, this->RenderHeight, 0, 0, this->RenderWidth, this->RenderHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        this->endPass();
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
+    glViewport(this->viewport[0], this->viewport[1], this->viewport[2], this->viewport[3]);
 }
 
 void PostProcessor::Render(float time)
 {
-    // set uniforms/options
-    this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
-    // render textured quad
+    this->beginPass(PASS_EFFECTS);
+    // pick the permutation with exactly the enabled effects compiled in
+    unsigned int effects = (this->Chaos ? EFFECT_CHAOS : 0) | (this->Confuse ? EFFECT_CONFUSE : 0) | (this->Shake ? EFFECT_SHAKE : 0);
+    Shader &shader = ResourceManager::GetShader(this->permutations[effects]);
+    shader.Use();
+    shader.SetFloat("time", time);
+    // render textured quad; linear filtering does the upscale from the internal resolution
     glActiveTexture(GL_TEXTURE0);
     this->Texture.Bind();	
     glBindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    this->endPass();
+    ++this->frame;
+}
+
+void PostProcessor::createTargets()
+{
+    glGenFramebuffers(1, &this->FBO);
+    if (this->Samples > 1)
+    {
+        glGenFramebuffers(1, &this->MSFBO);
+        glGenRenderbuffers(1, &this->RBO);
+        // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
+        glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->Samples, GL_RGB, this->RenderWidth, this->RenderHeight); // allocate storage for render buffer object
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+    }
+    // also initialize the FBO/texture to blit multisampled color-buffer to (or render to directly without MSAA); used for shader operations (for postprocessing effects)
+    glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+    this->Texture.Generate(this->RenderWidth, this->RenderHeight, NULL);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // attach texture to framebuffer as its color attachment
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PostProcessor::deleteTargets()
+{
+    // the texture object is kept; Generate reallocates its storage
+    if (this->MSFBO)
+        glDeleteFramebuffers(1, &this->MSFBO);
+    if (this->RBO)
+        glDeleteRenderbuffers(1, &this->RBO);
+    if (this->FBO)
+        glDeleteFramebuffers(1, &this->FBO);
+    this->MSFBO = this->RBO = this->FBO = 0;
+}
+
+void PostProcessor::beginPass(Pass pass)
+{
+    unsigned int slot = this->frame % QUERY_FRAMES;
+    glBeginQuery(GL_TIME_ELAPSED, this->queries[slot][pass]);
+    this->queried[slot][pass] = true;
+}
+
+void PostProcessor::endPass()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+void PostProcessor::readTimings()
+{
+    // the queries of this slot were issued QUERY_FRAMES frames ago, so their results are normally ready without stalling
+    unsigned int slot = this->frame % QUERY_FRAMES;
+    float *timings[PASS_COUNT] = { &this->Timings.Scene, &this->Timings.Resolve, &this->Timings.Effects };
+    for (unsigned int pass = 0; pass < PASS_COUNT; ++pass)
+    {
+        if (!this->queried[slot][pass])
+        {
+            *timings[pass] = 0.0f;
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(this->queries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(this->queries[slot][pass], GL_QUERY_RESULT, &nanoseconds);
+        *timings[pass] = nanoseconds / 1000000.0f;
+        this->queried[slot][pass] = false;
+    }
 }
 
 void PostProcessor::initRenderData()
 {
     // configure VAO/VBO
-    unsigned int VBO;
     float vertices[] = {
         // pos        // tex
         -1.0f, -1.0f, 0.0f, 0.0f,
@@ -107,9 +218,9 @@ void PostProcessor::initRenderData()
          1.0f,  1.0f, 1.0f, 1.0f
     };
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->VBO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     glBindVertexArray(this->VAO);
@@ -15,25 +15,48 @@
 #include "texture.h"
 #include "sprite_renderer.h"
 #include "shader.h"
+#include "resource_manager.h"
 
 
+// GPU time of each post processing pass in milliseconds, measured
+// with timer queries a few frames after the fact.
+struct PostProcessorTimings
+{
+    float Scene   = 0.0f; // rendering the game into the offscreen target
+    float Resolve = 0.0f; // resolving the multisampled target (0 without MSAA)
+    float Effects = 0.0f; // effects and upscale to the window
+};
+
 // PostProcessor hosts all PostProcessing effects for the Breakout
 // Game. It renders the game on a textured quad after which one can
 // enable specific effects by enabling either the Confuse, Chaos or 
 // Shake boolean. 
+// Every combination of effects is its own shader permutation, so
+// effects that are off cost nothing, and all enabled effects run in
+// a single fullscreen pass. The game can be rendered at a fraction of
+// the output resolution, with or without MSAA; the effect pass then
+// also does the (bilinear) upscale.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
 class PostProcessor
 {
 public:
     // state
-    Shader PostProcessingShader;
     Texture2D Texture;
-    unsigned int Width, Height;
+    unsigned int Width, Height; // size of the output
+    unsigned int RenderWidth, RenderHeight; // size the game is rendered at
+    float Scale; // RenderWidth / Width
+    unsigned int Samples; // MSAA samples of the offscreen target (0 or 1 disables MSAA)
     // options
     bool Confuse, Chaos, Shake;
-    // constructor
-    PostProcessor(Shader shader, unsigned int width, unsigned int height);
+    // GPU time per pass
+    PostProcessorTimings Timings;
+    // constructor; compiles a permutation of the given shaders for every combination of effects
+    PostProcessor(const char *vShaderFile, const char *fShaderFile, unsigned int width, unsigned int height, float scale = 1.0f, unsigned int samples = 4);
+    // destructor
+    ~PostProcessor();
+    // changes the internal resolution scale and MSAA samples, recreating the offscreen targets
+    void Configure(float scale, unsigned int samples);
     // prepares the postprocessor's framebuffer operations before rendering the game
     void BeginRender();
     // should be called after rendering the game, so it stores all the rendered data into a texture object
@@ -41,12 +64,32 @@ public:
     // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
     void Render(float time);
 private:
+    // timed passes, and the number of frames their queries are kept in flight before being read
+    enum Pass { PASS_SCENE, PASS_RESOLVE, PASS_EFFECTS, PASS_COUNT };
+    static const unsigned int QUERY_FRAMES = 3;
+    // effect bits indexing the shader permutations
+    enum Effect { EFFECT_CHAOS = 1, EFFECT_CONFUSE = 2, EFFECT_SHAKE = 4, EFFECT_PERMUTATIONS = 8 };
+    ShaderHandle permutations[EFFECT_PERMUTATIONS];
     // render state
-    unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
+    unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO (0 without MSAA). FBO is regular, used for blitting MS color-buffer to texture
     unsigned int RBO; // RBO is used for multisampled color buffer
-    unsigned int VAO;
+    unsigned int VAO, VBO;
+    // viewport of the output, restored after rendering into the offscreen target
+    GLint viewport[4];
+    // timer queries, one set per frame in flight
+    unsigned int queries[QUERY_FRAMES][PASS_COUNT];
+    bool         queried[QUERY_FRAMES][PASS_COUNT];
+    unsigned int frame;
+    // (re)creates the offscreen render targets at the current scale and sample count
+    void createTargets();
+    void deleteTargets();
     // initialize quad for rendering postprocessing texture
     void initRenderData();
+    // starts/ends timing a pass of the current frame
+    void beginPass(Pass pass);
+    void endPass();
+    // reads the timings of the frame that last used the current query set
+    void readTimings();
 };
 
 #endif
\ No newline at end of file
@@ -8,34 +8,99 @@
 ******************************************************************/
 #ifndef POWER_UP_H
 #define POWER_UP_H
-#include <string>
+#include <vector>
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "game_object.h"
-
 
 // The size of a PowerUp block
 const glm::vec2 POWERUP_SIZE(60.0f, 20.0f);
 // Velocity a PowerUp block has when spawned
 const glm::vec2 VELOCITY(0.0f, 150.0f);
 
+// The kinds of PowerUps
+enum PowerUpType {
+    POWERUP_SPEED,
+    POWERUP_STICKY,
+    POWERUP_PASS_THROUGH,
+    POWERUP_PAD_SIZE_INCREASE,
+    POWERUP_CONFUSE,
+    POWERUP_CHAOS,
+    POWERUP_TYPE_COUNT
+};
+
+// What all PowerUps of a type share
+struct PowerUpInfo
+{
+    const char   *Texture;  // name of its texture in the ResourceManager
+    glm::vec3     Color;
+    float         Duration; // seconds its effect lasts once collected (0: applied once)
+    unsigned int  Chance;   // a destroyed brick spawns one with a chance of 1 in Chance
+};
+const PowerUpInfo POWERUP_INFO[POWERUP_TYPE_COUNT] = {
+    { "powerup_speed",       glm::vec3(0.5f, 0.5f, 1.0f),   0.0f, 75 },
+    { "powerup_sticky",      glm::vec3(1.0f, 0.5f, 1.0f),  20.0f, 75 },
+    { "powerup_passthrough", glm::vec3(0.5f, 1.0f, 0.5f),  10.0f, 75 },
+    { "powerup_increase",    glm::vec3(1.0f, 0.6f, 0.4f),   0.0f, 75 },
+    { "powerup_confuse",     glm::vec3(1.0f, 0.3f, 0.3f),  15.0f, 15 }, // negative powerups spawn more often
+    { "powerup_chaos",       glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, 15 }
+};
+
+// A falling PowerUp. Its size, velocity, color and texture follow
+// from its type; once collected it only lives on as a PowerUpTimer.
+struct PowerUp
+{
+    glm::vec2     Position;
+    PowerUpType   Type;
+    // spawn order, so simultaneous pickups are applied oldest first
+    unsigned int  Serial;
+};
 
-// PowerUp inherits its state and rendering functions from
-// GameObject but also holds extra information to state its
-// active duration and whether it is activated or not. 
-// The type of PowerUp is stored as a string.
-class PowerUp : public GameObject 
+// PowerUpPool keeps the falling PowerUps packed in one reused array:
+// spawning appends and removing moves the last PowerUp into the gap.
+// Nothing is allocated once the pool has grown to the largest number
+// of PowerUps falling at once, and iterating costs only the PowerUps
+// that exist. Removing changes the index of the last PowerUp.
+class PowerUpPool
 {
 public:
-    // powerup state
-    std::string Type;
-    float       Duration;	
-    bool        Activated;
-    // constructor
-    PowerUp(std::string type, glm::vec3 color, float duration, glm::vec2 position, Texture2D texture) 
-        : GameObject(position, POWERUP_SIZE, texture, color, VELOCITY), Type(type), Duration(duration), Activated() { }
+    PowerUpPool() : nextSerial(0) { }
+    unsigned int   Size() const { return static_cast<unsigned int>(this->items.size()); }
+    PowerUp       &operator[](unsigned int index) { return this->items[index]; }
+    const PowerUp &operator[](unsigned int index) const { return this->items[index]; }
+    std::vector<PowerUp>::const_iterator begin() const { return this->items.begin(); }
+    std::vector<PowerUp>::const_iterator end() const { return this->items.end(); }
+    // adds a PowerUp
+    void Spawn(PowerUpType type, glm::vec2 position)
+    {
+        PowerUp powerUp = { position, type, this->nextSerial++ };
+        this->items.push_back(powerUp);
+    }
+    // removes the PowerUp at index; the last PowerUp takes its place
+    void Remove(unsigned int index)
+    {
+        this->items[index] = this->items.back();
+        this->items.pop_back();
+    }
+    // removes all PowerUps, keeping the storage
+    void Clear()
+    {
+        this->items.clear();
+        this->nextSerial = 0;
+    }
+private:
+    std::vector<PowerUp> items;
+    unsigned int         nextSerial;
+};
+
+// A collected PowerUp whose effect is still active. Timers are kept in
+// a min-heap on the step their effect wears off at.
+struct PowerUpTimer
+{
+    unsigned long long Expiry;
+    PowerUpType        Type;
+    // heap order: the earliest expiry on top
+    bool operator>(const PowerUpTimer &other) const { return this->Expiry > other.Expiry; }
 };
 
 #endif
\ No newline at end of file
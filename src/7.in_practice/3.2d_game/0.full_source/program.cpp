@@ -11,22 +11,97 @@
 
 #include "game.h"
 #include "resource_manager.h"
+#include "audio_mixer.h"
+#include "particle_generator.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <random>
+#include <string>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
+// runs the simulation without a window
+int run_headless(const char *argument);
+// converts a text level to the binary format
+int convert_level(const char *input, const char *output);
+// times loading large generated levels in both formats
+int benchmark_levels(const char *argument);
+// triggers many sounds through the mixer without an audio device
+int benchmark_audio(const char *argument);
+// floods the simulation with power-ups
+int benchmark_powerups(const char *argument);
+// plays the stress level with and without the collision broad phase
+int benchmark_collisions(const char *argument);
+// updates large particle pools without rendering them
+int benchmark_particles(const char *argument);
+// runs the CPU and GPU particle back ends side by side and compares them
+int check_particles(const char *argument);
+// input that keeps the paddle under the ball
+GameInput autopilot(const GameSimulation &simulation);
 
 // The Width of the screen
 const unsigned int SCREEN_WIDTH = 800;
 // The height of the screen
 const unsigned int SCREEN_HEIGHT = 600;
+// Longest frame time that is caught up on, so a stall doesn't trigger a burst of updates
+const float MAX_FRAME_TIME = 0.25f;
+// Upper bound on the length of a single headless autopilot game (10 simulated minutes)
+const unsigned int HEADLESS_MAX_STEPS = static_cast<unsigned int>(600.0f / SIMULATION_TIMESTEP);
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+// usage: breakout [--stress-level] [--record file | --replay file | --headless [file | games] |
+//                  --convert-level level.lvl [level.blvl] | --level-benchmark [size] |
+//                  --audio-benchmark [sounds] | --powerup-benchmark [per second] |
+//                  --collision-benchmark [steps] | --particle-benchmark [particles] |
+//                  --particle-check [steps]]
 int main(int argc, char *argv[])
 {
+    const char *recordFile = nullptr;
+    // applies to the window as well as to the headless modes, so it is picked up first
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--stress-level") == 0)
+            Breakout.StressLevel = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            return run_headless(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--convert-level") == 0 && i + 1 < argc)
+            return convert_level(argv[i + 1], i + 2 < argc ? argv[i + 2] : nullptr);
+        if (std::strcmp(argv[i], "--level-benchmark") == 0)
+            return benchmark_levels(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--audio-benchmark") == 0)
+            return benchmark_audio(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--powerup-benchmark") == 0)
+            return benchmark_powerups(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--collision-benchmark") == 0)
+            return benchmark_collisions(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--particle-benchmark") == 0)
+            return benchmark_particles(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--particle-check") == 0)
+            return check_particles(i + 1 < argc ? argv[i + 1] : nullptr);
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordFile = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            if (!Breakout.Recording.Load(argv[++i]))
+            {
+                std::cout << "Failed to load recording " << argv[i] << std::endl;
+                return -1;
+            }
+            Breakout.Replay = true;
+        }
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -58,12 +133,14 @@ int main(int argc, char *argv[])
 
     // initialize game
     // ---------------
-    Breakout.Init();
+    Breakout.Init(Breakout.Replay ? Breakout.Recording.Seed : 0);
 
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
+    // simulation time not yet consumed by fixed steps
+    float accumulator = 0.0f;
 
     while (!glfwWindowShouldClose(window))
     {
@@ -72,15 +149,19 @@ int main(int argc, char *argv[])
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        accumulator += std::min(deltaTime, MAX_FRAME_TIME);
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
-
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // run as many fixed steps as fit in the elapsed time
+        // --------------------------------------------------
+        while (accumulator >= SIMULATION_TIMESTEP)
+        {
+            // manage user input
+            Breakout.ProcessInput();
+            // update game state
+            Breakout.Update();
+            accumulator -= SIMULATION_TIMESTEP;
+        }
 
         // render
         // ------
@@ -96,9 +177,358 @@ int main(int argc, char *argv[])
     ResourceManager::Clear();
 
     glfwTerminate();
+    if (recordFile && !Breakout.Recording.Save(recordFile))
+        std::cout << "Failed to save recording " << recordFile << std::endl;
+    return 0;
+}
+
+// Without a window there are no textures or sounds, only the simulation. Given
+// a recording it is replayed and the final checksum printed, so two builds or
+// machines can be compared; given a number of games, that many are played by
+// a simple autopilot (seeds 0..n-1, game n on level n modulo the level count,
+// so with --stress-level every fifth game plays the stress level) and the
+// throughput is reported. Anything else is an error.
+int run_headless(const char *argument)
+{
+    Breakout.LoadLevels();
+    GameSimulation &simulation = Breakout.Simulation;
+    InputRecording recording;
+    if (argument && recording.Load(argument))
+    {
+        simulation.Init(recording.Seed);
+        for (unsigned char frame : recording.Frames)
+            simulation.Step(GameInput::Unpack(frame));
+        std::cout << "steps: " << simulation.Steps << " checksum: " << std::hex << simulation.Checksum() << std::endl;
+        return 0;
+    }
+    unsigned int games = 100;
+    if (argument)
+    {
+        // anything that is not a recording must be a positive number of games
+        char *end = nullptr;
+        long count = std::strtol(argument, &end, 10);
+        if (end == argument || *end != '\0' || count <= 0 || count > 1000000000L)
+        {
+            std::cout << "Failed to load recording " << argument << " (and it is not a number of games)" << std::endl;
+            return -1;
+        }
+        games = static_cast<unsigned int>(count);
+    }
+    unsigned long long steps = 0, checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int seed = 0; seed < games; ++seed)
+    {
+        simulation.Init(seed);
+        // pick a level by seed, then play until the game is won or lost
+        GameInput select;
+        for (unsigned int i = 0; i < seed % simulation.Levels.size(); ++i)
+        {
+            select.NextLevel = true;
+            simulation.Step(select);
+            select.NextLevel = false;
+            simulation.Step(select);
+        }
+        select.Confirm = true;
+        simulation.Step(select);
+        while (simulation.State == GAME_ACTIVE && simulation.Steps < HEADLESS_MAX_STEPS)
+            simulation.Step(autopilot(simulation));
+        steps += simulation.Steps;
+        checksum = checksum * 31 + simulation.Checksum();
+    }
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "games: " << games << " steps: " << steps << " time: " << seconds << "s"
+              << " (" << games / seconds << " games/s, " << steps / seconds << " steps/s)"
+              << " checksum: " << std::hex << checksum << std::endl;
+    return 0;
+}
+
+// Writes the binary version of a text level. Without an output name it
+// goes next to the input (one.lvl -> one.blvl), where the game picks it
+// up instead of the text file until the text file is edited again.
+int convert_level(const char *input, const char *output)
+{
+    LevelData level;
+    if (!ReadTextLevel(input, level))
+    {
+        std::cout << "Failed to read level " << input << std::endl;
+        return -1;
+    }
+    std::string file = output ? output : BinaryLevelPath(input);
+    if (!WriteBinaryLevel(file, level))
+    {
+        std::cout << "Failed to write level " << file << std::endl;
+        return -1;
+    }
+    std::cout << input << " -> " << file << " (" << level.Width << "x" << level.Height << ")" << std::endl;
+    return 0;
+}
+
+// Generates a size x size level, stores it in both formats and reports
+// how long reading each takes, and how long building its bricks takes.
+int benchmark_levels(const char *argument)
+{
+    unsigned int size = argument ? std::atoi(argument) : 1000;
+    const int runs = 5;
+    LevelData generated = GenerateStressLevel(size, size);
+    // write the text version the way the shipped levels are written
+    std::string text;
+    text.reserve(generated.Tiles.size() * 2);
+    for (unsigned int y = 0; y < generated.Height; ++y)
+    {
+        for (unsigned int x = 0; x < generated.Width; ++x)
+        {
+            text += std::to_string(generated.At(x, y));
+            text += ' ';
+        }
+        text += '\n';
+    }
+    std::ofstream("benchmark.lvl", std::ios::binary) << text;
+    WriteBinaryLevel("benchmark.blvl", generated);
+    auto time = [runs](const char *name, const std::function<void()> &load)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i)
+            load();
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+        std::cout << name << ": " << ms << " ms" << std::endl;
+    };
+    LevelData level;
+    GameLevel bricks;
+    std::cout << size << "x" << size << " level, " << text.size() << " bytes as text, " << generated.Tiles.size() + 16 << " bytes binary" << std::endl;
+    time("read text   ", [&]() { ReadTextLevel("benchmark.lvl", level); });
+    time("read binary ", [&]() { ReadBinaryLevel("benchmark.blvl", level); });
+    time("build bricks", [&]() { bricks.Build(level, SCREEN_WIDTH, SCREEN_HEIGHT / 2); });
+    bool identical = ReadTextLevel("benchmark.lvl", level) && level.Tiles == generated.Tiles;
+    std::cout << "text and binary levels " << (identical ? "match" : "DIFFER") << std::endl;
+    std::remove("benchmark.lvl");
+    std::remove("benchmark.blvl");
+    return identical ? 0 : -1;
+}
+
+// Triggers sounds in bursts, the way a frame full of collisions would,
+// through a mixer with the null backend. Reports the cost of a trigger
+// on the calling (game) thread and checks the voice limits held.
+int benchmark_audio(const char *argument)
+{
+    unsigned int count = argument ? std::atoi(argument) : 100000;
+    const unsigned int burst = 32;
+    const unsigned int limits[] = { 4, 2, 2 };
+    NullAudioBackend *backend = new NullAudioBackend(0.1f);
+    AudioMixer mixer(backend);
+    for (unsigned int limit : limits)
+        mixer.Load("", limit);
+    mixer.Start();
+    std::chrono::steady_clock::duration triggering(0);
+    for (unsigned int i = 0; i < count; i += burst)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int j = i; j < std::min(i + burst, count); ++j)
+            mixer.Play(j % 3);
+        triggering += std::chrono::steady_clock::now() - start;
+        mixer.Flush();
+    }
+    float ns = std::chrono::duration<float, std::nano>(triggering).count() / count;
+    std::cout << "sounds: " << mixer.Stats.Requested << " dropped: " << mixer.Stats.Dropped << " started: " << mixer.Stats.Started
+              << " stolen: " << mixer.Stats.Stolen << " peak voices: " << backend->PeakVoices << std::endl;
+    std::cout << "trigger cost: " << ns << " ns" << std::endl;
+    return backend->PeakVoices <= 4 + 2 + 2 ? 0 : -1;
+}
+
+// Drops the given number of power-ups per simulated second at random
+// places along the top of the screen for ten simulated seconds, while
+// the paddle sweeps from side to side collecting some of them, and
+// reports how long the steps took.
+int benchmark_powerups(const char *argument)
+{
+    unsigned int rate = argument ? std::atoi(argument) : 50000;
+    const unsigned int steps = static_cast<unsigned int>(std::lround(10.0f / SIMULATION_TIMESTEP));
+    Breakout.LoadLevels();
+    GameSimulation &simulation = Breakout.Simulation;
+    simulation.Init(0);
+    GameInput input;
+    input.Confirm = true;
+    simulation.Step(input);
+    input.Confirm = false;
+    std::mt19937 random(0);
+    std::uniform_real_distribution<float> x(0.0f, SCREEN_WIDTH - POWERUP_SIZE.x);
+    unsigned long long spawned = 0, collected = 0;
+    unsigned int peakFalling = 0, peakActive = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int step = 0; step < steps; ++step)
+    {
+        for (unsigned long long target = static_cast<unsigned long long>(rate * (step + 1) * static_cast<double>(SIMULATION_TIMESTEP)); spawned < target; ++spawned)
+            simulation.SpawnPowerUp(static_cast<PowerUpType>(random() % POWERUP_TYPE_COUNT), glm::vec2(x(random), 0.0f));
+        // change direction every two seconds
+        input.Left = static_cast<unsigned int>(step * SIMULATION_TIMESTEP / 2.0f) % 2 == 0;
+        input.Right = !input.Left;
+        simulation.Step(input);
+        collected += std::count(simulation.Events.begin(), simulation.Events.end(), EVENT_POWERUP_ACTIVATED);
+        peakFalling = std::max(peakFalling, simulation.PowerUps.Size());
+        peakActive = std::max(peakActive, simulation.ActivePowerUps());
+    }
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "power-ups: " << spawned << " spawned, " << collected << " collected, peak " << peakFalling << " falling, "
+              << peakActive << " active" << std::endl;
+    std::cout << "steps: " << steps << " time: " << seconds << "s (" << seconds * 1000.0f / steps << " ms/step, "
+              << steps * SIMULATION_TIMESTEP / seconds << "x real time)" << std::endl;
+    return 0;
+}
+
+// Plays the stress level (500x500 bricks) for the given number of steps
+// with the autopilot twice: once through the broad phase, once testing
+// every brick and power-up. Both runs have to end in the same state; the
+// narrow phase tests and the time per step of each are reported.
+int benchmark_collisions(const char *argument)
+{
+    unsigned int steps = argument ? std::atoi(argument) : 1200;
+    Breakout.StressLevel = true;
+    Breakout.LoadLevels();
+    GameSimulation &simulation = Breakout.Simulation;
+    unsigned long long checksums[2];
+    for (int run = 0; run < 2; ++run)
+    {
+        simulation.BroadPhase = run == 0;
+        simulation.Init(0);
+        // the stress level comes last, one step back from the first level
+        GameInput select;
+        select.PreviousLevel = true;
+        simulation.Step(select);
+        unsigned long long checks = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int step = 0; step < steps; ++step)
+        {
+            GameInput input = autopilot(simulation);
+            // start again after losing all lives
+            input.Confirm = simulation.State != GAME_ACTIVE;
+            simulation.Step(input);
+            checks += simulation.CollisionChecks;
+        }
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / steps;
+        checksums[run] = simulation.Checksum();
+        std::cout << (run == 0 ? "broad phase: " : "brute force: ") << static_cast<double>(checks) / steps << " checks/step, "
+                  << ms << " ms/step, " << simulation.Levels[simulation.Level].Bricks.size() << " bricks" << std::endl;
+    }
+    bool identical = checksums[0] == checksums[1];
+    std::cout << "final states " << (identical ? "match" : "DIFFER") << std::endl;
+    return identical ? 0 : -1;
+}
+
+// Keeps pools of 1k, 10k, ... up to the given number of particles alive
+// for two simulated seconds, respawning the ones that die every step the
+// way the ball's trail does, and reports what ParticlePool::Update costs.
+// Needs no OpenGL context.
+int benchmark_particles(const char *argument)
+{
+    unsigned int maxCount = argument ? std::atoi(argument) : 1000000;
+    const unsigned int steps = static_cast<unsigned int>(std::lround(2.0f / SIMULATION_TIMESTEP));
+    for (unsigned int count = 1000; count <= maxCount; count *= 10)
+    {
+        ParticlePool pool(count);
+        unsigned int spawned = 0;
+        auto spawn = [&](float life)
+        {
+            glm::vec2 position(ParticleRandom(0, spawned, 0) % SCREEN_WIDTH, ParticleRandom(0, spawned, 1) % SCREEN_HEIGHT);
+            pool.Spawn(position, glm::vec2(10.0f, -35.0f), glm::vec4(1.0f), life);
+            ++spawned;
+        };
+        // lives spread over a second, so a steady share dies every step
+        for (unsigned int i = 0; i < count; ++i)
+            spawn((i + 1) / static_cast<float>(count));
+        std::chrono::steady_clock::duration updating(0);
+        unsigned long long updated = 0;
+        for (unsigned int step = 0; step < steps; ++step)
+        {
+            while (pool.Count < count)
+                spawn(1.0f);
+            updated += pool.Count;
+            auto start = std::chrono::steady_clock::now();
+            pool.Update(SIMULATION_TIMESTEP);
+            updating += std::chrono::steady_clock::now() - start;
+        }
+        float ms = std::chrono::duration<float, std::milli>(updating).count();
+        std::cout << count << " particles: " << ms / steps << " ms per update, " << ms * 1.0e6f / updated << " ns per particle, "
+                  << spawned - count << " respawned" << std::endl;
+    }
     return 0;
 }
 
+// Feeds the CPU and the compute shader particle back ends the same seed
+// and the same emitter, circling the screen like a ball trailed by 500
+// particles, and compares their ParticleStats every simulated second.
+// Needs OpenGL 4.3; the window stays hidden.
+int check_particles(const char *argument)
+{
+    unsigned int steps = argument ? std::atoi(argument) : 1200;
+    const float tolerance = 1e-4f;
+    const unsigned int interval = static_cast<unsigned int>(std::lround(1.0f / SIMULATION_TIMESTEP));
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, false);
+    GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
+    if (!window)
+    {
+        std::cout << "Failed to create an OpenGL 4.3 context" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    ShaderHandle particle = ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
+    ShaderHandle particlesCompute = ResourceManager::LoadComputeShader("particles.cs", "particles_compute");
+    ShaderHandle particleGPU = ResourceManager::LoadShader("particle_gpu.vs", "particle.fs", nullptr, "particle_gpu");
+    bool match = true;
+    {
+        ParticleGenerator cpu(ResourceManager::GetShader(particle), Texture2D(), 500);
+        ParticleGenerator gpu(ResourceManager::GetShader(particle), Texture2D(), 500);
+        if (!gpu.EnableGPU(ResourceManager::GetShader(particlesCompute), ResourceManager::GetShader(particleGPU)))
+        {
+            std::cout << "Compute shaders are not supported" << std::endl;
+            match = false;
+            steps = 0;
+        }
+        GameObject emitter;
+        for (unsigned int step = 0; step < steps; ++step)
+        {
+            float angle = step * SIMULATION_TIMESTEP;
+            emitter.Position = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT) * 0.5f + glm::vec2(std::cos(angle), std::sin(angle)) * 200.0f;
+            emitter.Velocity = glm::vec2(-std::sin(angle), std::cos(angle)) * 200.0f;
+            cpu.Update(SIMULATION_TIMESTEP, emitter, 2, glm::vec2(BALL_RADIUS / 2.0f));
+            gpu.Update(SIMULATION_TIMESTEP, emitter, 2, glm::vec2(BALL_RADIUS / 2.0f));
+            if ((step + 1) % interval != 0 && step + 1 != steps)
+                continue;
+            ParticleStats a = cpu.GetStats(), b = gpu.GetStats();
+            bool same = a.Matches(b, tolerance);
+            std::cout << "step " << step + 1 << ": CPU " << a.Count << " particles, mean position (" << a.MeanPosition.x << ", " << a.MeanPosition.y
+                      << "), alpha " << a.MeanAlpha << ", life " << a.MeanLife << " / GPU " << b.Count << " particles, mean position ("
+                      << b.MeanPosition.x << ", " << b.MeanPosition.y << "), alpha " << b.MeanAlpha << ", life " << b.MeanLife
+                      << (same ? "" : " MISMATCH") << std::endl;
+            match = match && same;
+        }
+    }
+    ResourceManager::Clear();
+    glfwTerminate();
+    std::cout << "CPU and GPU particles " << (match ? "match" : "DIFFER") << std::endl;
+    return match ? 0 : -1;
+}
+
+GameInput autopilot(const GameSimulation &simulation)
+{
+    GameInput input;
+    float paddle = simulation.Player.Position.x + simulation.Player.Size.x / 2.0f;
+    float ball = simulation.Ball.Position.x + simulation.Ball.Radius;
+    input.Left = ball < paddle - 10.0f;
+    input.Right = ball > paddle + 10.0f;
+    input.Launch = simulation.Ball.Stuck;
+    return input;
+}
+
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
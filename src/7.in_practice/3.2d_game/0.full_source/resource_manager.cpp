@@ -8,51 +8,160 @@
 ******************************************************************/
 #include "resource_manager.h"
 
+#include <chrono>
 #include <iostream>
+#include <iomanip>
 #include <sstream>
 #include <fstream>
 
 #include "stb_image.h"
 
 // Instantiate static variables
-std::map<std::string, Texture2D>    ResourceManager::Textures;
-std::map<std::string, Shader>       ResourceManager::Shaders;
+std::vector<Texture2D>   ResourceManager::Textures;
+std::vector<Shader>      ResourceManager::Shaders;
+std::vector<AssetTiming> ResourceManager::Timings;
+std::unordered_map<std::string, unsigned int>  ResourceManager::shaderIndices;
+std::unordered_map<std::string, unsigned int>  ResourceManager::textureIndices;
+std::vector<ResourceManager::PendingTexture>   ResourceManager::pendingTextures;
 
+// inserts defines right after the #version line (which has to stay first) of a shader's source
+static std::string insertDefines(const std::string &code, const std::string &defines)
+{
+    if (defines.empty())
+        return code;
+    if (code.compare(0, 8, "#version") != 0)
+        return defines + code;
+    size_t line = code.find('\n');
+    if (line == std::string::npos)
+        return code + "\n" + defines;
+    return code.substr(0, line + 1) + defines + code.substr(line + 1);
+}
+
+// milliseconds passed since start
+static float millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+ShaderHandle ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name, const std::string &defines)
+{
+    ShaderHandle handle = FindShader(name);
+    AssetTiming timing = { name, 0.0f, 0.0f };
+    Shaders[handle.Index] = loadShaderFromFile(timing, vShaderFile, fShaderFile, gShaderFile, defines);
+    Timings.push_back(timing);
+    return handle;
+}
+
+ShaderHandle ResourceManager::LoadComputeShader(const char *cShaderFile, std::string name)
+{
+    ShaderHandle handle = FindShader(name);
+    AssetTiming timing = { name, 0.0f, 0.0f };
+    Shaders[handle.Index] = loadComputeShaderFromFile(timing, cShaderFile);
+    Timings.push_back(timing);
+    return handle;
+}
+
+ShaderHandle ResourceManager::FindShader(const std::string &name)
+{
+    auto found = shaderIndices.emplace(name, static_cast<unsigned int>(Shaders.size()));
+    if (found.second)
+        Shaders.push_back(Shader());
+    return ShaderHandle(found.first->second);
+}
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+TextureHandle ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
 {
-    Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-    return Shaders[name];
+    TextureHandle handle = FindTexture(name);
+    AssetTiming timing = { name, 0.0f, 0.0f };
+    DecodedImage image = decodeImage(file);
+    timing.ReadMs = image.ReadMs;
+    Textures[handle.Index] = createTexture(image, alpha, timing);
+    Timings.push_back(timing);
+    return handle;
 }
 
-Shader ResourceManager::GetShader(std::string name)
+TextureHandle ResourceManager::LoadTextureAsync(const char *file, bool alpha, std::string name)
 {
-    return Shaders[name];
+    TextureHandle handle = FindTexture(name);
+    PendingTexture pending;
+    pending.Handle = handle;
+    pending.Name = name;
+    pending.Alpha = alpha;
+    // the worker only touches the file and its own memory; all GL calls stay on this thread
+    std::string path = file;
+    pending.Image = std::async(std::launch::async, [path]() { return decodeImage(path.c_str()); });
+    pendingTextures.push_back(std::move(pending));
+    return handle;
 }
 
-Texture2D ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+unsigned int ResourceManager::UploadTextures(bool wait)
 {
-    Textures[name] = loadTextureFromFile(file, alpha);
-    return Textures[name];
+    unsigned int uploaded = 0;
+    for (size_t i = 0; i < pendingTextures.size(); )
+    {
+        PendingTexture &pending = pendingTextures[i];
+        if (!wait && pending.Image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++i;
+            continue;
+        }
+        DecodedImage image = pending.Image.get();
+        AssetTiming timing = { pending.Name, image.ReadMs, 0.0f };
+        Textures[pending.Handle.Index] = createTexture(image, pending.Alpha, timing);
+        Timings.push_back(timing);
+        ++uploaded;
+        pendingTextures.erase(pendingTextures.begin() + i);
+    }
+    return uploaded;
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+TextureHandle ResourceManager::FindTexture(const std::string &name)
 {
-    return Textures[name];
+    auto found = textureIndices.emplace(name, static_cast<unsigned int>(Textures.size()));
+    if (found.second)
+        Textures.push_back(Texture2D());
+    return TextureHandle(found.first->second);
+}
+
+void ResourceManager::PrintTimings()
+{
+    float read = 0.0f, create = 0.0f;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const AssetTiming &timing : Timings)
+    {
+        std::cout << "  " << std::left << std::setw(22) << timing.Name << std::right
+                  << " read " << std::setw(8) << timing.ReadMs << " ms, create " << std::setw(8) << timing.CreateMs << " ms" << std::endl;
+        read += timing.ReadMs;
+        create += timing.CreateMs;
+    }
+    std::cout << "  " << Timings.size() << " assets: read " << read << " ms, create " << create << " ms" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
 }
 
 void ResourceManager::Clear()
 {
-    // (properly) delete all shaders	
-    for (auto iter : Shaders)
-        glDeleteProgram(iter.second.ID);
+    // finish decodes still in flight before their memory is dropped
+    for (PendingTexture &pending : pendingTextures)
+        stbi_image_free(pending.Image.get().Data);
+    pendingTextures.clear();
+    // (properly) delete all shaders
+    for (const Shader &shader : Shaders)
+        if (shader.ID)
+            glDeleteProgram(shader.ID);
     // (properly) delete all textures
-    for (auto iter : Textures)
-        glDeleteTextures(1, &iter.second.ID);
+    for (const Texture2D &texture : Textures)
+        if (texture.ID)
+            glDeleteTextures(1, &texture.ID);
+    Shaders.clear();
+    Textures.clear();
+    shaderIndices.clear();
+    textureIndices.clear();
 }
 
-Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile)
+Shader ResourceManager::loadShaderFromFile(AssetTiming &timing, const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &defines)
 {
+    auto start = std::chrono::steady_clock::now();
     // 1. retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
@@ -70,8 +179,8 @@ Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *
         vertexShaderFile.close();
         fragmentShaderFile.close();
         // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        vertexCode = insertDefines(vShaderStream.str(), defines);
+        fragmentCode = insertDefines(fShaderStream.str(), defines);
         // if geometry shader path is present, also load a geometry shader
         if (gShaderFile != nullptr)
         {
@@ -79,24 +188,66 @@ Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *
             std::stringstream gShaderStream;
             gShaderStream << geometryShaderFile.rdbuf();
             geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
+            geometryCode = insertDefines(gShaderStream.str(), defines);
         }
     }
-    catch (std::exception e)
+    catch (const std::exception &e)
     {
         std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
     }
     const char *vShaderCode = vertexCode.c_str();
     const char *fShaderCode = fragmentCode.c_str();
     const char *gShaderCode = geometryCode.c_str();
+    timing.ReadMs = millisecondsSince(start);
     // 2. now create shader object from source code
+    start = std::chrono::steady_clock::now();
     Shader shader;
     shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+    timing.CreateMs = millisecondsSince(start);
     return shader;
 }
 
-Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
+Shader ResourceManager::loadComputeShaderFromFile(AssetTiming &timing, const char *cShaderFile)
 {
+    auto start = std::chrono::steady_clock::now();
+    // 1. retrieve the compute source code from filePath
+    std::string computeCode;
+    try
+    {
+        std::ifstream computeShaderFile(cShaderFile);
+        std::stringstream cShaderStream;
+        cShaderStream << computeShaderFile.rdbuf();
+        computeShaderFile.close();
+        computeCode = cShaderStream.str();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "ERROR::SHADER: Failed to read compute shader file" << std::endl;
+    }
+    timing.ReadMs = millisecondsSince(start);
+    // 2. now create shader object from source code
+    start = std::chrono::steady_clock::now();
+    Shader shader;
+    shader.CompileCompute(computeCode.c_str());
+    timing.CreateMs = millisecondsSince(start);
+    return shader;
+}
+
+ResourceManager::DecodedImage ResourceManager::decodeImage(const char *file)
+{
+    auto start = std::chrono::steady_clock::now();
+    DecodedImage image;
+    int nrChannels;
+    image.Data = stbi_load(file, &image.Width, &image.Height, &nrChannels, 0);
+    if (!image.Data)
+        image.Width = image.Height = 0;
+    image.ReadMs = millisecondsSince(start);
+    return image;
+}
+
+Texture2D ResourceManager::createTexture(DecodedImage &image, bool alpha, AssetTiming &timing)
+{
+    auto start = std::chrono::steady_clock::now();
     // create texture object
     Texture2D texture;
     if (alpha)
@@ -104,12 +255,11 @@ Texture2D ResourceManager::loadTextureFromFile(const char *file, bool alpha)
         texture.Internal_Format = GL_RGBA;
         texture.Image_Format = GL_RGBA;
     }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
     // now generate texture
-    texture.Generate(width, height, data);
+    texture.Generate(image.Width, image.Height, image.Data);
     // and finally free image data
-    stbi_image_free(data);
+    stbi_image_free(image.Data);
+    image.Data = nullptr;
+    timing.CreateMs = millisecondsSince(start);
     return texture;
-}
\ No newline at end of file
+}
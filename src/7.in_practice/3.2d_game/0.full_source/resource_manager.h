@@ -9,8 +9,10 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
-#include <map>
+#include <future>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -18,34 +20,100 @@
 #include "shader.h"
 
 
+// Typed index of a resource stored by the ResourceManager. Resolving a
+// name to a handle hashes the name once; looking a resource up through
+// its handle is a plain array access.
+template<typename T>
+struct ResourceHandle
+{
+    unsigned int Index;
+    ResourceHandle() : Index(~0u) { }
+    explicit ResourceHandle(unsigned int index) : Index(index) { }
+    bool Valid() const { return this->Index != ~0u; }
+};
+typedef ResourceHandle<Shader>    ShaderHandle;
+typedef ResourceHandle<Texture2D> TextureHandle;
+
+// Time spent loading a single asset: reading/decoding its file(s) and
+// creating the GL object (compiling a shader, uploading a texture).
+struct AssetTiming
+{
+    std::string Name;
+    float       ReadMs, CreateMs;
+};
+
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
+// and/or shader is stored in a slot that is looked up by name
+// once (FindShader/FindTexture) and afterwards through its handle.
+// Slots are reserved on first use of a name, so handles can be
+// resolved before (or without) the resource being loaded; until
+// then they refer to an empty, default constructed resource.
+// All functions and resources are static and no public
+// constructor is defined.
 class ResourceManager
 {
 public:
-    // resource storage
-    static std::map<std::string, Shader>    Shaders;
-    static std::map<std::string, Texture2D> Textures;
-    // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader
-    static Shader    LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-    // retrieves a stored sader
-    static Shader    GetShader(std::string name);
+    // resource storage, indexed by handle
+    static std::vector<Shader>      Shaders;
+    static std::vector<Texture2D>   Textures;
+    // load times of all assets, in load order
+    static std::vector<AssetTiming> Timings;
+    // loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader's source code. If gShaderFile is not nullptr, it also loads a geometry shader.
+    // defines (e.g. "#define FOO\n") are inserted after the #version line of every stage, to compile permutations of the same source
+    static ShaderHandle  LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name, const std::string &defines = "");
+    // loads (and generates) a compute shader program from file (requires OpenGL 4.3)
+    static ShaderHandle  LoadComputeShader(const char *cShaderFile, std::string name);
+    // resolves a shader name to its handle, reserving a slot for it if it isn't known yet
+    static ShaderHandle  FindShader(const std::string &name);
+    // retrieves a stored shader; the reference is valid until the next shader is added
+    static Shader&       GetShader(ShaderHandle handle) { return Shaders[handle.Index]; }
+    static Shader&       GetShader(const std::string &name) { return GetShader(FindShader(name)); }
     // loads (and generates) a texture from file
-    static Texture2D LoadTexture(const char *file, bool alpha, std::string name);
-    // retrieves a stored texture
-    static Texture2D GetTexture(std::string name);
-    // properly de-allocates all loaded resources
-    static void      Clear();
+    static TextureHandle LoadTexture(const char *file, bool alpha, std::string name);
+    // decodes a texture from file on a worker thread; the GL texture is created by UploadTextures
+    static TextureHandle LoadTextureAsync(const char *file, bool alpha, std::string name);
+    // creates the GL textures of decoded asynchronous loads (all of them when wait is set); returns how many
+    static unsigned int  UploadTextures(bool wait);
+    // resolves a texture name to its handle, reserving a slot for it if it isn't known yet
+    static TextureHandle FindTexture(const std::string &name);
+    // retrieves a stored texture; the reference is valid until the next texture is added
+    static Texture2D&    GetTexture(TextureHandle handle) { return Textures[handle.Index]; }
+    static Texture2D&    GetTexture(const std::string &name) { return GetTexture(FindTexture(name)); }
+    // prints the load time of every asset
+    static void          PrintTimings();
+    // properly de-allocates all loaded resources; all handles become invalid
+    static void          Clear();
 private:
+    // an image decoded on a worker thread, waiting for its upload
+    struct DecodedImage
+    {
+        unsigned char *Data;
+        int            Width, Height;
+        float          ReadMs;
+    };
+    struct PendingTexture
+    {
+        TextureHandle             Handle;
+        std::string               Name;
+        bool                      Alpha;
+        std::future<DecodedImage> Image;
+    };
+    // name to slot registries
+    static std::unordered_map<std::string, unsigned int> shaderIndices;
+    static std::unordered_map<std::string, unsigned int> textureIndices;
+    // asynchronous texture loads that are not uploaded yet
+    static std::vector<PendingTexture> pendingTextures;
     // private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
     ResourceManager() { }
     // loads and generates a shader from file
-    static Shader    loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
-    // loads a single texture from file
-    static Texture2D loadTextureFromFile(const char *file, bool alpha);
+    static Shader    loadShaderFromFile(AssetTiming &timing, const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr, const std::string &defines = "");
+    // loads and generates a compute shader from file
+    static Shader    loadComputeShaderFromFile(AssetTiming &timing, const char *cShaderFile);
+    // decodes a single image from file
+    static DecodedImage decodeImage(const char *file);
+    // creates a texture from a decoded image and frees the image
+    static Texture2D createTexture(DecodedImage &image, bool alpha, AssetTiming &timing);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,236 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+
+TextureAtlas::TextureAtlas()
+{
+    this->Texture.Internal_Format = GL_RGBA;
+    this->Texture.Image_Format = GL_RGBA;
+    this->Texture.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->Texture.Wrap_T = GL_CLAMP_TO_EDGE;
+}
+
+void TextureAtlas::Add(const Texture2D &texture)
+{
+    this->pending.push_back(texture);
+}
+
+bool TextureAtlas::Build(unsigned int width)
+{
+    // every texture gets a 1 pixel border replicating its edge so linear filtering never samples a neighbour
+    const unsigned int padding = 1;
+    // shelf packing: tallest textures first, left to right, starting a new shelf when a row is full
+    std::vector<unsigned int> order(this->pending.size());
+    for (unsigned int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) { return this->pending[a].Height > this->pending[b].Height; });
+
+    std::vector<glm::uvec2> offsets(this->pending.size());
+    unsigned int x = 0, y = 0, shelfHeight = 0;
+    for (unsigned int i : order)
+    {
+        unsigned int w = this->pending[i].Width + 2 * padding, h = this->pending[i].Height + 2 * padding;
+        if (x + w > width)
+        {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (x + w > width || y + h > width)
+            return false;
+        offsets[i] = glm::uvec2(x + padding, y + padding);
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+    unsigned int height = y + shelfHeight;
+
+    // read back each texture and copy it (with its border) into the atlas image
+    std::vector<unsigned char> atlasData(width * height * 4, 0);
+    std::vector<unsigned char> pixels;
+    for (unsigned int i = 0; i < this->pending.size(); ++i)
+    {
+        const Texture2D &texture = this->pending[i];
+        pixels.resize(texture.Width * texture.Height * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        texture.Bind();
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        for (int row = -1; row <= static_cast<int>(texture.Height); ++row)
+        {
+            unsigned int srcRow = std::min(static_cast<unsigned int>(std::max(row, 0)), texture.Height - 1);
+            for (int col = -1; col <= static_cast<int>(texture.Width); ++col)
+            {
+                unsigned int srcCol = std::min(static_cast<unsigned int>(std::max(col, 0)), texture.Width - 1);
+                const unsigned char *src = &pixels[(srcRow * texture.Width + srcCol) * 4];
+                unsigned char *dst = &atlasData[((offsets[i].y + row) * width + offsets[i].x + col) * 4];
+                std::copy(src, src + 4, dst);
+            }
+        }
+        Region region;
+        region.UVMin = glm::vec2(offsets[i]) / glm::vec2(width, height);
+        region.UVMax = glm::vec2(offsets[i] + glm::uvec2(texture.Width, texture.Height)) / glm::vec2(width, height);
+        this->regions[texture.ID] = region;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->Texture.Generate(width, height, atlasData.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    this->pending.clear();
+    return true;
+}
+
+const TextureAtlas::Region *TextureAtlas::Find(unsigned int textureID) const
+{
+    auto it = this->regions.find(textureID);
+    return it != this->regions.end() ? &it->second : nullptr;
+}
+
+
+SpriteBatch::SpriteBatch(const Shader &shader, unsigned int maxSprites)
+    : shader(shader), maxSprites(maxSprites), atlas(nullptr)
+{
+    // quads share a static index buffer: 0 1 2, 2 3 0 per sprite
+    std::vector<unsigned int> indices(maxSprites * 6);
+    for (unsigned int i = 0; i < maxSprites; ++i)
+    {
+        unsigned int base = i * 4;
+        unsigned int quad[6] = { base, base + 1, base + 2, base + 2, base + 3, base };
+        std::copy(quad, quad + 6, &indices[i * 6]);
+    }
+
+    glGenVertexArrays(1, &this->VAO);
+    glGenBuffers(1, &this->VBO);
+    glGenBuffers(1, &this->EBO);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    glBufferData(GL_ARRAY_BUFFER, maxSprites * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Color));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->vertices.reserve(maxSprites * 4);
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(1, &this->VBO);
+    glDeleteBuffers(1, &this->EBO);
+}
+
+void SpriteBatch::SetAtlas(const TextureAtlas *atlas)
+{
+    this->atlas = atlas;
+}
+
+void SpriteBatch::Begin()
+{
+    this->sprites.clear();
+}
+
+void SpriteBatch::DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color, int layer)
+{
+    Sprite sprite;
+    unsigned int textureID = texture.ID;
+    sprite.UVMin = glm::vec2(0.0f);
+    sprite.UVMax = glm::vec2(1.0f);
+    if (this->atlas)
+    {
+        if (const TextureAtlas::Region *region = this->atlas->Find(texture.ID))
+        {
+            textureID = this->atlas->Texture.ID;
+            sprite.UVMin = region->UVMin;
+            sprite.UVMax = region->UVMax;
+        }
+    }
+    // flip the sign bit so negative layers sort before positive ones
+    sprite.Key = (static_cast<unsigned long long>(static_cast<unsigned int>(layer) ^ 0x80000000u) << 32) | textureID;
+    sprite.Position = position;
+    sprite.Size = size;
+    sprite.Color = color;
+    sprite.Rotation = rotate;
+    this->sprites.push_back(sprite);
+}
+
+void SpriteBatch::End()
+{
+    if (this->sprites.empty())
+        return;
+    std::stable_sort(this->sprites.begin(), this->sprites.end(), [](const Sprite &a, const Sprite &b) { return a.Key < b.Key; });
+
+    this->shader.Use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+
+    this->vertices.clear();
+    unsigned int currentTexture = static_cast<unsigned int>(this->sprites[0].Key);
+    unsigned int spriteCount = 0;
+    for (const Sprite &sprite : this->sprites)
+    {
+        unsigned int textureID = static_cast<unsigned int>(sprite.Key);
+        if (textureID != currentTexture || spriteCount == this->maxSprites)
+        {
+            this->flush(currentTexture, spriteCount);
+            currentTexture = textureID;
+            spriteCount = 0;
+        }
+        // same transform as SpriteRenderer: scale, rotate around the quad's center, then translate
+        glm::vec2 halfSize = 0.5f * sprite.Size;
+        glm::vec2 center = sprite.Position + halfSize;
+        float s = std::sin(glm::radians(sprite.Rotation)), c = std::cos(glm::radians(sprite.Rotation));
+        const glm::vec2 corners[4] = { glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f), glm::vec2(0.0f, 1.0f) };
+        for (const glm::vec2 &corner : corners)
+        {
+            glm::vec2 local = corner * sprite.Size - halfSize;
+            Vertex vertex;
+            vertex.Position = center + glm::vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+            vertex.TexCoords = glm::mix(sprite.UVMin, sprite.UVMax, corner);
+            vertex.Color = sprite.Color;
+            this->vertices.push_back(vertex);
+        }
+        ++spriteCount;
+    }
+    this->flush(currentTexture, spriteCount);
+    this->Stats.Sprites += static_cast<unsigned int>(this->sprites.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    this->sprites.clear();
+}
+
+void SpriteBatch::ResetStats()
+{
+    this->Stats = SpriteBatchStats();
+}
+
+void SpriteBatch::flush(unsigned int textureID, unsigned int spriteCount)
+{
+    if (spriteCount == 0)
+        return;
+    // orphan the previous contents so the driver doesn't stall on a buffer still in use
+    glBufferData(GL_ARRAY_BUFFER, this->maxSprites * 4 * sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, spriteCount * 4 * sizeof(Vertex), this->vertices.data());
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glDrawElements(GL_TRIANGLES, spriteCount * 6, GL_UNSIGNED_INT, 0);
+    this->Stats.DrawCalls += 1;
+    this->Stats.Vertices += spriteCount * 4;
+    this->vertices.clear();
+}
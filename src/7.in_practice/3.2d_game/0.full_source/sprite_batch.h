@@ -0,0 +1,108 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "texture.h"
+#include "shader.h"
+
+
+// TextureAtlas packs several already loaded textures into a single
+// texture. Once built, a SpriteBatch using the atlas transparently
+// redirects sprites of packed textures to their atlas region so
+// they can share a draw call.
+class TextureAtlas
+{
+public:
+    // location of a packed texture inside the atlas
+    struct Region
+    {
+        glm::vec2 UVMin, UVMax;
+    };
+    // the atlas texture (valid after Build)
+    Texture2D Texture;
+    // constructor
+    TextureAtlas();
+    // queues a texture for packing (read back from the GPU on Build)
+    void Add(const Texture2D &texture);
+    // packs all queued textures into a width x width texture; returns false if they do not fit
+    bool Build(unsigned int width = 1024);
+    // returns the region of a packed texture, or nullptr if the texture is not in the atlas
+    const Region *Find(unsigned int textureID) const;
+private:
+    std::vector<Texture2D>                     pending;
+    std::unordered_map<unsigned int, Region>   regions;
+};
+
+// Per frame counters of a SpriteBatch.
+struct SpriteBatchStats
+{
+    unsigned int DrawCalls = 0;
+    unsigned int Sprites   = 0;
+    unsigned int Vertices  = 0;
+};
+
+// SpriteBatch collects sprites between Begin and End, sorts them
+// by layer and texture and renders them from a single streamed
+// vertex buffer with one draw call per texture change. Sprites
+// in a lower layer are always drawn first; within a layer the
+// submission order of equal textures is preserved.
+class SpriteBatch
+{
+public:
+    // counters since the last ResetStats
+    SpriteBatchStats Stats;
+    // constructor (inits shaders/buffers)
+    SpriteBatch(const Shader &shader, unsigned int maxSprites = 2048);
+    // destructor
+    ~SpriteBatch();
+    // uses the given atlas (or none if nullptr) for all following sprites
+    void SetAtlas(const TextureAtlas *atlas);
+    // starts collecting sprites
+    void Begin();
+    // queues a quad textured with the given sprite; same parameters as SpriteRenderer::DrawSprite
+    void DrawSprite(const Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f), int layer = 0);
+    // sorts and renders all sprites queued since Begin
+    void End();
+    // resets the per frame counters
+    void ResetStats();
+private:
+    struct Vertex
+    {
+        glm::vec2 Position;
+        glm::vec2 TexCoords;
+        glm::vec3 Color;
+    };
+    struct Sprite
+    {
+        unsigned long long Key; // layer in the high, texture in the low bits
+        glm::vec2 Position, Size;
+        glm::vec2 UVMin, UVMax;
+        glm::vec3 Color;
+        float     Rotation;
+    };
+    // render state
+    Shader              shader;
+    unsigned int        VAO, VBO, EBO;
+    unsigned int        maxSprites;
+    const TextureAtlas *atlas;
+    // per frame storage, kept across frames to avoid reallocation
+    std::vector<Sprite> sprites;
+    std::vector<Vertex> vertices;
+    // uploads and draws the first spriteCount quads in vertices with the given texture
+    void flush(unsigned int textureID, unsigned int spriteCount);
+};
+
+#endif
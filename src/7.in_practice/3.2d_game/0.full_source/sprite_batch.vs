@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec3 aColor;
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+// sprites are transformed on the CPU when batched, so only the projection is left
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    SpriteColor = aColor;
+    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+#include <atomic>
+#include <cstddef>
+
+
+// A fixed size, lock-free queue for exactly one producer thread and
+// one consumer thread. Capacity must be a power of two; one slot is
+// kept free to tell a full queue from an empty one.
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+public:
+    SpscQueue() : head(0), tail(0) { }
+    // producer: appends an item; returns false (dropping it) if the queue is full
+    bool Push(const T &item)
+    {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        size_t next = (tail + 1) & (Capacity - 1);
+        if (next == this->head.load(std::memory_order_acquire))
+            return false;
+        this->items[tail] = item;
+        this->tail.store(next, std::memory_order_release);
+        return true;
+    }
+    // consumer: takes the oldest item; returns false if the queue is empty
+    bool Pop(T &item)
+    {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire))
+            return false;
+        item = this->items[head];
+        this->head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+    // consumer: whether there is nothing to take
+    bool Empty() const
+    {
+        return this->head.load(std::memory_order_relaxed) == this->tail.load(std::memory_order_seq_cst);
+    }
+private:
+    T                   items[Capacity];
+    // head is only written by the consumer, tail only by the producer; kept on separate cache lines
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D text;
+uniform vec3 textColor;
+
+void main()
+{    
+    // the atlas stores signed distances with the outline at 0.5; fwidth keeps the edge about a pixel wide at any scale
+    float distance = texture(text, TexCoords).r;
+    float smoothing = 0.7 * fwidth(distance);
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    color = vec4(textColor, alpha);
+}
\ No newline at end of file
@@ -6,28 +6,34 @@
 ** Creative Commons, either version 4 of the License, or (at your
 ** option) any later version.
 ******************************************************************/
-#include <iostream>
+#include <algorithm>
 
 #include <glm/gtc/matrix_transform.hpp>
-#include <ft2build.h>
-#include FT_FREETYPE_H
 
 #include "text_renderer.h"
 #include "resource_manager.h"
 
 
+// size the distance field atlas is generated at, and how far (in its texels) the field reaches
+const int DISTANCE_FIELD_SIZE = 48;
+const int DISTANCE_FIELD_SPREAD = 6;
+
+
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+    : DrawCalls(0), Characters(0), bufferSize(0), capHeight(0.0f), sizeScale(1.0f)
 {
     // load and configure shader
-    this->TextShader = ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text");
+    this->TextShader = ResourceManager::GetShader(ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text"));
     this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
     this->TextShader.SetInteger("text", 0);
+    Shader &distanceField = ResourceManager::GetShader(ResourceManager::LoadShader("text_2d.vs", "text_2d_sdf.fs", nullptr, "text_sdf"));
+    distanceField.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
+    distanceField.SetInteger("text", 0);
     // configure VAO/VBO for texture quads
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
     glBindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -36,105 +42,86 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
 
 void TextRenderer::Load(std::string font, unsigned int fontSize)
 {
-    // first clear the previously loaded Characters
-    this->Characters.clear();
-    // then initialize and load the FreeType library
-    FT_Library ft;    
-    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    // load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-    // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); 
-    // then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++) // lol see what I did there 
-    {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-            );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-       
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
-    }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    this->Glyphs.load(font, fontSize);
+    this->TextShader = ResourceManager::GetShader("text");
+    this->sizeScale = 1.0f;
+    const Glyph *h = this->Glyphs.glyph('H');
+    this->capHeight = h ? static_cast<float>(h->bearing.y) : 0.0f;
+}
+
+void TextRenderer::LoadDistanceField(std::string font, unsigned int fontSize, std::string cacheFile)
+{
+    this->Glyphs.loadDistanceField(font, DISTANCE_FIELD_SIZE, DISTANCE_FIELD_SPREAD, cacheFile);
+    this->TextShader = ResourceManager::GetShader("text_sdf");
+    this->sizeScale = static_cast<float>(fontSize) / DISTANCE_FIELD_SIZE;
+    const Glyph *h = this->Glyphs.glyph('H');
+    // the distance field bitmap starts 'spread' texels above the outline
+    this->capHeight = h ? static_cast<float>(h->bearing.y - DISTANCE_FIELD_SPREAD) : 0.0f;
 }
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
+    // a character outside the atlas may grow it half way, in which case the string is built again
+    this->vertices.clear();
+    if (!this->buildVertices(text, x, y, scale))
+    {
+        this->vertices.clear();
+        this->buildVertices(text, x, y, scale);
+    }
+    if (this->vertices.empty())
+        return;
     // activate corresponding render state	
     this->TextShader.Use();
     this->TextShader.SetVector3f("textColor", color);
     glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, this->Glyphs.textureID);
     glBindVertexArray(this->VAO);
+    // upload all quads at once, orphaning the previous contents so the driver doesn't wait for them
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    this->bufferSize = std::max(this->bufferSize, this->vertices.size());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * this->bufferSize, NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * this->vertices.size(), this->vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // render all glyphs in one go
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(this->vertices.size() / 4));
+    ++this->DrawCalls;
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
+bool TextRenderer::buildVertices(const std::string &text, float x, float y, float scale)
+{
+    scale *= this->sizeScale;
+    int atlasHeight = this->Glyphs.height();
     // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+    for (size_t i = 0; i < text.size();)
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
+        const Glyph *ch = this->Glyphs.glyph(GlyphAtlas::decodeUtf8(text, i));
+        if (!ch)
+            return true;
+        ++this->Characters;
+        if (ch->size.x > 0)
+        {
+            float xpos = x + ch->bearing.x * scale;
+            float ypos = y + (this->capHeight - ch->bearing.y) * scale;
 
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
+            float w = ch->size.x * scale;
+            float h = ch->size.y * scale;
+            glm::vec2 uv0 = ch->uvMin, uv1 = ch->uvMax;
+            // two triangles per glyph
+            float quad[6][4] = {
+                { xpos,     ypos + h,   uv0.x, uv1.y },
+                { xpos + w, ypos,       uv1.x, uv0.y },
+                { xpos,     ypos,       uv0.x, uv0.y },
 
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+                { xpos,     ypos + h,   uv0.x, uv1.y },
+                { xpos + w, ypos + h,   uv1.x, uv1.y },
+                { xpos + w, ypos,       uv1.x, uv0.y }
+            };
+            this->vertices.insert(this->vertices.end(), &quad[0][0], &quad[0][0] + 24);
+        }
         // now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+        x += ch->advance * scale;
     }
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    return this->Glyphs.height() == atlasHeight;
 }
\ No newline at end of file
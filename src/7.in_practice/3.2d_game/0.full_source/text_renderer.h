@@ -9,43 +9,56 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <learnopengl/glyph_atlas.h>
+
 #include "texture.h"
 #include "shader.h"
 
 
-/// Holds all state information relevant to a character as loaded using FreeType
-struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2   Size;      // size of glyph
-    glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
-    unsigned int Advance;   // horizontal offset to advance to next glyph
-};
-
-
 // A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// FreeType library. The glyphs of a single font are packed into one atlas
+// texture (ASCII up front, other UTF-8 characters on first use) and each
+// RenderText call draws its whole string with a single draw call. Fonts
+// loaded as distance fields stay sharp at any scale, so one atlas serves
+// every text size.
 class TextRenderer
 {
 public:
-    // holds a list of pre-compiled Characters
-    std::map<char, Character> Characters; 
+    // holds the glyphs of the loaded font
+    GlyphAtlas Glyphs;
     // shader used for text rendering
     Shader TextShader;
+    // number of draw calls and characters since the last ResetStats
+    unsigned int DrawCalls, Characters;
     // constructor
     TextRenderer(unsigned int width, unsigned int height);
-    // pre-compiles a list of characters from the given font
+    // loads the font and pre-renders its ASCII characters into the atlas
     void Load(std::string font, unsigned int fontSize);
-    // renders a string of text using the precompiled list of characters
+    // same, but as a distance field atlas; the atlas is read from/written to cacheFile if one is given
+    void LoadDistanceField(std::string font, unsigned int fontSize, std::string cacheFile = "");
+    // renders a (UTF-8) string of text
     void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // resets the draw call and character counters
+    void ResetStats() { this->DrawCalls = this->Characters = 0; }
 private:
     // render state
     unsigned int VAO, VBO;
+    // capacity of VBO in floats
+    size_t bufferSize;
+    // vertices of the string being rendered, kept to avoid reallocating
+    std::vector<float> vertices;
+    // offset from the top of a line to the baseline ('H' bearing)
+    float capHeight;
+    // scale from atlas texels to the loaded font size (distance field atlases are rendered larger)
+    float sizeScale;
+    // appends the quads of text, returns false if the atlas grew on the way (coordinates are stale)
+    bool buildVertices(const std::string &text, float x, float y, float scale);
 };
 
 #endif 
\ No newline at end of file
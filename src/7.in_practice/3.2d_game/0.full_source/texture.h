@@ -16,7 +16,7 @@
 class Texture2D
 {
 public:
-    // holds the ID of the texture object, used for all texture operations to reference to this particlar texture
+    // holds the ID of the texture object, used for all texture operations to reference to this particlar texture (0 until generated)
     unsigned int ID;
     // texture image dimensions
     unsigned int Width, Height; // width and height of loaded image in pixels
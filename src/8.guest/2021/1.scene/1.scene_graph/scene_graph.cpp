@@ -26,12 +26,18 @@ public:
 #endif
 
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <random>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+int runTransformBenchmark(unsigned int count);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -47,8 +53,12 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --transform-benchmark [transforms]: time and check Transform against the old Euler path without opening a window
+	if (argc > 1 && std::strcmp(argv[1], "--transform-benchmark") == 0)
+		return runTransformBenchmark(argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 100000);
+
 	// glfw: initialize and configure
 	// ------------------------------
 	glfwInit();
@@ -175,6 +185,80 @@ int main()
 	return 0;
 }
 
+// The model matrix as Transform used to build it: three Euler rotation matrices and full 4x4 products
+glm::mat4 eulerModelMatrix(const glm::mat4& parent, const glm::vec3& position, const glm::vec3& rotation, const glm::vec3& scale)
+{
+	const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	return parent * glm::translate(glm::mat4(1.0f), position) * transformY * transformX * transformZ * glm::scale(glm::mat4(1.0f), scale);
+}
+
+// Builds a tree of random transforms (every node's parent is node (i - 1) / 4) and updates it with
+// Transform, which composes a quaternion's 3x4 affine matrix, and with the old Euler path. Reports
+// the time per update and the largest difference between the two, relative to the matrix size.
+int runTransformBenchmark(unsigned int count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-10.0f, 10.0f), angle(-180.0f, 180.0f), scale(0.8f, 1.25f);
+	std::vector<glm::vec3> positions(count), rotations(count), scales(count);
+	std::vector<Transform> transforms(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		positions[i] = glm::vec3(position(random), position(random), position(random));
+		rotations[i] = glm::vec3(angle(random), angle(random), angle(random));
+		scales[i] = glm::vec3(scale(random), scale(random), scale(random));
+		transforms[i].setLocalPosition(positions[i]);
+		transforms[i].setLocalRotation(rotations[i]);
+		transforms[i].setLocalScale(scales[i]);
+	}
+	std::vector<glm::mat4> eulerMatrices(count);
+
+	const unsigned int runs = 10;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int run = 0; run < runs; run++)
+	{
+		eulerMatrices[0] = eulerModelMatrix(glm::mat4(1.0f), positions[0], rotations[0], scales[0]);
+		for (unsigned int i = 1; i < count; i++)
+			eulerMatrices[i] = eulerModelMatrix(eulerMatrices[(i - 1) / 4], positions[i], rotations[i], scales[i]);
+	}
+	const float eulerMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+	start = std::chrono::steady_clock::now();
+	for (unsigned int run = 0; run < runs; run++)
+	{
+		transforms[0].computeModelMatrix();
+		for (unsigned int i = 1; i < count; i++)
+			transforms[i].computeModelMatrix(transforms[(i - 1) / 4].getAffineModelMatrix());
+	}
+	const float affineMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+
+	float maxError = 0.0f, maxInverseError = 0.0f;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const glm::mat4 model = transforms[i].getModelMatrix();
+		const glm::mat4 identity = transforms[i].getInverseModelMatrix() * model;
+		float size = 1.0f;
+		for (int column = 0; column < 4; column++)
+			for (int row = 0; row < 4; row++)
+				size = std::max(size, std::abs(eulerMatrices[i][column][row]));
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				maxError = std::max(maxError, std::abs(model[column][row] - eulerMatrices[i][column][row]) / size);
+				maxInverseError = std::max(maxInverseError, std::abs(identity[column][row] - (column == row ? 1.0f : 0.0f)));
+			}
+		}
+	}
+	const bool accurate = maxError < 1e-4f && maxInverseError < 1e-3f;
+	std::cout << count << " transforms, " << sizeof(Transform) << " bytes each" << std::endl;
+	std::cout << "Euler 4x4 path:         " << eulerMs << " ms per update" << std::endl;
+	std::cout << "quaternion affine path: " << affineMs << " ms per update (" << eulerMs / affineMs << "x)" << std::endl;
+	std::cout << "max relative difference " << maxError << ", max inverse * model - identity " << maxInverseError
+		<< (accurate ? " (ok)" : " (TOO LARGE)") << std::endl;
+	return accurate ? 0 : 1;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow* window)
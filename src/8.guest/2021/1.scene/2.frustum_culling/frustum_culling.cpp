@@ -26,12 +26,19 @@ public:
 #endif
 
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+int runOcclusionBenchmark(unsigned int runs);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -48,8 +55,12 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --occlusion-benchmark [runs]: time and check the software occlusion pipeline without opening a window
+	if (argc > 1 && std::strcmp(argv[1], "--occlusion-benchmark") == 0)
+		return runOcclusionBenchmark(argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 1000);
+
 	// glfw: initialize and configure
 	// ------------------------------
 	glfwInit();
@@ -124,6 +135,11 @@ int main()
 	}
 	ourEntity.updateSelfAndChild();
 
+	// software occlusion buffer, a quarter of the screen resolution is plenty for big occluders
+	OcclusionCuller occlusion(SCR_WIDTH / 4, SCR_HEIGHT / 4);
+	const unsigned int maxOccluders = 8;
+	std::vector<Entity*> occluders;
+
 	// draw in wireframe
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
@@ -162,10 +178,27 @@ int main()
 		ourShader.setMat4("projection", projection);
 		ourShader.setMat4("view", view);
 
+		// the closest entities in view are the best occluders: rasterize them on the CPU and build the depth pyramid
+		occlusion.beginFrame(projection * view);
+		occluders.clear();
+		for (auto&& child : ourEntity.children)
+		{
+			if (child->boundingVolume->isOnFrustum(camFrustum, child->transform))
+				occluders.push_back(child.get());
+		}
+		const size_t occluderCount = std::min<size_t>(occluders.size(), maxOccluders);
+		std::partial_sort(occluders.begin(), occluders.begin() + occluderCount, occluders.end(), [](const Entity* a, const Entity* b)
+			{
+				return glm::distance(a->transform.getGlobalPosition(), camera.Position) < glm::distance(b->transform.getGlobalPosition(), camera.Position);
+			});
+		for (size_t i = 0; i < occluderCount; ++i)
+			occluders[i]->addAsOccluder(occlusion);
+		occlusion.endOccluders();
+
 		// draw our scene graph
-		unsigned int total = 0, display = 0;
-		ourEntity.drawSelfAndChild(camFrustum, ourShader, display, total);
-		std::cout << "Total process in CPU : " << total << " / Total send to GPU : " << display << std::endl;
+		unsigned int total = 0, display = 0, occluded = 0;
+		ourEntity.drawSelfAndChild(camFrustum, occlusion, ourShader, display, occluded, total);
+		std::cout << "Total process in CPU : " << total << " / Total send to GPU : " << display << " / Occluded : " << occluded << std::endl;
 
 		//ourEntity.transform.setLocalRotation({ 0.f, ourEntity.transform.getLocalRotation().y + 20 * deltaTime, 0.f });
 		ourEntity.updateSelfAndChild();
@@ -182,6 +215,101 @@ int main()
 	return 0;
 }
 
+// Appends the rectangle [min, max] on the plane z = depth, split into subdivisions x subdivisions quads
+void addOccluderQuad(std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices, const glm::vec2& min, const glm::vec2& max, float depth, unsigned int subdivisions)
+{
+	const unsigned int first = static_cast<unsigned int>(positions.size());
+	for (unsigned int y = 0; y <= subdivisions; y++)
+		for (unsigned int x = 0; x <= subdivisions; x++)
+			positions.push_back(glm::vec3(glm::mix(min, max, glm::vec2(x, y) / static_cast<float>(subdivisions)), depth));
+	for (unsigned int y = 0; y < subdivisions; y++)
+	{
+		for (unsigned int x = 0; x < subdivisions; x++)
+		{
+			const unsigned int corner = first + y * (subdivisions + 1) + x;
+			indices.insert(indices.end(), { corner, corner + 1, corner + subdivisions + 2, corner, corner + subdivisions + 2, corner + subdivisions + 1 });
+		}
+	}
+}
+
+// Rasterizes a fixed set of walls seen from the origin looking down -z: a solid wall on the left and
+// a wall with a window on the right, both at z = -20, with a gap between them. Times rasterization,
+// pyramid construction and box tests, and checks boxes known to be hidden behind the solid wall and
+// boxes known to be visible (in front of the walls, through the gap and the window, around the window
+// frame, above the walls, crossing the wall plane or the camera plane). Returns 1 on any mismatch.
+int runOcclusionBenchmark(unsigned int runs)
+{
+	runs = std::max(runs, 1u);
+	const float wallDepth = -20.0f;
+	std::vector<glm::vec3> positions;
+	std::vector<unsigned int> indices;
+	addOccluderQuad(positions, indices, glm::vec2(-10.0f, -6.0f), glm::vec2(-1.0f, 6.0f), wallDepth, 8);
+	addOccluderQuad(positions, indices, glm::vec2(1.0f, -6.0f), glm::vec2(10.0f, -1.5f), wallDepth, 8);
+	addOccluderQuad(positions, indices, glm::vec2(1.0f, 1.5f), glm::vec2(10.0f, 6.0f), wallDepth, 8);
+	addOccluderQuad(positions, indices, glm::vec2(1.0f, -1.5f), glm::vec2(4.0f, 1.5f), wallDepth, 8);
+	addOccluderQuad(positions, indices, glm::vec2(7.0f, -1.5f), glm::vec2(10.0f, 1.5f), wallDepth, 8);
+
+	// a box of the given half size whose center projects onto (x, y) of the wall plane, at distance 'distance'
+	struct TestBox { glm::vec3 min, max; };
+	auto boxBehind = [&](float x, float y, float distance, float halfSize)
+	{
+		const glm::vec3 center(x * distance / -wallDepth, y * distance / -wallDepth, -distance);
+		return TestBox{ center - glm::vec3(halfSize), center + glm::vec3(halfSize) };
+	};
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	auto between = [&](float a, float b) { return a + (b - a) * unit(random); };
+	const unsigned int boxesPerCase = 1000;
+	std::vector<TestBox> hidden, visible;
+	for (unsigned int i = 0; i < boxesPerCase; i++)
+	{
+		hidden.push_back(boxBehind(between(-7.0f, -4.0f), between(-3.0f, 3.0f), between(25.0f, 90.0f), between(0.05f, 0.4f)));
+		// in front of the solid wall
+		visible.push_back(boxBehind(between(-7.0f, -4.0f), between(-3.0f, 3.0f), between(5.0f, 15.0f), between(0.05f, 0.4f)));
+		// through the gap between the walls and through the window
+		visible.push_back(boxBehind(0.0f, between(-3.0f, 3.0f), between(30.0f, 90.0f), 0.2f));
+		visible.push_back(boxBehind(5.5f, between(-0.5f, 0.5f), between(30.0f, 90.0f), 0.2f));
+		// big enough to cover the window and the frame around it
+		const float distance = between(30.0f, 90.0f);
+		visible.push_back(boxBehind(5.5f, 0.0f, distance, distance / 8.0f));
+		// above the walls
+		visible.push_back(boxBehind(between(-7.0f, 7.0f), 7.5f, between(25.0f, 90.0f), 0.2f));
+	}
+	visible.push_back(TestBox{ glm::vec3(-6.0f, -1.0f, -21.0f), glm::vec3(-4.0f, 1.0f, -19.0f) });
+	visible.push_back(TestBox{ glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f) });
+
+	OcclusionCuller occlusion(SCR_WIDTH / 4, SCR_HEIGHT / 4);
+	const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int run = 0; run < runs; run++)
+	{
+		occlusion.beginFrame(projection);
+		occlusion.addOccluder(glm::mat4(1.0f), positions.data(), sizeof(glm::vec3), indices.data(), indices.size());
+	}
+	const float rasterizeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+	start = std::chrono::steady_clock::now();
+	for (unsigned int run = 0; run < runs; run++)
+		occlusion.endOccluders();
+	const float pyramidMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / runs;
+
+	unsigned int missedHidden = 0, culledVisible = 0;
+	start = std::chrono::steady_clock::now();
+	for (const TestBox& box : hidden)
+		missedHidden += occlusion.isOccluded(box.min, box.max) ? 0 : 1;
+	for (const TestBox& box : visible)
+		culledVisible += occlusion.isOccluded(box.min, box.max) ? 1 : 0;
+	const float testUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count() / (hidden.size() + visible.size());
+
+	std::cout << occlusion.rasterizer.getWidth() << "x" << occlusion.rasterizer.getHeight() << " depth buffer, "
+		<< indices.size() / 3 << " occluder triangles, " << occlusion.pyramid.getLevelCount() << " pyramid levels" << std::endl;
+	std::cout << "rasterize:     " << rasterizeMs << " ms per frame" << std::endl;
+	std::cout << "build pyramid: " << pyramidMs << " ms per frame" << std::endl;
+	std::cout << "box test:      " << testUs << " us per box" << std::endl;
+	std::cout << "hidden boxes reported visible:   " << missedHidden << " / " << hidden.size() << std::endl;
+	std::cout << "visible boxes reported occluded: " << culledVisible << " / " << visible.size() << std::endl;
+	return missedHidden == 0 && culledVisible == 0 ? 0 : 1;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow* window)
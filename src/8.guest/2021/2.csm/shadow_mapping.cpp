@@ -10,6 +10,8 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/shadow_cascades.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
 #include <random>
@@ -19,12 +21,12 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
+void createScene();
 void renderScene(const Shader &shader);
+unsigned int renderShadowCasters(const Shader &shader, const glm::vec4 planes[6]);
 void renderCube();
 void renderQuad();
-std::vector<glm::mat4> getLightSpaceMatrices();
-std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& projview);
-void drawCascadeVolumeVisualizers(const std::vector<glm::mat4>& lightMatrices, Shader* shader);
+void drawCascadeVolumeVisualizers(const glm::mat4* lightMatrices, unsigned int count, Shader* shader);
 
 // settings
 const unsigned int SCR_WIDTH = 2560;
@@ -42,25 +44,40 @@ float cameraFarPlane = 500.0f;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-std::vector<float> shadowCascadeLevels{ cameraFarPlane / 50.0f, cameraFarPlane / 25.0f, cameraFarPlane / 10.0f, cameraFarPlane / 2.0f };
 int debugLayer = 0;
 
 // meshes
 unsigned int planeVAO;
 
+// scene: the floor plus randomly placed cubes, with world space bounding spheres for caster culling
+const glm::vec4 floorBounds = glm::vec4(0.0f, -2.0f, 0.0f, 25.0f * std::sqrt(2.0f));
+std::vector<glm::mat4> cubeModels;
+std::vector<glm::vec4> cubeBounds;
+glm::vec4 sceneBounds;
+
 // lighting info
 // -------------
 const glm::vec3 lightDir = glm::normalize(glm::vec3(20.0f, 50, 20.0f));
 unsigned int lightFBO;
 unsigned int lightDepthMaps;
 constexpr unsigned int depthMapResolution = 4096;
+ShadowCascades cascades(5, depthMapResolution);
+
+// depth histogram reduction: the visible depth range, read back from a low resolution depth pre-pass
+// a few frames late (like GpuTimer's queries) so the CPU never waits for the GPU
+const unsigned int REDUCTION_WIDTH = SCR_WIDTH / 8;
+const unsigned int REDUCTION_HEIGHT = SCR_HEIGHT / 8;
+const unsigned int REDUCTION_FRAMES_IN_FLIGHT = 3;
+bool depthReduction = false;
+glm::vec2 visibleDepthRange = glm::vec2(cameraNearPlane, cameraFarPlane);
 
 bool showQuad = false;
 
 std::random_device device;
 std::mt19937 generator = std::mt19937(device());
 
-std::vector<glm::mat4> lightMatricesCache;
+glm::mat4 lightMatricesCache[MAX_SHADOW_CASCADES];
+unsigned int lightMatricesCacheCount = 0;
 
 int main()
 {
@@ -108,7 +125,7 @@ int main()
     // build and compile shaders
     // -------------------------
     Shader shader("10.shadow_mapping.vs", "10.shadow_mapping.fs");
-    Shader simpleDepthShader("10.shadow_mapping_depth.vs", "10.shadow_mapping_depth.fs", "10.shadow_mapping_depth.gs");
+    Shader simpleDepthShader("10.shadow_mapping_depth.vs", "10.shadow_mapping_depth.fs");
     Shader debugDepthQuad("10.debug_quad.vs", "10.debug_quad_depth.fs");
     Shader debugCascadeShader("10.debug_cascade.vs", "10.debug_cascade.fs");
 
@@ -142,6 +159,12 @@ int main()
     // -------------
     unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str());
 
+    // place the cubes and tell the cascades where the casters are
+    // ------------------------------------------------------------
+    createScene();
+    cascades.setLightDirection(lightDir);
+    cascades.setSceneBounds(sceneBounds);
+
     // configure light FBO
     // -----------------------
     glGenFramebuffers(1, &lightFBO);
@@ -149,7 +172,7 @@ int main()
     glGenTextures(1, &lightDepthMaps);
     glBindTexture(GL_TEXTURE_2D_ARRAY, lightDepthMaps);
     glTexImage3D(
-        GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, depthMapResolution, depthMapResolution, int(shadowCascadeLevels.size()) + 1,
+        GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, depthMapResolution, depthMapResolution, int(cascades.count),
         0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -160,8 +183,9 @@ int main()
     constexpr float bordercolor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
     glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, bordercolor);
 
+    // cascades are rendered one layer at a time, only when they change
     glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 
@@ -174,6 +198,36 @@ int main()
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    // configure depth reduction FBO and read back buffers
+    // ---------------------------------------------------
+    unsigned int reductionFBO, reductionDepthMap;
+    glGenFramebuffers(1, &reductionFBO);
+    glGenTextures(1, &reductionDepthMap);
+    glBindTexture(GL_TEXTURE_2D, reductionDepthMap);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, REDUCTION_WIDTH, REDUCTION_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, reductionFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, reductionDepthMap, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Depth reduction framebuffer is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    unsigned int reductionPBOs[REDUCTION_FRAMES_IN_FLIGHT];
+    bool reductionPending[REDUCTION_FRAMES_IN_FLIGHT] = {};
+    glm::mat4 reductionProjections[REDUCTION_FRAMES_IN_FLIGHT];
+    glGenBuffers(REDUCTION_FRAMES_IN_FLIGHT, reductionPBOs);
+    for (unsigned int i = 0; i < REDUCTION_FRAMES_IN_FLIGHT; ++i)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, reductionPBOs[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, REDUCTION_WIDTH * REDUCTION_HEIGHT * sizeof(float), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    unsigned int depthHistogram[DEPTH_HISTOGRAM_BINS];
+    unsigned int reductionFrame = 0;
+
     // configure UBO
     // --------------------
     unsigned int matricesUBO;
@@ -191,6 +245,10 @@ int main()
     debugDepthQuad.use();
     debugDepthQuad.setInt("depthMap", 0);
 
+    GpuTimer timer(1);
+    float lastTitleUpdate = 0.0f;
+    unsigned int renderedCascades = 0, drawnCasters = 0;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -215,28 +273,72 @@ int main()
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 0. UBO setup
-        const auto lightMatrices = getLightSpaceMatrices();
-        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-        for (size_t i = 0; i < lightMatrices.size(); ++i)
+        const glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, cameraNearPlane, cameraFarPlane);
+        const glm::mat4 view = camera.GetViewMatrix();
+
+        // 0. depth histogram reduction: collect the depth read back REDUCTION_FRAMES_IN_FLIGHT frames ago,
+        // then render this frame's low resolution depth and start reading it back
+        // --------------------------------------------------------------------------------------------------
+        timer.mark(0);
+        if (depthReduction)
+        {
+            const unsigned int slot = reductionFrame % REDUCTION_FRAMES_IN_FLIGHT;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, reductionPBOs[slot]);
+            if (reductionPending[slot])
+            {
+                const float* depth = static_cast<const float*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, REDUCTION_WIDTH * REDUCTION_HEIGHT * sizeof(float), GL_MAP_READ_BIT));
+                if (depth && !reduceDepthRange(depth, REDUCTION_WIDTH * REDUCTION_HEIGHT, reductionProjections[slot], depthHistogram, visibleDepthRange))
+                    visibleDepthRange = glm::vec2(cameraNearPlane, cameraFarPlane);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+
+            simpleDepthShader.use();
+            simpleDepthShader.setMat4("lightSpaceMatrix", projection * view);
+            glBindFramebuffer(GL_FRAMEBUFFER, reductionFBO);
+            glViewport(0, 0, REDUCTION_WIDTH, REDUCTION_HEIGHT);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            renderScene(simpleDepthShader);
+            glReadPixels(0, 0, REDUCTION_WIDTH, REDUCTION_HEIGHT, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            reductionPending[slot] = true;
+            reductionProjections[slot] = projection;
+            reductionFrame++;
+        }
+        else
         {
-            glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &lightMatrices[i]);
+            visibleDepthRange = glm::vec2(cameraNearPlane, cameraFarPlane);
         }
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-        // 1. render depth of scene to texture (from light's perspective)
-        // --------------------------------------------------------------
-        //lightProjection = glm::perspective(glm::radians(45.0f), (GLfloat)SHADOW_WIDTH / (GLfloat)SHADOW_HEIGHT, near_plane, far_plane); // note that if you use a perspective projection matrix you'll have to change the light position as the current light position isn't enough to reflect the whole scene
-        // render scene from light's point of view
-        simpleDepthShader.use();
-
-        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-        glViewport(0, 0, depthMapResolution, depthMapResolution);
-        glClear(GL_DEPTH_BUFFER_BIT);
-        glCullFace(GL_FRONT);  // peter panning
-        renderScene(simpleDepthShader);
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // 1. refit the cascades that no longer cover their slice of the view and render the depth of
+        // the casters that touch them (from light's perspective); the others keep last frame's map
+        // --------------------------------------------------------------------------------------------
+        renderedCascades = cascades.update(view, glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT,
+            std::max(visibleDepthRange.x, cameraNearPlane), std::min(visibleDepthRange.y, cameraFarPlane));
+        drawnCasters = 0;
+        if (renderedCascades > 0)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+            simpleDepthShader.use();
+            glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+            glViewport(0, 0, depthMapResolution, depthMapResolution);
+            glCullFace(GL_FRONT);  // peter panning
+            for (unsigned int i = 0; i < cascades.count; ++i)
+            {
+                if (!cascades.dirty[i])
+                    continue;
+                glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &cascades.lightSpaceMatrices[i]);
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0, i);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                simpleDepthShader.setMat4("lightSpaceMatrix", cascades.lightSpaceMatrices[i]);
+                drawnCasters += renderShadowCasters(simpleDepthShader, cascades.planes[i]);
+            }
+            glCullFace(GL_BACK);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        timer.mark(1);
+        timer.endFrame();
 
         // reset viewport
         glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -247,18 +349,16 @@ int main()
         glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         shader.use();
-        const glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, cameraNearPlane, cameraFarPlane);
-        const glm::mat4 view = camera.GetViewMatrix();
         shader.setMat4("projection", projection);
         shader.setMat4("view", view);
         // set light uniforms
         shader.setVec3("viewPos", camera.Position);
         shader.setVec3("lightDir", lightDir);
-        shader.setFloat("farPlane", cameraFarPlane);
-        shader.setInt("cascadeCount", shadowCascadeLevels.size());
-        for (size_t i = 0; i < shadowCascadeLevels.size(); ++i)
+        shader.setFloat("farPlane", cascades.splits[cascades.count]);
+        shader.setInt("cascadeCount", cascades.count - 1);
+        for (unsigned int i = 0; i + 1 < cascades.count; ++i)
         {
-            shader.setFloat("cascadePlaneDistances[" + std::to_string(i) + "]", shadowCascadeLevels[i]);
+            shader.setFloat("cascadePlaneDistances[" + std::to_string(i) + "]", cascades.splits[i + 1]);
         }
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, woodTexture);
@@ -266,14 +366,14 @@ int main()
         glBindTexture(GL_TEXTURE_2D_ARRAY, lightDepthMaps);
         renderScene(shader);
 
-        if (lightMatricesCache.size() != 0)
+        if (lightMatricesCacheCount != 0)
         {
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             debugCascadeShader.use();
             debugCascadeShader.setMat4("projection", projection);
             debugCascadeShader.setMat4("view", view);
-            drawCascadeVolumeVisualizers(lightMatricesCache, &debugCascadeShader);
+            drawCascadeVolumeVisualizers(lightMatricesCache, lightMatricesCacheCount, &debugCascadeShader);
             glDisable(GL_BLEND);
         }
 
@@ -288,6 +388,17 @@ int main()
             renderQuad();
         }
 
+        // shadow pass cost and how much of it the cache saved
+        // ---------------------------------------------------
+        if (currentFrame - lastTitleUpdate > 1.0f && timer.collectedFrames() > 0)
+        {
+            std::string title = std::string("LearnOpenGL - shadow passes ") + std::to_string(timer.average(0)) + " ms, cascades rendered " +
+                std::to_string(renderedCascades) + "/" + std::to_string(cascades.count) + ", casters drawn " + std::to_string(drawnCasters);
+            glfwSetWindowTitle(window, title.c_str());
+            lastTitleUpdate = currentFrame;
+            timer.reset();
+        }
+
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
@@ -298,11 +409,38 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &planeVAO);
     glDeleteBuffers(1, &planeVBO);
+    glDeleteBuffers(REDUCTION_FRAMES_IN_FLIGHT, reductionPBOs);
+    glDeleteTextures(1, &reductionDepthMap);
+    glDeleteFramebuffers(1, &reductionFBO);
 
     glfwTerminate();
     return 0;
 }
 
+// places the cubes and computes the bounds of the scene
+// ------------------------------------------------------
+void createScene()
+{
+    std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-10, 10);
+    std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
+    std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
+    const BoundingSphere cubeSphere = { glm::vec3(0.0f), std::sqrt(3.0f) };
+
+    glm::vec3 boundsMin = glm::vec3(floorBounds) - floorBounds.w, boundsMax = glm::vec3(floorBounds) + floorBounds.w;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(offsetDistribution(generator), offsetDistribution(generator) + 10.0f, offsetDistribution(generator)));
+        model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
+        model = glm::scale(model, glm::vec3(scaleDistribution(generator)));
+        cubeModels.push_back(model);
+        cubeBounds.push_back(transformBoundingSphere(model, cubeSphere));
+        boundsMin = glm::min(boundsMin, glm::vec3(cubeBounds.back()) - cubeBounds.back().w);
+        boundsMax = glm::max(boundsMax, glm::vec3(cubeBounds.back()) + cubeBounds.back().w);
+    }
+    sceneBounds = glm::vec4((boundsMin + boundsMax) * 0.5f, glm::length(boundsMax - boundsMin) * 0.5f);
+}
+
 // renders the 3D scene
 // --------------------
 void renderScene(const Shader &shader)
@@ -313,28 +451,34 @@ void renderScene(const Shader &shader)
     glBindVertexArray(planeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
-    static std::vector<glm::mat4> modelMatrices;
-    if (modelMatrices.size() == 0)
+    for (const auto& model : cubeModels)
     {
-        for (int i = 0; i < 10; ++i)
-        {
-            static std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-10, 10);
-            static std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
-            static std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
-
-            auto model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(offsetDistribution(generator), offsetDistribution(generator) + 10.0f, offsetDistribution(generator)));
-            model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
-            model = glm::scale(model, glm::vec3(scaleDistribution(generator)));
-            modelMatrices.push_back(model);
-        }
+        shader.setMat4("model", model);
+        renderCube();
     }
+}
 
-    for (const auto& model : modelMatrices)
+// renders the parts of the scene that intersect a cascade's light frustum; returns how many were drawn
+// ----------------------------------------------------------------------------------------------------
+unsigned int renderShadowCasters(const Shader &shader, const glm::vec4 planes[6])
+{
+    unsigned int drawn = 0;
+    if (isSphereInFrustum(floorBounds, planes))
     {
-        shader.setMat4("model", model);
+        shader.setMat4("model", glm::mat4(1.0f));
+        glBindVertexArray(planeVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        ++drawn;
+    }
+    for (size_t i = 0; i < cubeModels.size(); ++i)
+    {
+        if (!isSphereInFrustum(cubeBounds[i], planes))
+            continue;
+        shader.setMat4("model", cubeModels[i]);
         renderCube();
+        ++drawn;
     }
+    return drawn;
 }
 
 
@@ -444,29 +588,40 @@ void renderQuad()
     glBindVertexArray(0);
 }
 
-std::vector<GLuint> visualizerVAOs;
-std::vector<GLuint> visualizerVBOs;
-std::vector<GLuint> visualizerEBOs;
-void drawCascadeVolumeVisualizers(const std::vector<glm::mat4>& lightMatrices, Shader* shader)
+// draws the light frusta of the cascades as translucent boxes
+// -----------------------------------------------------------
+unsigned int visualizerVAO = 0;
+unsigned int visualizerVBO;
+unsigned int visualizerEBO;
+void drawCascadeVolumeVisualizers(const glm::mat4* lightMatrices, unsigned int count, Shader* shader)
 {
-    visualizerVAOs.resize(8);
-    visualizerEBOs.resize(8);
-    visualizerVBOs.resize(8);
-
-    const GLuint indices[] = {
-        0, 2, 3,
-        0, 3, 1,
-        4, 6, 2,
-        4, 2, 0,
-        5, 7, 6,
-        5, 6, 4,
-        1, 3, 7,
-        1, 7, 5,
-        6, 7, 3,
-        6, 3, 2,
-        1, 5, 4,
-        0, 1, 4
-    };
+    if (visualizerVAO == 0)
+    {
+        const GLuint indices[] = {
+            0, 2, 3,
+            0, 3, 1,
+            4, 6, 2,
+            4, 2, 0,
+            5, 7, 6,
+            5, 6, 4,
+            1, 3, 7,
+            1, 7, 5,
+            6, 7, 3,
+            6, 3, 2,
+            1, 5, 4,
+            0, 1, 4
+        };
+        glGenVertexArrays(1, &visualizerVAO);
+        glGenBuffers(1, &visualizerVBO);
+        glGenBuffers(1, &visualizerEBO);
+        glBindVertexArray(visualizerVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, visualizerVBO);
+        glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(glm::vec3), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, visualizerEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    }
 
     const glm::vec4 colors[] = {
         {1.0, 0.0, 0.0, 0.5f},
@@ -474,44 +629,17 @@ void drawCascadeVolumeVisualizers(const std::vector<glm::mat4>& lightMatrices, S
         {0.0, 0.0, 1.0, 0.5f},
     };
 
-    for (int i = 0; i < lightMatrices.size(); ++i)
+    glBindVertexArray(visualizerVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, visualizerVBO);
+    for (unsigned int i = 0; i < count; ++i)
     {
-        const auto corners = getFrustumCornersWorldSpace(lightMatrices[i]);
-        std::vector<glm::vec3> vec3s;
-        for (const auto& v : corners)
-        {
-            vec3s.push_back(glm::vec3(v));
-        }
-
-        glGenVertexArrays(1, &visualizerVAOs[i]);
-        glGenBuffers(1, &visualizerVBOs[i]);
-        glGenBuffers(1, &visualizerEBOs[i]);
-
-        glBindVertexArray(visualizerVAOs[i]);
-
-        glBindBuffer(GL_ARRAY_BUFFER, visualizerVBOs[i]);
-        glBufferData(GL_ARRAY_BUFFER, vec3s.size() * sizeof(glm::vec3), &vec3s[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, visualizerEBOs[i]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, 36 * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
-
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
-
-        glBindVertexArray(visualizerVAOs[i]);
+        glm::vec3 corners[8];
+        frustumCornersWorldSpace(lightMatrices[i], corners);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(corners), corners);
         shader->setVec4("color", colors[i % 3]);
         glDrawElements(GL_TRIANGLES, GLsizei(36), GL_UNSIGNED_INT, 0);
-
-        glDeleteBuffers(1, &visualizerVBOs[i]);
-        glDeleteBuffers(1, &visualizerEBOs[i]);
-        glDeleteVertexArrays(1, &visualizerVAOs[i]);
-
-        glBindVertexArray(0);
     }
-
-    visualizerVAOs.clear();
-    visualizerEBOs.clear();
-    visualizerVBOs.clear();
+    glBindVertexArray(0);
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
@@ -543,7 +671,7 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_RELEASE && plusPress == GLFW_PRESS)
     {
         debugLayer++;
-        if (debugLayer > shadowCascadeLevels.size())
+        if (debugLayer >= int(cascades.count))
         {
             debugLayer = 0;
         }
@@ -553,9 +681,37 @@ void processInput(GLFWwindow *window)
     static int cPress = GLFW_RELEASE;
     if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE && cPress == GLFW_PRESS)
     {
-        lightMatricesCache = getLightSpaceMatrices();
+        std::copy(cascades.lightSpaceMatrices, cascades.lightSpaceMatrices + cascades.count, lightMatricesCache);
+        lightMatricesCacheCount = cascades.count;
     }
     cPress = glfwGetKey(window, GLFW_KEY_C);
+
+    static int hPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_RELEASE && hPress == GLFW_PRESS)
+    {
+        depthReduction = !depthReduction;
+        std::cout << "splits over the " << (depthReduction ? "visible depth range (depth histogram)" : "full view range") << std::endl;
+    }
+    hPress = glfwGetKey(window, GLFW_KEY_H);
+
+    static int kPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_RELEASE && kPress == GLFW_PRESS)
+    {
+        cascades.caching = !cascades.caching;
+        cascades.invalidate();
+        std::cout << "cascade caching " << (cascades.caching ? "on" : "off") << std::endl;
+    }
+    kPress = glfwGetKey(window, GLFW_KEY_K);
+
+    static int upPress = GLFW_RELEASE;
+    static int downPress = GLFW_RELEASE;
+    if ((glfwGetKey(window, GLFW_KEY_UP) == GLFW_RELEASE && upPress == GLFW_PRESS) || (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_RELEASE && downPress == GLFW_PRESS))
+    {
+        cascades.lambda = glm::clamp(cascades.lambda + (upPress == GLFW_PRESS ? 0.05f : -0.05f), 0.0f, 1.0f);
+        std::cout << "split scheme lambda " << cascades.lambda << " (0 uniform, 1 logarithmic)" << std::endl;
+    }
+    upPress = glfwGetKey(window, GLFW_KEY_UP);
+    downPress = glfwGetKey(window, GLFW_KEY_DOWN);
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -632,107 +788,3 @@ unsigned int loadTexture(char const * path)
 
     return textureID;
 }
-
-std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& projview)
-{
-    const auto inv = glm::inverse(projview);
-
-    std::vector<glm::vec4> frustumCorners;
-    for (unsigned int x = 0; x < 2; ++x)
-    {
-        for (unsigned int y = 0; y < 2; ++y)
-        {
-            for (unsigned int z = 0; z < 2; ++z)
-            {
-                const glm::vec4 pt = inv * glm::vec4(2.0f * x - 1.0f, 2.0f * y - 1.0f, 2.0f * z - 1.0f, 1.0f);
-                frustumCorners.push_back(pt / pt.w);
-            }
-        }
-    }
-
-    return frustumCorners;
-}
-
-
-std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& proj, const glm::mat4& view)
-{
-    return getFrustumCornersWorldSpace(proj * view);
-}
-
-glm::mat4 getLightSpaceMatrix(const float nearPlane, const float farPlane)
-{
-    const auto proj = glm::perspective(
-        glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, nearPlane,
-        farPlane);
-    const auto corners = getFrustumCornersWorldSpace(proj, camera.GetViewMatrix());
-
-    glm::vec3 center = glm::vec3(0, 0, 0);
-    for (const auto& v : corners)
-    {
-        center += glm::vec3(v);
-    }
-    center /= corners.size();
-
-    const auto lightView = glm::lookAt(center + lightDir, center, glm::vec3(0.0f, 1.0f, 0.0f));
-
-    float minX = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::min();
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::min();
-    float minZ = std::numeric_limits<float>::max();
-    float maxZ = std::numeric_limits<float>::min();
-    for (const auto& v : corners)
-    {
-        const auto trf = lightView * v;
-        minX = std::min(minX, trf.x);
-        maxX = std::max(maxX, trf.x);
-        minY = std::min(minY, trf.y);
-        maxY = std::max(maxY, trf.y);
-        minZ = std::min(minZ, trf.z);
-        maxZ = std::max(maxZ, trf.z);
-    }
-
-    // Tune this parameter according to the scene
-    constexpr float zMult = 10.0f;
-    if (minZ < 0)
-    {
-        minZ *= zMult;
-    }
-    else
-    {
-        minZ /= zMult;
-    }
-    if (maxZ < 0)
-    {
-        maxZ /= zMult;
-    }
-    else
-    {
-        maxZ *= zMult;
-    }
-
-    const glm::mat4 lightProjection = glm::ortho(minX, maxX, minY, maxY, minZ, maxZ);
-
-    return lightProjection * lightView;
-}
-
-std::vector<glm::mat4> getLightSpaceMatrices()
-{
-    std::vector<glm::mat4> ret;
-    for (size_t i = 0; i < shadowCascadeLevels.size() + 1; ++i)
-    {
-        if (i == 0)
-        {
-            ret.push_back(getLightSpaceMatrix(cameraNearPlane, shadowCascadeLevels[i]));
-        }
-        else if (i < shadowCascadeLevels.size())
-        {
-            ret.push_back(getLightSpaceMatrix(shadowCascadeLevels[i - 1], shadowCascadeLevels[i]));
-        }
-        else
-        {
-            ret.push_back(getLightSpaceMatrix(shadowCascadeLevels[i - 1], cameraFarPlane));
-        }
-    }
-    return ret;
-}